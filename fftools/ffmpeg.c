@@ -545,7 +545,18 @@ void update_benchmark(const char *fmt, ...)
     }
 }
 
-static void print_report(int is_last_report, int64_t timer_start, int64_t cur_time, int64_t pts)
+/* the output stream a simple filtergraph was created for, other streams can
+ * be fed from it with -share_filtergraphs */
+static OutputStream *simple_fg_owner(const FilterGraph *fg)
+{
+    for (OutputStream *ost = ost_iter(NULL); ost; ost = ost_iter(ost))
+        if (ost->fg_simple == fg)
+            return ost;
+    return NULL;
+}
+
+static void print_report(Scheduler *sch, int is_last_report,
+                         int64_t timer_start, int64_t cur_time, int64_t pts)
 {
     AVBPrint buf, buf_script;
     int64_t total_size = of_filesize(output_files[0]);
@@ -660,6 +671,8 @@ static void print_report(int is_last_report, int64_t timer_start, int64_t cur_ti
         av_bprintf(&buf, " dup=%"PRId64" drop=%"PRId64, nb_frames_dup, nb_frames_drop);
     av_bprintf(&buf_script, "dup_frames=%"PRId64"\n", nb_frames_dup);
     av_bprintf(&buf_script, "drop_frames=%"PRId64"\n", nb_frames_drop);
+    if (progress_queues)
+        sch_print_queues(sch, &buf_script);
 
     if (speed < 0) {
         av_bprintf(&buf, " speed=N/A");
@@ -769,6 +782,12 @@ static void print_stream_maps(void)
                    out_codec_name, encoder_name);
         } else
             av_log(NULL, AV_LOG_INFO, " (copy)");
+        if (ost->filter && !ost->fg_simple) {
+            const OutputStream *owner = simple_fg_owner(ost->filter->graph);
+            if (owner)
+                av_log(NULL, AV_LOG_INFO, " [filtergraph shared with #%d:%d]",
+                       owner->file->index, owner->index);
+        }
         av_log(NULL, AV_LOG_INFO, "\n");
     }
 }
@@ -821,9 +840,18 @@ static int check_keyboard_interaction(int64_t cur_time)
             av_log(NULL, AV_LOG_DEBUG, "Processing command target:%s time:%f command:%s arg:%s",
                    target, time, command, arg);
             for (OutputStream *ost = ost_iter(NULL); ost; ost = ost_iter(ost)) {
-                if (ost->fg_simple)
-                    fg_send_command(ost->fg_simple, time, target, command, arg,
-                                    key == 'C');
+                FilterGraph *fg = ost->filter ? ost->filter->graph : NULL;
+
+                if (!fg || !filtergraph_is_simple(fg))
+                    continue;
+                /* a simple filtergraph shared by several streams receives
+                 * the command only once */
+                if (simple_fg_owner(fg) != ost) {
+                    av_log(ost, AV_LOG_VERBOSE, "Command sent to the shared "
+                           "filtergraph of this stream\n");
+                    continue;
+                }
+                fg_send_command(fg, time, target, command, arg, key == 'C');
             }
             for (i = 0; i < nb_filtergraphs; i++)
                 fg_send_command(filtergraphs[i], time, target, command, arg,
@@ -880,7 +908,7 @@ static int transcode(Scheduler *sch)
                 break;
 
         /* dump report by using the output first video and audio streams */
-        print_report(0, timer_start, cur_time, transcode_ts);
+        print_report(sch, 0, timer_start, cur_time, transcode_ts);
     }
 
     ret = sch_stop(sch, &transcode_ts);
@@ -894,7 +922,7 @@ static int transcode(Scheduler *sch)
     term_exit();
 
     /* dump report by using the first video and audio streams */
-    print_report(1, timer_start, av_gettime_relative(), transcode_ts);
+    print_report(sch, 1, timer_start, av_gettime_relative(), transcode_ts);
 
     return ret;
 }
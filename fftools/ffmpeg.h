@@ -703,10 +703,13 @@ extern int print_stats;
 extern int64_t stats_period;
 extern int stdin_interaction;
 extern AVIOContext *progress_avio;
+extern int progress_queues;
 extern float max_error_rate;
 
 extern char *filter_nbthreads;
 extern int filter_complex_nbthreads;
+extern int filter_complex_concurrent;
+extern int share_filtergraphs;
 extern int vstats_version;
 extern int auto_conversion_filters;
 
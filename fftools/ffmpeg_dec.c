@@ -46,6 +46,9 @@ typedef struct DecoderPriv {
 
     AVRational          framerate_in;
 
+    // number of frames whose data was copied after decoding
+    uint64_t            nb_frames_copied;
+
     // a combination of DECODER_FLAG_*, provided to dec_open()
     int                 flags;
     int                 apply_cropping;
@@ -370,6 +373,8 @@ static int video_frame_process(DecoderPriv *dp, AVFrame *frame)
         int err = hwaccel_retrieve_data(dp->dec_ctx, frame);
         if (err < 0)
             return err;
+        if (frame->format != dp->hwaccel_pix_fmt)
+            dp->nb_frames_copied++;
     }
 
     frame->pts = frame->best_effort_timestamp;
@@ -970,6 +975,10 @@ static int decoder_thread(void *arg)
     }
 
 finish:
+    if (do_benchmark_all)
+        av_log(dp, AV_LOG_INFO, "bench: %"PRIu64" frames, %"PRIu64" copied\n",
+               dp->dec.frames_decoded, dp->nb_frames_copied);
+
     dec_thread_uninit(&dt);
 
     return ret;
@@ -1203,9 +1212,16 @@ static int dec_open(DecoderPriv *dp, AVDictionary **dec_opts,
     dp->dec_ctx->opaque                = dp;
     dp->dec_ctx->get_format            = get_format;
     dp->dec_ctx->pkt_timebase          = o->time_base;
+    // slice threads come from the pool shared within the thread budget
+    dp->dec_ctx->executor              = sch_executor(dp->sch);
 
-    if (!av_dict_get(*dec_opts, "threads", NULL, 0))
-        av_dict_set(dec_opts, "threads", "auto", 0);
+    if (!av_dict_get(*dec_opts, "threads", NULL, 0)) {
+        int threads = sch_thread_share(dp->sch);
+        if (threads)
+            av_dict_set_int(dec_opts, "threads", threads, 0);
+        else
+            av_dict_set(dec_opts, "threads", "auto", 0);
+    }
 
     ret = hw_device_setup_for_decode(dp, codec, o->hwaccel_device);
     if (ret < 0) {
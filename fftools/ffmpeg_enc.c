@@ -312,6 +312,11 @@ int enc_open(void *opaque, const AVFrame *frame)
 
     enc_ctx->flags |= AV_CODEC_FLAG_FRAME_DURATION;
 
+    // automatic thread count, stay within the scheduler thread budget
+    if (!enc_ctx->thread_count)
+        enc_ctx->thread_count = sch_thread_share(e->sch);
+    enc_ctx->executor = sch_executor(e->sch);
+
     ret = hw_device_setup_for_encode(ost, frame ? frame->hw_frames_ctx : NULL);
     if (ret < 0) {
         av_log(ost, AV_LOG_ERROR,
@@ -99,6 +99,9 @@ typedef struct FilterGraphThread {
     // EOF status of each input/output, as received by the thread
     uint8_t         *eof_in;
     uint8_t         *eof_out;
+
+    // frames copied inside the filtergraph, summed over its reconfigurations
+    int64_t          frame_copies;
 } FilterGraphThread;
 
 typedef struct InputFilterPriv {
@@ -156,6 +159,11 @@ typedef struct InputFilterPriv {
         ///< marks if sub2video_update should force an initialization
         unsigned int initialize;
     } sub2video;
+
+    // frames sent to the filtergraph, and those of them whose data was
+    // still referenced elsewhere, e.g. by the decoder or another filtergraph
+    uint64_t            nb_frames_in;
+    uint64_t            nb_frames_shared;
 } InputFilterPriv;
 
 static InputFilterPriv *ifp_from_ifilter(InputFilter *ifilter)
@@ -1178,6 +1186,143 @@ fail:
     return 0;
 }
 
+static int dict_equal(const AVDictionary *a, const AVDictionary *b)
+{
+    const AVDictionaryEntry *e = NULL;
+
+    if (av_dict_count(a) != av_dict_count(b))
+        return 0;
+
+    while ((e = av_dict_iterate(a, e))) {
+        const AVDictionaryEntry *e_b = av_dict_get(b, e->key, NULL, 0);
+        if (!e_b || strcmp(e->value, e_b->value))
+            return 0;
+    }
+
+    return 1;
+}
+
+#define DEF_LISTS_EQUAL(name, type, terminator)                             \
+static int name ## _lists_equal(const type *a, const type *b)               \
+{                                                                           \
+    if (!a || !b)                                                           \
+        return a == b;                                                      \
+                                                                            \
+    for (; *a == *b; a++, b++)                                              \
+        if (*a == terminator)                                               \
+            return 1;                                                       \
+                                                                            \
+    return 0;                                                               \
+}
+
+DEF_LISTS_EQUAL(pix_fmt,     int,              AV_PIX_FMT_NONE)
+DEF_LISTS_EQUAL(color_space, enum AVColorSpace, AVCOL_SPC_UNSPECIFIED)
+DEF_LISTS_EQUAL(color_range, enum AVColorRange, AVCOL_RANGE_UNSPECIFIED)
+
+static int frame_rate_lists_equal(const AVRational *a, const AVRational *b)
+{
+    if (!a || !b)
+        return a == b;
+
+    for (; a->num == b->num && a->den == b->den; a++, b++)
+        if (!a->num && !a->den)
+            return 1;
+
+    return 0;
+}
+
+/**
+ * Check whether the video output filter of an existing simple filtergraph
+ * produces exactly what an encoder configured with opts would get from its
+ * own simple filtergraph, i.e. whether ofilter_bind_ost() called with opts
+ * would set up the same output.
+ */
+static int ofilter_matches(const FilterGraphPriv *fgp, const OutputFilterPriv *ofp,
+                           const OutputStream *ost, const OutputFilterOptions *opts)
+{
+    const AVRational *framerate_supported = ost->force_fps || !opts->enc ?
+                                            NULL : opts->frame_rates;
+    const int framerate_clip = opts->enc && opts->enc->id == AV_CODEC_ID_MPEG4 ?
+                               65535 : 0;
+
+    if (ofp->flags            != opts->flags            ||
+        ofp->ts_offset        != opts->ts_offset        ||
+        ofp->trim_start_us    != opts->trim_start_us    ||
+        ofp->trim_duration_us != opts->trim_duration_us ||
+        ofp->enc_timebase.num != opts->output_tb.num    ||
+        ofp->enc_timebase.den != opts->output_tb.den)
+        return 0;
+
+    if (!!fgp->nb_threads != !!opts->nb_threads ||
+        (opts->nb_threads && strcmp(fgp->nb_threads, opts->nb_threads)))
+        return 0;
+
+    if (!dict_equal(ofp->sws_opts, opts->sws_opts))
+        return 0;
+
+    if (ofp->width  != opts->width ||
+        ofp->height != opts->height)
+        return 0;
+
+    if (opts->format != AV_PIX_FMT_NONE ? ofp->format != opts->format :
+        (ofp->format != AV_PIX_FMT_NONE ||
+         !pix_fmt_lists_equal(ofp->formats, opts->formats)))
+        return 0;
+
+    if (opts->color_space != AVCOL_SPC_UNSPECIFIED ?
+        ofp->color_space != opts->color_space :
+        (ofp->color_space != AVCOL_SPC_UNSPECIFIED ||
+         !color_space_lists_equal(ofp->color_spaces, opts->color_spaces)))
+        return 0;
+
+    if (opts->color_range != AVCOL_RANGE_UNSPECIFIED ?
+        ofp->color_range != opts->color_range :
+        (ofp->color_range != AVCOL_RANGE_UNSPECIFIED ||
+         !color_range_lists_equal(ofp->color_ranges, opts->color_ranges)))
+        return 0;
+
+    return ofp->fps.vsync_method      == opts->vsync_method         &&
+           ofp->fps.framerate.num     == ost->frame_rate.num        &&
+           ofp->fps.framerate.den     == ost->frame_rate.den        &&
+           ofp->fps.framerate_max.num == ost->max_frame_rate.num    &&
+           ofp->fps.framerate_max.den == ost->max_frame_rate.den    &&
+           frame_rate_lists_equal(ofp->fps.framerate_supported,
+                                  framerate_supported)              &&
+           ofp->fps.framerate_clip    == framerate_clip;
+}
+
+/**
+ * Look for a simple video filtergraph that was created for another output
+ * stream, is fed from the same input stream, runs the same filters and
+ * produces output with the same properties. Its frames can then be sent to
+ * both encoders, instead of decoding once but filtering (e.g. scaling) twice.
+ */
+static FilterGraph *fg_find_shareable(const InputStream *ist, const OutputStream *ost,
+                                      const char *graph_desc,
+                                      const OutputFilterOptions *opts)
+{
+    if (!share_filtergraphs || ost->type != AVMEDIA_TYPE_VIDEO)
+        return NULL;
+
+    for (OutputStream *o = ost_iter(NULL); o; o = ost_iter(o)) {
+        FilterGraph     *fg = o->fg_simple;
+        FilterGraphPriv *fgp;
+
+        if (o == ost || !fg || o->ist != ist || o->type != AVMEDIA_TYPE_VIDEO)
+            continue;
+
+        fgp = fgp_from_fg(fg);
+        if (strcmp(fgp->graph_desc, graph_desc) ||
+            fg->outputs[0]->type != AVMEDIA_TYPE_VIDEO)
+            continue;
+
+        if (ofilter_matches(fgp, ofp_from_ofilter(fg->outputs[0]), ost, opts))
+            return fg;
+    }
+
+    return NULL;
+}
+
 int init_simple_filtergraph(InputStream *ist, OutputStream *ost,
                             char *graph_desc,
                             Scheduler *sch, unsigned sched_idx_enc,
@@ -1187,6 +1332,20 @@ int init_simple_filtergraph(InputStream *ist, OutputStream *ost,
     FilterGraphPriv *fgp;
     int ret;
 
+    fg = fg_find_shareable(ist, ost, graph_desc, opts);
+    if (fg) {
+        fgp = fgp_from_fg(fg);
+
+        av_log(ost, AV_LOG_VERBOSE, "Sharing filtergraph %s with this stream\n",
+               fgp->log_name);
+
+        av_freep(&graph_desc);
+        ost->filter = fg->outputs[0];
+
+        return sch_connect(sch, SCH_FILTER_OUT(fgp->sch_idx, 0),
+                                SCH_ENC(sched_idx_enc));
+    }
+
     ret = fg_create(&ost->fg_simple, graph_desc, sch);
     if (ret < 0)
         return ret;
@@ -1811,6 +1970,12 @@ static int configure_input_filter(FilterGraph *fg, AVFilterGraph *graph,
 
 static void cleanup_filtergraph(FilterGraph *fg, FilterGraphThread *fgt)
 {
+    int64_t frame_copies;
+
+    if (fgt->graph &&
+        av_opt_get_int(fgt->graph, "frame_copies", 0, &frame_copies) >= 0)
+        fgt->frame_copies += frame_copies;
+
     for (int i = 0; i < fg->nb_outputs; i++)
         ofp_from_ofilter(fg->outputs[i])->filter = NULL;
     for (int i = 0; i < fg->nb_inputs; i++)
@@ -1858,6 +2023,9 @@ static int configure_filtergraph(FilterGraph *fg, FilterGraphThread *fgt)
     if (!fgt->graph)
         return AVERROR(ENOMEM);
 
+    // must be set before any filter is added
+    fgt->graph->executor = sch_executor(fgp->sch);
+
     if (simple) {
         OutputFilterPriv *ofp = ofp_from_ofilter(fg->outputs[0]);
 
@@ -1869,7 +2037,8 @@ static int configure_filtergraph(FilterGraph *fg, FilterGraphThread *fgt)
             ret = av_opt_set(fgt->graph, "threads", fgp->nb_threads, 0);
             if (ret < 0)
                 return ret;
-        }
+        } else
+            fgt->graph->nb_threads = sch_thread_share(fgp->sch);
 
         if (av_dict_count(ofp->sws_opts)) {
             ret = av_dict_get_string(ofp->sws_opts,
@@ -1888,7 +2057,10 @@ static int configure_filtergraph(FilterGraph *fg, FilterGraphThread *fgt)
             av_free(args);
         }
     } else {
-        fgt->graph->nb_threads = filter_complex_nbthreads;
+        fgt->graph->nb_threads = filter_complex_nbthreads ? filter_complex_nbthreads :
+                                 sch_thread_share(fgp->sch);
+        if (filter_complex_concurrent)
+            fgt->graph->thread_type |= AVFILTER_THREAD_GRAPH;
     }
 
     hw_device = hw_device_for_filter();
@@ -2844,6 +3016,11 @@ static int send_frame(FilterGraph *fg, FilterGraphThread *fgt,
         return AVERROR(ENOMEM);
     fd->wallclock[LATENCY_PROBE_FILTER_PRE] = av_gettime_relative();
 
+    ifp->nb_frames_in++;
+    if (!av_frame_is_writable(frame))
+        ifp->nb_frames_shared++;
+
+    // the frame is moved into the graph, no reference is kept
     ret = av_buffersrc_add_frame_flags(ifp->filter, frame,
                                        AV_BUFFERSRC_FLAG_PUSH);
     if (ret < 0) {
@@ -3028,6 +3205,19 @@ finish:
     if (ret == AVERROR_EOF)
         ret = 0;
 
+    if (do_benchmark_all) {
+        cleanup_filtergraph(fg, &fgt);
+
+        for (int i = 0; i < fg->nb_inputs; i++) {
+            InputFilterPriv *ifp = ifp_from_ifilter(fg->inputs[i]);
+            av_log(fg, AV_LOG_INFO, "bench: input %s: %"PRIu64" frames, "
+                   "%"PRIu64" shared\n", ifp->opts.name,
+                   ifp->nb_frames_in, ifp->nb_frames_shared);
+        }
+        av_log(fg, AV_LOG_INFO, "bench: %"PRId64" frames copied in the filtergraph\n",
+               fgt.frame_copies);
+    }
+
     fg_thread_uninit(&fgt);
 
     return ret;
@@ -61,19 +61,20 @@ static int64_t filesize(AVIOContext *pb)
     return ret;
 }
 
+static const char *const latency_probe_desc[] = {
+    [LATENCY_PROBE_DEMUX]       = "demux",
+    [LATENCY_PROBE_DEC_PRE]     = "decode",
+    [LATENCY_PROBE_DEC_POST]    = "decode",
+    [LATENCY_PROBE_FILTER_PRE]  = "filter",
+    [LATENCY_PROBE_FILTER_POST] = "filter",
+    [LATENCY_PROBE_ENC_PRE]     = "encode",
+    [LATENCY_PROBE_ENC_POST]    = "encode",
+    [LATENCY_PROBE_NB]          = "mux",
+};
+
 static void mux_log_debug_ts(OutputStream *ost, const AVPacket *pkt)
 {
-    static const char *desc[] = {
-        [LATENCY_PROBE_DEMUX]       = "demux",
-        [LATENCY_PROBE_DEC_PRE]     = "decode",
-        [LATENCY_PROBE_DEC_POST]    = "decode",
-        [LATENCY_PROBE_FILTER_PRE]  = "filter",
-        [LATENCY_PROBE_FILTER_POST] = "filter",
-        [LATENCY_PROBE_ENC_PRE]     = "encode",
-        [LATENCY_PROBE_ENC_POST]    = "encode",
-        [LATENCY_PROBE_NB]          = "mux",
-    };
-
+    const char *const *desc = latency_probe_desc;
     char latency[512];
 
     *latency = 0;
@@ -206,6 +207,48 @@ static int mux_fixup_ts(Muxer *mux, MuxStream *ms, AVPacket *pkt)
     return 0;
 }
 
+/**
+ * Add the time the packet spent in every stage of the pipeline, as recorded by
+ * the latency probes, to the scheduler trace.
+ */
+static void mux_trace_latency(Muxer *mux, OutputStream *ost, const AVPacket *pkt,
+                              uint64_t frame_num)
+{
+    const MuxStream *ms = ms_from_ost(ost);
+    const SchedulerNode node = SCH_MSTREAM(mux->sch_idx, ms->sch_idx);
+    const FrameData *fd;
+    int64_t now;
+    int prev = -1;
+
+    if (!pkt->opaque_ref)
+        return;
+
+    fd  = (FrameData*)pkt->opaque_ref->data;
+    now = av_gettime_relative();
+
+    for (int i = 0; i <= LATENCY_PROBE_NB; i++) {
+        const int64_t val = (i == LATENCY_PROBE_NB) ? now : fd->wallclock[i];
+        char name[32];
+
+        if (val == INT64_MIN)
+            continue;
+
+        if (prev >= 0) {
+            const char *from = latency_probe_desc[prev];
+            const char *to   = latency_probe_desc[i];
+
+            if (!strcmp(from, to))
+                snprintf(name, sizeof(name), "%s", from);
+            else
+                snprintf(name, sizeof(name), "%s-%s", from, to);
+
+            sch_trace_span(mux->sch, node, frame_num, name,
+                           fd->wallclock[prev], val);
+        }
+        prev = i;
+    }
+}
+
 static int write_packet(Muxer *mux, OutputStream *ost, AVPacket *pkt)
 {
     MuxStream *ms = ms_from_ost(ost);
@@ -233,6 +276,9 @@ static int write_packet(Muxer *mux, OutputStream *ost, AVPacket *pkt)
     if (ms->stats.io)
         enc_stats_write(ost, &ms->stats, NULL, pkt, frame_num);
 
+    if (sch_trace_enabled(mux->sch))
+        mux_trace_latency(mux, ost, pkt, frame_num);
+
     ret = av_interleaved_write_frame(s, pkt);
     if (ret < 0) {
         av_log(ost, AV_LOG_ERROR,
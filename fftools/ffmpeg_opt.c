@@ -71,9 +71,12 @@ int exit_on_error     = 0;
 int abort_on_flags    = 0;
 int print_stats       = -1;
 int stdin_interaction = 1;
+int progress_queues   = 0;
 float max_error_rate  = 2.0/3;
 char *filter_nbthreads;
 int filter_complex_nbthreads = 0;
+int filter_complex_concurrent = 0;
+int share_filtergraphs = 0;
 int vstats_version = 2;
 int auto_conversion_filters = 1;
 int64_t stats_period = 500000;
@@ -353,6 +356,38 @@ static int apply_sync_offsets(void)
     return 0;
 }
 
+static int opt_sched_threads(void *optctx, const char *opt, const char *arg)
+{
+    Scheduler *sch = optctx;
+    double nb_threads;
+    int ret;
+
+    ret = parse_number(opt, arg, OPT_TYPE_INT, 0, INT_MAX, &nb_threads);
+    if (ret < 0)
+        return ret;
+
+    return sch_set_thread_budget(sch, nb_threads);
+}
+
+static int opt_sched_max_memory(void *optctx, const char *opt, const char *arg)
+{
+    Scheduler *sch = optctx;
+    double bytes;
+    int ret;
+
+    ret = parse_number(opt, arg, OPT_TYPE_INT64, 0, INT64_MAX, &bytes);
+    if (ret < 0)
+        return ret;
+
+    return sch_set_memory_budget(sch, bytes);
+}
+
+static int opt_sched_trace(void *optctx, const char *opt, const char *arg)
+{
+    Scheduler *sch = optctx;
+    return sch_trace_filename(sch, arg);
+}
+
 static int opt_filter_threads(void *optctx, const char *opt, const char *arg)
 {
     av_free(filter_nbthreads);
@@ -1515,6 +1550,9 @@ const OptionDef options[] = {
     { "progress",               OPT_TYPE_FUNC, OPT_FUNC_ARG | OPT_EXPERT,
         { .func_arg = opt_progress },
       "write program-readable progress information", "url" },
+    { "progress_queues",        OPT_TYPE_BOOL, OPT_EXPERT,
+        { &progress_queues },
+      "add the fill levels of the input queues to the progress information" },
     { "stdin",                  OPT_TYPE_BOOL, OPT_EXPERT,
         { &stdin_interaction },
       "enable or disable interaction on standard input" },
@@ -1619,6 +1657,21 @@ const OptionDef options[] = {
     { "filter_complex_threads", OPT_TYPE_INT, OPT_EXPERT,
         { &filter_complex_nbthreads },
         "number of threads for -filter_complex" },
+    { "filter_complex_concurrent", OPT_TYPE_BOOL, OPT_EXPERT,
+        { &filter_complex_concurrent },
+        "run independent filters of -filter_complex graphs concurrently" },
+    { "share_filtergraphs",     OPT_TYPE_BOOL, OPT_EXPERT,
+        { &share_filtergraphs },
+        "run identical simple video filtergraphs only once for all encoders using them" },
+    { "sched_threads",          OPT_TYPE_FUNC, OPT_FUNC_ARG | OPT_EXPERT,
+        { .func_arg = opt_sched_threads },
+        "limit the total number of decoding, encoding and filtering threads", "number" },
+    { "sched_max_memory",       OPT_TYPE_FUNC, OPT_FUNC_ARG | OPT_EXPERT,
+        { .func_arg = opt_sched_max_memory },
+        "limit the memory used by packets and frames queued between components", "bytes" },
+    { "sched_trace",            OPT_TYPE_FUNC, OPT_FUNC_ARG | OPT_EXPERT,
+        { .func_arg = opt_sched_trace },
+        "write a trace of the processed frames and queue fill levels", "filename" },
     { "lavfi",               OPT_TYPE_FUNC, OPT_FUNC_ARG | OPT_EXPERT,
         { .func_arg = opt_filter_complex },
         "create a complex filtergraph", "graph_description" },
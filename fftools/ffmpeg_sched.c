@@ -19,6 +19,8 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <inttypes.h>
+#include <stdarg.h>
 #include <stdatomic.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -31,8 +33,12 @@
 
 #include "libavcodec/packet.h"
 
+#include "libavformat/avio.h"
+
 #include "libavutil/avassert.h"
+#include "libavutil/bprint.h"
 #include "libavutil/error.h"
+#include "libavutil/executor.h"
 #include "libavutil/fifo.h"
 #include "libavutil/frame.h"
 #include "libavutil/mem.h"
@@ -235,7 +241,10 @@ typedef struct SchFilterIn {
 } SchFilterIn;
 
 typedef struct SchFilterOut {
-    SchedulerNode       dst;
+    // a video output may feed several encoders that need identical input
+    SchedulerNode      *dst;
+    uint8_t            *dst_finished;
+    unsigned         nb_dst;
 } SchFilterOut;
 
 typedef struct SchFilterGraph {
@@ -247,6 +256,8 @@ typedef struct SchFilterGraph {
     unsigned         nb_inputs_finished_receive;
 
     SchFilterOut       *outputs;
+    // temporary storage used by sch_filter_send()
+    AVFrame            *send_frame;
     unsigned         nb_outputs;
 
     SchTask             task;
@@ -298,6 +309,21 @@ struct Scheduler {
     char               *sdp_filename;
     int                 sdp_auto;
 
+    // total number of threads to be shared by decoders, encoders and
+    // filtergraphs, 0 for no limit
+    int                 thread_budget;
+    // runs the slice threading jobs of all of them when a budget is set
+    AVExecutor         *executor;
+
+    // limit for the memory used by the items in all the queues
+    TQBudget            mem_budget;
+
+    // trace-event JSON output, opened in sch_start() if a filename was set
+    char               *trace_filename;
+    AVIOContext        *trace;
+    pthread_mutex_t     trace_lock;
+    int64_t             trace_start;
+
     enum SchedulerState state;
     atomic_int          terminate;
     atomic_int          task_failed;
@@ -365,25 +391,55 @@ static void waiter_uninit(SchWaiter *w)
     pthread_cond_destroy(&w->cond);
 }
 
+static size_t pkt_size(void *obj)
+{
+    const AVPacket *pkt = obj;
+    return pkt->buf ? pkt->buf->size : pkt->size;
+}
+
+static size_t frame_size(void *obj)
+{
+    const AVFrame *frame = obj;
+    size_t size = 0;
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(frame->buf) && frame->buf[i]; i++)
+        size += frame->buf[i]->size;
+    for (int i = 0; i < frame->nb_extended_buf; i++)
+        size += frame->extended_buf[i]->size;
+
+    return size;
+}
+
 static int queue_alloc(ThreadQueue **ptq, unsigned nb_streams, unsigned queue_size,
                        enum QueueType type)
 {
     ThreadQueue *tq;
     ObjPool *op;
+    unsigned nb_slots;
+    int adaptive = 0;
 
     if (queue_size <= 0) {
         if (type == QUEUE_FRAMES)
             queue_size = DEFAULT_FRAME_THREAD_QUEUE_SIZE;
         else
             queue_size = DEFAULT_PACKET_THREAD_QUEUE_SIZE;
+        adaptive = 1;
+    }
+
+    nb_slots = queue_size;
+    if (adaptive && type == QUEUE_PACKETS) {
+        // a queue shared by many streams should be able to hold at least one
+        // packet for each of them without blocking
+        queue_size = FFMAX(queue_size, nb_streams);
+        nb_slots   = FFMAX(MAX_PACKET_THREAD_QUEUE_SIZE, 2 * queue_size);
     }
 
     if (type == QUEUE_FRAMES) {
         // This queue length is used in the decoder code to ensure that
         // there are enough entries in fixed-size frame pools to account
-        // for frames held in queues inside the ffmpeg utility.  If this
-        // can ever dynamically change then the corresponding decode
-        // code needs to be updated as well.
+        // for frames held in queues inside the ffmpeg utility.  Adaptive
+        // sizing may only shrink it; if it can ever grow beyond this then
+        // the corresponding decode code needs to be updated as well.
         av_assert0(queue_size == DEFAULT_FRAME_THREAD_QUEUE_SIZE);
     }
 
@@ -392,13 +448,16 @@ static int queue_alloc(ThreadQueue **ptq, unsigned nb_streams, unsigned queue_si
     if (!op)
         return AVERROR(ENOMEM);
 
-    tq = tq_alloc(nb_streams, queue_size, op,
+    tq = tq_alloc(nb_streams, nb_slots, op,
                   (type == QUEUE_PACKETS) ? pkt_move : frame_move);
     if (!tq) {
         objpool_free(&op);
         return AVERROR(ENOMEM);
     }
 
+    if (adaptive)
+        tq_set_adaptive(tq, queue_size);
+
     *ptq = tq;
     return 0;
 }
@@ -547,14 +606,30 @@ void sch_free(Scheduler **psch)
         tq_free(&fg->queue);
 
         av_freep(&fg->inputs);
+        for (unsigned j = 0; j < fg->nb_outputs; j++) {
+            av_freep(&fg->outputs[j].dst);
+            av_freep(&fg->outputs[j].dst_finished);
+        }
         av_freep(&fg->outputs);
 
+        av_frame_free(&fg->send_frame);
+
         waiter_uninit(&fg->waiter);
     }
     av_freep(&sch->filters);
 
     av_freep(&sch->sdp_filename);
 
+    // all codec contexts and filtergraphs using it are gone by now
+    av_executor_free(&sch->executor);
+
+    if (sch->trace) {
+        avio_printf(sch->trace, "\n]\n");
+        avio_closep(&sch->trace);
+    }
+    av_freep(&sch->trace_filename);
+    pthread_mutex_destroy(&sch->trace_lock);
+
     pthread_mutex_destroy(&sch->schedule_lock);
 
     pthread_mutex_destroy(&sch->mux_ready_lock);
@@ -582,10 +657,16 @@ Scheduler *sch_alloc(void)
     sch->class    = &scheduler_class;
     sch->sdp_auto = 1;
 
+    atomic_init(&sch->mem_budget.used, 0);
+
     ret = pthread_mutex_init(&sch->schedule_lock, NULL);
     if (ret)
         goto fail;
 
+    ret = pthread_mutex_init(&sch->trace_lock, NULL);
+    if (ret)
+        goto fail;
+
     ret = pthread_mutex_init(&sch->mux_ready_lock, NULL);
     if (ret)
         goto fail;
@@ -611,12 +692,241 @@ int sch_sdp_filename(Scheduler *sch, const char *sdp_filename)
     return sch->sdp_filename ? 0 : AVERROR(ENOMEM);
 }
 
+int sch_set_memory_budget(Scheduler *sch, int64_t bytes)
+{
+    if (bytes < 0)
+        return AVERROR(EINVAL);
+
+    sch->mem_budget.max = bytes;
+    return 0;
+}
+
+static void set_queue_budgets(Scheduler *sch)
+{
+    TQBudget *b = &sch->mem_budget;
+
+    for (unsigned i = 0; i < sch->nb_dec; i++)
+        tq_set_budget(sch->dec[i].queue, b, pkt_size);
+    for (unsigned i = 0; i < sch->nb_filters; i++)
+        tq_set_budget(sch->filters[i].queue, b, frame_size);
+    for (unsigned i = 0; i < sch->nb_enc; i++)
+        tq_set_budget(sch->enc[i].queue, b, frame_size);
+    for (unsigned i = 0; i < sch->nb_mux; i++)
+        tq_set_budget(sch->mux[i].queue, b, pkt_size);
+}
+
+int sch_trace_filename(Scheduler *sch, const char *filename)
+{
+    av_freep(&sch->trace_filename);
+    sch->trace_filename = av_strdup(filename);
+    return sch->trace_filename ? 0 : AVERROR(ENOMEM);
+}
+
+int sch_trace_enabled(const Scheduler *sch)
+{
+    return !!sch->trace;
+}
+
+static void av_printf_format(2, 3)
+trace_printf(Scheduler *sch, const char *fmt, ...)
+{
+    va_list vl;
+
+    pthread_mutex_lock(&sch->trace_lock);
+
+    va_start(vl, fmt);
+    avio_vprintf(sch->trace, fmt, vl);
+    va_end(vl);
+
+    pthread_mutex_unlock(&sch->trace_lock);
+}
+
+static const char *trace_node_name(enum SchedulerNodeType type)
+{
+    switch (type) {
+    case SCH_NODE_TYPE_DEMUX:       return "demux";
+    case SCH_NODE_TYPE_MUX:         return "mux";
+    case SCH_NODE_TYPE_DEC:         return "dec";
+    case SCH_NODE_TYPE_ENC:         return "enc";
+    case SCH_NODE_TYPE_FILTER_IN:
+    case SCH_NODE_TYPE_FILTER_OUT:  return "filter";
+    }
+    return "unknown";
+}
+
+// every node runs in its own thread, give each a distinct thread id
+static unsigned trace_tid(const Scheduler *sch, SchedulerNode node)
+{
+    const unsigned dec    = 1 + sch->nb_demux;
+    const unsigned filter = dec + sch->nb_dec;
+    const unsigned enc    = filter + sch->nb_filters;
+    const unsigned mux    = enc + sch->nb_enc;
+
+    switch (node.type) {
+    case SCH_NODE_TYPE_DEC:         return dec    + node.idx;
+    case SCH_NODE_TYPE_FILTER_IN:
+    case SCH_NODE_TYPE_FILTER_OUT:  return filter + node.idx;
+    case SCH_NODE_TYPE_ENC:         return enc    + node.idx;
+    case SCH_NODE_TYPE_MUX:         return mux    + node.idx;
+    }
+    return 1 + node.idx;
+}
+
+static void trace_queue(Scheduler *sch, SchedulerNode node, ThreadQueue *tq,
+                        int64_t ts)
+{
+    trace_printf(sch, ",\n{\"name\":\"queue %s:%u\",\"ph\":\"C\",\"ts\":%"PRId64","
+                 "\"pid\":1,\"args\":{\"items\":%zu}}",
+                 trace_node_name(node.type), node.idx, ts, tq_depth(tq));
+}
+
+/**
+ * Record an item (packet or frame) passing through a node, together with the
+ * fill level of the node's input queue, if any.
+ */
+static void trace_item(Scheduler *sch, SchedulerNode node, const char *name,
+                       unsigned stream_idx, int64_t pts, ThreadQueue *tq)
+{
+    int64_t ts;
+
+    if (!sch->trace)
+        return;
+
+    ts = av_gettime_relative() - sch->trace_start;
+
+    if (pts == AV_NOPTS_VALUE)
+        trace_printf(sch, ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%"PRId64","
+                     "\"pid\":1,\"tid\":%u,\"args\":{\"stream\":%u}}",
+                     name, ts, trace_tid(sch, node), stream_idx);
+    else
+        trace_printf(sch, ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%"PRId64","
+                     "\"pid\":1,\"tid\":%u,\"args\":{\"stream\":%u,\"pts\":%"PRId64"}}",
+                     name, ts, trace_tid(sch, node), stream_idx, pts);
+
+    if (tq)
+        trace_queue(sch, node, tq, ts);
+}
+
+void sch_trace_span(Scheduler *sch, SchedulerNode node, uint64_t id,
+                    const char *name, int64_t start, int64_t end)
+{
+    if (!sch->trace)
+        return;
+
+    trace_printf(sch, ",\n{\"name\":\"%s\",\"cat\":\"latency\",\"ph\":\"b\","
+                 "\"id\":\"%u:%u:%"PRIu64"\",\"ts\":%"PRId64",\"pid\":1,\"tid\":%u}"
+                 ",\n{\"name\":\"%s\",\"cat\":\"latency\",\"ph\":\"e\","
+                 "\"id\":\"%u:%u:%"PRIu64"\",\"ts\":%"PRId64",\"pid\":1,\"tid\":%u}",
+                 name, node.idx, node.idx_stream, id, start - sch->trace_start,
+                 trace_tid(sch, node),
+                 name, node.idx, node.idx_stream, id, end - sch->trace_start,
+                 trace_tid(sch, node));
+}
+
+static void trace_queues(Scheduler *sch)
+{
+    int64_t ts = av_gettime_relative() - sch->trace_start;
+
+    for (unsigned i = 0; i < sch->nb_dec; i++)
+        trace_queue(sch, SCH_DEC(i), sch->dec[i].queue, ts);
+    for (unsigned i = 0; i < sch->nb_filters; i++)
+        trace_queue(sch, SCH_FILTER_IN(i, 0), sch->filters[i].queue, ts);
+    for (unsigned i = 0; i < sch->nb_enc; i++)
+        trace_queue(sch, SCH_ENC(i), sch->enc[i].queue, ts);
+    for (unsigned i = 0; i < sch->nb_mux; i++)
+        trace_queue(sch, SCH_MSTREAM(i, 0), sch->mux[i].queue, ts);
+}
+
+static int trace_open(Scheduler *sch)
+{
+    static const struct {
+        enum SchedulerNodeType type;
+        size_t                 nb_offset;
+    } nodes[] = {
+        { SCH_NODE_TYPE_DEMUX,     offsetof(Scheduler, nb_demux)   },
+        { SCH_NODE_TYPE_DEC,       offsetof(Scheduler, nb_dec)     },
+        { SCH_NODE_TYPE_FILTER_IN, offsetof(Scheduler, nb_filters) },
+        { SCH_NODE_TYPE_ENC,       offsetof(Scheduler, nb_enc)     },
+        { SCH_NODE_TYPE_MUX,       offsetof(Scheduler, nb_mux)     },
+    };
+    int ret;
+
+    ret = avio_open2(&sch->trace, sch->trace_filename, AVIO_FLAG_WRITE,
+                     NULL, NULL);
+    if (ret < 0) {
+        av_log(sch, AV_LOG_ERROR, "Error opening trace file '%s': %s\n",
+               sch->trace_filename, av_err2str(ret));
+        return ret;
+    }
+
+    sch->trace_start = av_gettime_relative();
+
+    avio_printf(sch->trace, "[\n{\"name\":\"process_name\",\"ph\":\"M\","
+                "\"pid\":1,\"args\":{\"name\":\"ffmpeg\"}}");
+
+    for (unsigned i = 0; i < FF_ARRAY_ELEMS(nodes); i++) {
+        unsigned nb = *(const unsigned*)((const uint8_t*)sch + nodes[i].nb_offset);
+
+        for (unsigned j = 0; j < nb; j++) {
+            SchedulerNode node = { .type = nodes[i].type, .idx = j };
+            avio_printf(sch->trace, ",\n{\"name\":\"thread_name\",\"ph\":\"M\","
+                        "\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s:%u\"}}",
+                        trace_tid(sch, node), trace_node_name(node.type), j);
+        }
+    }
+
+    return 0;
+}
+
+void sch_print_queues(Scheduler *sch, AVBPrint *bp)
+{
+    for (unsigned i = 0; i < sch->nb_dec; i++)
+        av_bprintf(bp, "queue_dec_%u=%zu\n", i, tq_depth(sch->dec[i].queue));
+    for (unsigned i = 0; i < sch->nb_filters; i++)
+        av_bprintf(bp, "queue_filter_%u=%zu\n", i, tq_depth(sch->filters[i].queue));
+    for (unsigned i = 0; i < sch->nb_enc; i++)
+        av_bprintf(bp, "queue_enc_%u=%zu\n", i, tq_depth(sch->enc[i].queue));
+    for (unsigned i = 0; i < sch->nb_mux; i++)
+        av_bprintf(bp, "queue_mux_%u=%zu\n", i, tq_depth(sch->mux[i].queue));
+}
+
 static const AVClass sch_mux_class = {
     .class_name                = "SchMux",
     .version                   = LIBAVUTIL_VERSION_INT,
     .parent_log_context_offset = offsetof(SchMux, task.func_arg),
 };
 
+int sch_set_thread_budget(Scheduler *sch, int nb_threads)
+{
+    if (nb_threads < 0)
+        return AVERROR(EINVAL);
+
+    av_executor_free(&sch->executor);
+    if (nb_threads) {
+        sch->executor = av_executor_alloc_shared(nb_threads);
+        if (!sch->executor)
+            return AVERROR(ENOMEM);
+    }
+
+    sch->thread_budget = nb_threads;
+    return 0;
+}
+
+AVExecutor *sch_executor(const Scheduler *sch)
+{
+    return sch->executor;
+}
+
+int sch_thread_share(const Scheduler *sch)
+{
+    const unsigned nb_users = sch->nb_dec + sch->nb_enc + sch->nb_filters;
+
+    if (!sch->thread_budget)
+        return 0;
+
+    return FFMAX(1, sch->thread_budget / (int)FFMAX(nb_users, 1));
+}
+
 int sch_add_mux(Scheduler *sch, SchThreadFunc func, int (*init)(void *),
                 void *arg, int sdp_auto, unsigned thread_queue_size)
 {
@@ -827,6 +1137,10 @@ int sch_add_filtergraph(Scheduler *sch, unsigned nb_inputs, unsigned nb_outputs,
         fg->nb_outputs = nb_outputs;
     }
 
+    fg->send_frame = av_frame_alloc();
+    if (!fg->send_frame)
+        return AVERROR(ENOMEM);
+
     ret = waiter_init(&fg->waiter);
     if (ret < 0)
         return ret;
@@ -988,8 +1302,16 @@ int sch_connect(Scheduler *sch, SchedulerNode src, SchedulerNode dst)
                    src.idx_stream < sch->filters[src.idx].nb_outputs);
         fo = &sch->filters[src.idx].outputs[src.idx_stream];
 
-        av_assert0(!fo->dst.type);
-        fo->dst = dst;
+        // only encoders may share a filtergraph output
+        av_assert0(!fo->nb_dst ||
+                   (dst.type == SCH_NODE_TYPE_ENC &&
+                    fo->dst[0].type == SCH_NODE_TYPE_ENC));
+
+        ret = GROW_ARRAY(fo->dst, fo->nb_dst);
+        if (ret < 0)
+            return ret;
+
+        fo->dst[fo->nb_dst - 1] = dst;
 
         // filtered frames go to encoding or another filtergraph
         switch (dst.type) {
@@ -1511,11 +1833,15 @@ static int start_prepare(Scheduler *sch)
         for (unsigned j = 0; j < fg->nb_outputs; j++) {
             SchFilterOut *fo = &fg->outputs[j];
 
-            if (!fo->dst.type) {
+            if (!fo->nb_dst) {
                 av_log(fg, AV_LOG_ERROR,
                        "Filtergraph %u output %u not connected to a sink\n", i, j);
                 return AVERROR(EINVAL);
             }
+
+            fo->dst_finished = av_calloc(fo->nb_dst, sizeof(*fo->dst_finished));
+            if (!fo->dst_finished)
+                return AVERROR(ENOMEM);
         }
     }
 
@@ -1535,6 +1861,15 @@ int sch_start(Scheduler *sch)
     if (ret < 0)
         return ret;
 
+    if (sch->mem_budget.max)
+        set_queue_budgets(sch);
+
+    if (sch->trace_filename) {
+        ret = trace_open(sch);
+        if (ret < 0)
+            return ret;
+    }
+
     av_assert0(sch->state == SCH_STATE_UNINIT);
     sch->state = SCH_STATE_STARTED;
 
@@ -1614,6 +1949,9 @@ int sch_wait(Scheduler *sch, uint64_t timeout_us, int64_t *transcode_ts)
 
     *transcode_ts = atomic_load(&sch->last_dts);
 
+    if (sch->trace)
+        trace_queues(sch);
+
     // abort transcoding if any task failed
     err = atomic_load(&sch->task_failed);
 
@@ -1986,6 +2324,9 @@ int sch_demux_send(Scheduler *sch, unsigned demux_idx, AVPacket *pkt,
 
     av_assert0(pkt->stream_index < d->nb_streams);
 
+    trace_item(sch, SCH_DSTREAM(demux_idx, 0), "demux", pkt->stream_index,
+               pkt->pts, NULL);
+
     return demux_send_for_stream(sch, d, &d->streams[pkt->stream_index], pkt, flags);
 }
 
@@ -2021,6 +2362,11 @@ int sch_mux_receive(Scheduler *sch, unsigned mux_idx, AVPacket *pkt)
 
     ret = tq_receive(mux->queue, &stream_idx, pkt);
     pkt->stream_index = stream_idx;
+
+    if (ret >= 0)
+        trace_item(sch, SCH_MSTREAM(mux_idx, 0), "mux", stream_idx, pkt->pts,
+                   mux->queue);
+
     return ret;
 }
 
@@ -2116,6 +2462,9 @@ int sch_dec_receive(Scheduler *sch, unsigned dec_idx, AVPacket *pkt)
     ret = tq_receive(dec->queue, &dummy, pkt);
     av_assert0(dummy <= 0);
 
+    if (ret >= 0)
+        trace_item(sch, SCH_DEC(dec_idx), "decode in", 0, pkt->pts, dec->queue);
+
     // got a flush packet, on the next call to this function the decoder
     // will give us post-flush end timestamp
     if (ret >= 0 && !pkt->data && !pkt->side_data_elems && dec->queue_end_ts)
@@ -2171,6 +2520,34 @@ finish:
     return AVERROR_EOF;
 }
 
+/**
+ * Copy a frame containing props only, e.g. the one close_output() sends to
+ * initialize encoders when no frames were filtered. Unlike
+ * av_frame_copy_props(), this includes the parameters of the data.
+ */
+static int frame_copy_params(AVFrame *dst, const AVFrame *src)
+{
+    int ret;
+
+    ret = av_frame_copy_props(dst, src);
+    if (ret < 0)
+        return ret;
+
+    dst->format      = src->format;
+    dst->width       = src->width;
+    dst->height      = src->height;
+    dst->nb_samples  = src->nb_samples;
+    dst->sample_rate = src->sample_rate;
+
+    ret = av_channel_layout_copy(&dst->ch_layout, &src->ch_layout);
+    if (ret < 0) {
+        av_frame_unref(dst);
+        return ret;
+    }
+
+    return 0;
+}
+
 int sch_dec_send(Scheduler *sch, unsigned dec_idx, AVFrame *frame)
 {
     SchDec *dec;
@@ -2180,6 +2557,9 @@ int sch_dec_send(Scheduler *sch, unsigned dec_idx, AVFrame *frame)
     av_assert0(dec_idx < sch->nb_dec);
     dec = &sch->dec[dec_idx];
 
+    if (frame->buf[0])
+        trace_item(sch, SCH_DEC(dec_idx), "decode out", 0, frame->pts, NULL);
+
     for (unsigned i = 0; i < dec->nb_dst; i++) {
         uint8_t *finished = &dec->dst_finished[i];
         AVFrame *to_send  = frame;
@@ -2191,7 +2571,7 @@ int sch_dec_send(Scheduler *sch, unsigned dec_idx, AVFrame *frame)
             // frame may sometimes contain props only,
             // e.g. to signal EOF timestamp
             ret = frame->buf[0] ? av_frame_ref(to_send, frame) :
-                                  av_frame_copy_props(to_send, frame);
+                                  frame_copy_params(to_send, frame);
             if (ret < 0)
                 return ret;
         }
@@ -2242,6 +2622,9 @@ int sch_enc_receive(Scheduler *sch, unsigned enc_idx, AVFrame *frame)
     ret = tq_receive(enc->queue, &dummy, frame);
     av_assert0(dummy <= 0);
 
+    if (ret >= 0)
+        trace_item(sch, SCH_ENC(enc_idx), "encode in", 0, frame->pts, enc->queue);
+
     return ret;
 }
 
@@ -2283,6 +2666,8 @@ int sch_enc_send(Scheduler *sch, unsigned enc_idx, AVPacket *pkt)
     av_assert0(enc_idx < sch->nb_enc);
     enc = &sch->enc[enc_idx];
 
+    trace_item(sch, SCH_ENC(enc_idx), "encode out", 0, pkt->pts, NULL);
+
     for (unsigned i = 0; i < enc->nb_dst; i++) {
         uint8_t *finished = &enc->dst_finished[i];
         AVPacket *to_send = pkt;
@@ -2359,6 +2744,8 @@ int sch_filter_receive(Scheduler *sch, unsigned fg_idx,
         if (idx < 0)
             return AVERROR_EOF;
         else if (ret >= 0) {
+            trace_item(sch, SCH_FILTER_IN(fg_idx, idx), "filter in", idx,
+                       frame->pts, fg->queue);
             *in_idx = idx;
             return 0;
         }
@@ -2389,20 +2776,81 @@ void sch_filter_receive_finish(Scheduler *sch, unsigned fg_idx, unsigned in_idx)
     }
 }
 
+static int filter_send_to_dst(Scheduler *sch, const SchedulerNode dst,
+                              uint8_t *dst_finished, AVFrame *frame)
+{
+    int ret;
+
+    if (*dst_finished)
+        return AVERROR_EOF;
+
+    if (!frame)
+        goto finish;
+
+    ret = (dst.type == SCH_NODE_TYPE_ENC)                                    ?
+          send_to_enc   (sch, &sch->enc[dst.idx],                     frame) :
+          send_to_filter(sch, &sch->filters[dst.idx], dst.idx_stream, frame);
+    if (ret == AVERROR_EOF)
+        goto finish;
+
+    return ret;
+
+finish:
+    if (dst.type == SCH_NODE_TYPE_ENC)
+        send_to_enc(sch, &sch->enc[dst.idx], NULL);
+    else
+        send_to_filter(sch, &sch->filters[dst.idx], dst.idx_stream, NULL);
+
+    *dst_finished = 1;
+
+    return AVERROR_EOF;
+}
+
 int sch_filter_send(Scheduler *sch, unsigned fg_idx, unsigned out_idx, AVFrame *frame)
 {
     SchFilterGraph *fg;
-    SchedulerNode  dst;
+    SchFilterOut   *fo;
+    unsigned nb_done = 0;
+    int ret;
 
     av_assert0(fg_idx < sch->nb_filters);
     fg = &sch->filters[fg_idx];
 
     av_assert0(out_idx < fg->nb_outputs);
-    dst = fg->outputs[out_idx].dst;
+    fo = &fg->outputs[out_idx];
+
+    if (frame)
+        trace_item(sch, SCH_FILTER_OUT(fg_idx, out_idx), "filter out", out_idx,
+                   frame->pts, NULL);
+
+    for (unsigned i = 0; i < fo->nb_dst; i++) {
+        uint8_t *finished = &fo->dst_finished[i];
+        AVFrame *to_send  = frame;
+
+        // sending a frame consumes it, so make a temporary reference if needed
+        if (frame && i < fo->nb_dst - 1) {
+            to_send = fg->send_frame;
+
+            // frame may contain props only, e.g. to initialize the encoder
+            ret = frame->buf[0] ? av_frame_ref(to_send, frame) :
+                                  frame_copy_params(to_send, frame);
+            if (ret < 0)
+                return ret;
+        }
 
-    return (dst.type == SCH_NODE_TYPE_ENC)                                    ?
-           send_to_enc   (sch, &sch->enc[dst.idx],                     frame) :
-           send_to_filter(sch, &sch->filters[dst.idx], dst.idx_stream, frame);
+        ret = filter_send_to_dst(sch, fo->dst[i], finished, to_send);
+        if (ret < 0) {
+            if (to_send)
+                av_frame_unref(to_send);
+            if (ret == AVERROR_EOF) {
+                nb_done++;
+                continue;
+            }
+            return ret;
+        }
+    }
+
+    return (nb_done == fo->nb_dst) ? AVERROR_EOF : 0;
 }
 
 static int filter_done(Scheduler *sch, unsigned fg_idx)
@@ -2414,13 +2862,13 @@ static int filter_done(Scheduler *sch, unsigned fg_idx)
         tq_receive_finish(fg->queue, i);
 
     for (unsigned i = 0; i < fg->nb_outputs; i++) {
-        SchedulerNode dst = fg->outputs[i].dst;
-        int err = (dst.type == SCH_NODE_TYPE_ENC)                                   ?
-                  send_to_enc   (sch, &sch->enc[dst.idx],                     NULL) :
-                  send_to_filter(sch, &sch->filters[dst.idx], dst.idx_stream, NULL);
+        SchFilterOut *fo = &fg->outputs[i];
 
-        if (err < 0 && err != AVERROR_EOF)
-            ret = err_merge(ret, err);
+        for (unsigned j = 0; j < fo->nb_dst; j++) {
+            int err = filter_send_to_dst(sch, fo->dst[j], &fo->dst_finished[j], NULL);
+            if (err < 0 && err != AVERROR_EOF)
+                ret = err_merge(ret, err);
+        }
     }
 
     pthread_mutex_lock(&sch->schedule_lock);
@@ -74,9 +74,9 @@
  * - encoding and muxing output from filtergraph(s) that have no inputs;
  * - creating a file that contains nothing but attachments and/or metadata.
  *
- * N.B. 2: a filtergraph output could, in principle, feed multiple encoders, but
- * this is unnecessary because the (a)split filter provides the same
- * functionality.
+ * N.B. 2: a filtergraph output may feed multiple encoders; this is used to
+ * share a simple filtergraph between encoders that need identical input,
+ * otherwise the (a)split filter provides the same functionality.
  *
  * The scheduler, in the above model, is the master object that oversees and
  * facilitates the transcoding process. The basic idea is that all instances
@@ -85,6 +85,8 @@
  * knowledge about the whole transcoding pipeline.
  */
 
+struct AVBPrint;
+struct AVExecutor;
 struct AVFrame;
 struct AVPacket;
 
@@ -130,6 +132,73 @@ typedef int (*SchThreadFunc)(void *arg);
 Scheduler *sch_alloc(void);
 void sch_free(Scheduler **sch);
 
+/**
+ * Limit the total number of worker threads used by the decoders, encoders and
+ * filtergraphs managed by this scheduler.
+ *
+ * @param nb_threads the thread budget; 0 (the default) lets every component
+ *                   choose its thread count automatically
+ */
+int sch_set_thread_budget(Scheduler *sch, int nb_threads);
+
+/**
+ * Get the number of threads a decoder, encoder or filtergraph whose thread
+ * count was not set explicitly should use, so that all of them together stay
+ * within the thread budget. The budget is split evenly between the components
+ * added to the scheduler at the time of the call; decoders, which are opened
+ * before all components are known, may thus get a larger share.
+ *
+ * @return the thread count, or 0 if no thread budget is set
+ */
+int sch_thread_share(const Scheduler *sch);
+
+/**
+ * Get the shared executor that decoders, encoders and filtergraphs should use
+ * for their slice threading, so that its workers are the only slice threads in
+ * the process and their number stays within the thread budget. Frame threads
+ * of decoders and encoders are still private to them and are bounded through
+ * sch_thread_share() only.
+ *
+ * @return the executor, or NULL if no thread budget is set
+ */
+struct AVExecutor *sch_executor(const Scheduler *sch);
+
+/**
+ * Limit the total memory used by the packets and frames waiting in the queues
+ * between components. Once the limit is reached, sending to any queue that is
+ * not empty blocks until its consumer catches up.
+ *
+ * @param bytes the limit in bytes, 0 (the default) for no limit
+ */
+int sch_set_memory_budget(Scheduler *sch, int64_t bytes);
+
+/**
+ * Write a trace of the items passing through all the components and of the
+ * fill levels of their input queues to the given file, in the Chrome
+ * trace-event JSON format. The file is opened in sch_start().
+ */
+int sch_trace_filename(Scheduler *sch, const char *filename);
+
+/**
+ * @return 1 if a trace is being written, 0 otherwise
+ */
+int sch_trace_enabled(const Scheduler *sch);
+
+/**
+ * Add a span to the trace, e.g. the time a packet spent in some processing
+ * stage. Spans sharing the same node and id are grouped together.
+ *
+ * @param start,end wallclock times as returned by av_gettime_relative()
+ */
+void sch_trace_span(Scheduler *sch, SchedulerNode node, uint64_t id,
+                    const char *name, int64_t start, int64_t end);
+
+/**
+ * Print the number of items waiting in the input queue of every component
+ * as key=value lines, in the format used by the -progress option.
+ */
+void sch_print_queues(Scheduler *sch, struct AVBPrint *bp);
+
 int sch_start(Scheduler *sch);
 int sch_stop(Scheduler *sch, int64_t *finish_ts);
 
@@ -240,12 +309,21 @@ int sch_add_mux(Scheduler *sch, SchThreadFunc func, int (*init)(void *),
 
 /**
  * Default size of a packet thread queue.  For muxing this can be overridden by
- * the thread_queue_size option as passed to a call to sch_add_mux().
+ * the thread_queue_size option as passed to a call to sch_add_mux(). Queues of
+ * default size adapt their length to the traffic, starting from this size or
+ * the number of streams sharing the queue, whichever is larger.
  */
 #define DEFAULT_PACKET_THREAD_QUEUE_SIZE 8
 
 /**
- * Default size of a frame thread queue.
+ * Maximum size a packet thread queue of default size may grow to, unless it is
+ * shared by more streams.
+ */
+#define MAX_PACKET_THREAD_QUEUE_SIZE 64
+
+/**
+ * Default size of a frame thread queue. Frame queues may shrink, but never
+ * grow beyond this size.
  */
 #define DEFAULT_FRAME_THREAD_QUEUE_SIZE 8
 
@@ -16,13 +16,14 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <stdatomic.h>
 #include <stdint.h>
 #include <string.h>
 
 #include "libavutil/avassert.h"
+#include "libavutil/common.h"
+#include "libavutil/cpu.h"
 #include "libavutil/error.h"
-#include "libavutil/fifo.h"
-#include "libavutil/intreadwrite.h"
 #include "libavutil/mem.h"
 #include "libavutil/thread.h"
 
@@ -34,20 +35,70 @@ enum {
     FINISHED_RECV = (1 << 1),
 };
 
-typedef struct FifoElem {
-    void        *obj;
-    unsigned int stream_idx;
-} FifoElem;
+// bounds for the number of polls before a waiting thread goes to sleep
+#define SPIN_MIN   16
+#define SPIN_MAX 4096
+
+// number of received items after which an adaptive queue revises its limit
+#define ADAPT_PERIOD 32
+
+/**
+ * An entry in the ring buffer. Every slot owns an object for its whole
+ * lifetime, items are moved in and out of it using the obj_move() callback.
+ *
+ * seq follows the scheme of a bounded MPMC queue by Dmitry Vyukov: for the
+ * slot at position pos it is equal to pos when the slot is free for writing,
+ * and to pos + 1 once an item has been stored in it. The consumer releases
+ * the slot to the next round of writers by setting it to pos + nb_slots.
+ */
+typedef struct Slot {
+    atomic_uint_least64_t seq;
+    unsigned int   stream_idx;
+    void          *obj;
+    // memory used by the item, as accounted against the budget
+    size_t         size;
+} Slot;
 
 struct ThreadQueue {
-    int              *finished;
+    atomic_int       *finished;
     unsigned int    nb_streams;
 
-    AVFifo  *fifo;
+    Slot             *slots;
+    size_t         nb_slots;
+
+    // position at which the next item will be written, shared by producers
+    atomic_uint_least64_t tail;
+    // position of the next item to be read, only written by the consumer
+    atomic_uint_least64_t head;
 
     ObjPool *obj_pool;
     void   (*obj_move)(void *dst, void *src);
 
+    // used by the consumer to drop items sent to recv-finished streams
+    void    *discard;
+
+    // number of items that may be queued, at most nb_slots
+    atomic_size_t limit;
+
+    // adaptive sizing, see tq_set_adaptive(); the counters are reset every
+    // ADAPT_PERIOD received items
+    int         adaptive;
+    unsigned    nb_received;
+    unsigned    nb_recv_waits;
+    atomic_uint nb_send_waits;
+
+    TQBudget *budget;
+    size_t  (*obj_size)(void *obj);
+
+    // number of polls before sleeping, adapted to how long waits usually take
+    int        spin_max;
+    int        spin_recv;
+    atomic_int spin_send;
+
+    // threads sleeping on cond wait until event is bumped by a state change
+    atomic_uint nb_waiters;
+    atomic_uint event;
+
     pthread_mutex_t lock;
     pthread_cond_t  cond;
 };
@@ -59,13 +110,13 @@ void tq_free(ThreadQueue **ptq)
     if (!tq)
         return;
 
-    if (tq->fifo) {
-        FifoElem elem;
-        while (av_fifo_read(tq->fifo, &elem, 1) >= 0)
-            objpool_release(tq->obj_pool, &elem.obj);
+    if (tq->slots) {
+        for (size_t i = 0; i < tq->nb_slots; i++)
+            objpool_release(tq->obj_pool, &tq->slots[i].obj);
     }
-    av_fifo_freep2(&tq->fifo);
+    av_freep(&tq->slots);
 
+    objpool_release(tq->obj_pool, &tq->discard);
     objpool_free(&tq->obj_pool);
 
     av_freep(&tq->finished);
@@ -82,6 +133,8 @@ ThreadQueue *tq_alloc(unsigned int nb_streams, size_t queue_size,
     ThreadQueue *tq;
     int ret;
 
+    av_assert0(queue_size > 0);
+
     tq = av_mallocz(sizeof(*tq));
     if (!tq)
         return NULL;
@@ -99,17 +152,44 @@ ThreadQueue *tq_alloc(unsigned int nb_streams, size_t queue_size,
         return NULL;
     }
 
+    tq->obj_pool = obj_pool;
+    tq->obj_move = obj_move;
+
     tq->finished = av_calloc(nb_streams, sizeof(*tq->finished));
     if (!tq->finished)
         goto fail;
+    for (unsigned int i = 0; i < nb_streams; i++)
+        atomic_init(&tq->finished[i], 0);
     tq->nb_streams = nb_streams;
 
-    tq->fifo = av_fifo_alloc2(queue_size, sizeof(FifoElem), 0);
-    if (!tq->fifo)
+    tq->slots = av_calloc(queue_size, sizeof(*tq->slots));
+    if (!tq->slots)
         goto fail;
+    tq->nb_slots = queue_size;
+    atomic_init(&tq->limit, queue_size);
+    atomic_init(&tq->nb_send_waits, 0);
 
-    tq->obj_pool = obj_pool;
-    tq->obj_move = obj_move;
+    for (size_t i = 0; i < queue_size; i++) {
+        atomic_init(&tq->slots[i].seq, i);
+        ret = objpool_get(obj_pool, &tq->slots[i].obj);
+        if (ret < 0)
+            goto fail;
+    }
+
+    ret = objpool_get(obj_pool, &tq->discard);
+    if (ret < 0)
+        goto fail;
+
+    atomic_init(&tq->tail, 0);
+    atomic_init(&tq->head, 0);
+
+    // spinning only makes sense if the other side can run meanwhile
+    tq->spin_max  = av_cpu_count() > 1 ? SPIN_MAX : 0;
+    tq->spin_recv = FFMIN(SPIN_MIN, tq->spin_max);
+    atomic_init(&tq->spin_send, tq->spin_recv);
+
+    atomic_init(&tq->nb_waiters, 0);
+    atomic_init(&tq->event,      0);
 
     return tq;
 fail:
@@ -117,109 +197,292 @@ fail:
     return NULL;
 }
 
-int tq_send(ThreadQueue *tq, unsigned int stream_idx, void *data)
+static void wake_waiters(ThreadQueue *tq)
 {
-    int *finished;
-    int ret;
+    // pairs with the fence in wait_until(): either the waiter observes the
+    // state change made by the caller, or we observe the waiter
+    atomic_thread_fence(memory_order_seq_cst);
 
-    av_assert0(stream_idx < tq->nb_streams);
-    finished = &tq->finished[stream_idx];
+    if (!atomic_load_explicit(&tq->nb_waiters, memory_order_relaxed))
+        return;
 
     pthread_mutex_lock(&tq->lock);
+    atomic_fetch_add_explicit(&tq->event, 1, memory_order_relaxed);
+    pthread_cond_broadcast(&tq->cond);
+    pthread_mutex_unlock(&tq->lock);
+}
 
-    if (*finished & FINISHED_SEND) {
-        ret = AVERROR(EINVAL);
-        goto finish;
+/**
+ * Wait until ready() returns non-zero, polling it up to spin times before
+ * going to sleep.
+ *
+ * @return the adjusted spin count for the next wait
+ */
+static int wait_until(ThreadQueue *tq, int (*ready)(ThreadQueue *, unsigned int),
+                      unsigned int stream_idx, int spin)
+{
+    unsigned int event;
+
+    for (int i = 0; i < spin; i++) {
+        if (ready(tq, stream_idx))
+            return FFMIN(2 * spin, tq->spin_max);
     }
 
-    while (!(*finished & FINISHED_RECV) && !av_fifo_can_write(tq->fifo))
-        pthread_cond_wait(&tq->cond, &tq->lock);
+    atomic_fetch_add(&tq->nb_waiters, 1);
+    atomic_thread_fence(memory_order_seq_cst);
+
+    event = atomic_load_explicit(&tq->event, memory_order_relaxed);
+    if (!ready(tq, stream_idx)) {
+        pthread_mutex_lock(&tq->lock);
+        while (atomic_load_explicit(&tq->event, memory_order_relaxed) == event &&
+               !ready(tq, stream_idx))
+            pthread_cond_wait(&tq->cond, &tq->lock);
+        pthread_mutex_unlock(&tq->lock);
+    }
 
-    if (*finished & FINISHED_RECV) {
-        ret = AVERROR_EOF;
-        *finished |= FINISHED_SEND;
-    } else {
-        FifoElem elem = { .stream_idx = stream_idx };
+    atomic_fetch_sub(&tq->nb_waiters, 1);
 
-        ret = objpool_get(tq->obj_pool, &elem.obj);
-        if (ret < 0)
-            goto finish;
+    return FFMIN(FFMAX(spin / 2, SPIN_MIN), tq->spin_max);
+}
+
+/**
+ * Check whether another item may be queued at position pos, besides the slot
+ * being free: the number of queued items must stay below the queue limit and,
+ * unless the queue is empty, the budget must not be exhausted.
+ */
+static int below_limits(ThreadQueue *tq, uint64_t pos)
+{
+    uint64_t head = atomic_load_explicit(&tq->head, memory_order_relaxed);
+
+    if (pos - head >= atomic_load_explicit(&tq->limit, memory_order_relaxed))
+        return 0;
+
+    return !tq->budget || pos == head ||
+           atomic_load_explicit(&tq->budget->used, memory_order_relaxed) <
+           tq->budget->max;
+}
+
+static int send_ready(ThreadQueue *tq, unsigned int stream_idx)
+{
+    uint64_t pos = atomic_load_explicit(&tq->tail, memory_order_relaxed);
+    uint64_t seq = atomic_load_explicit(&tq->slots[pos % tq->nb_slots].seq,
+                                        memory_order_acquire);
+
+    return ((int64_t)(seq - pos) >= 0 && below_limits(tq, pos)) ||
+           (atomic_load_explicit(&tq->finished[stream_idx], memory_order_acquire) &
+            FINISHED_RECV);
+}
+
+int tq_send(ThreadQueue *tq, unsigned int stream_idx, void *data)
+{
+    atomic_int *finished;
+    Slot *slot;
+    uint64_t pos;
+    int flags;
+
+    av_assert0(stream_idx < tq->nb_streams);
+    finished = &tq->finished[stream_idx];
+
+    flags = atomic_load_explicit(finished, memory_order_acquire);
+    if (flags & FINISHED_SEND)
+        return AVERROR(EINVAL);
+
+    pos = atomic_load_explicit(&tq->tail, memory_order_relaxed);
+    while (1) {
+        uint64_t seq;
+        int64_t  diff;
+
+        if (flags & FINISHED_RECV) {
+            atomic_fetch_or(finished, FINISHED_SEND);
+            return AVERROR_EOF;
+        }
+
+        slot = &tq->slots[pos % tq->nb_slots];
+        seq  = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        diff = (int64_t)(seq - pos);
+
+        if (!diff && below_limits(tq, pos)) {
+            // the slot is free, try to claim it
+            if (atomic_compare_exchange_weak_explicit(&tq->tail, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+                break;
+        } else if (diff <= 0) {
+            // the queue is full
+            int spin = atomic_load_explicit(&tq->spin_send, memory_order_relaxed);
+            if (tq->adaptive)
+                atomic_fetch_add_explicit(&tq->nb_send_waits, 1, memory_order_relaxed);
+            spin = wait_until(tq, send_ready, stream_idx, spin);
+            atomic_store_explicit(&tq->spin_send, spin, memory_order_relaxed);
+
+            pos = atomic_load_explicit(&tq->tail, memory_order_relaxed);
+        } else {
+            // another producer claimed this slot
+            pos = atomic_load_explicit(&tq->tail, memory_order_relaxed);
+        }
 
-        tq->obj_move(elem.obj, data);
+        flags = atomic_load_explicit(finished, memory_order_acquire);
+    }
 
-        ret = av_fifo_write(tq->fifo, &elem, 1);
-        av_assert0(ret >= 0);
-        pthread_cond_broadcast(&tq->cond);
+    tq->obj_move(slot->obj, data);
+    slot->stream_idx = stream_idx;
+    if (tq->budget) {
+        slot->size = tq->obj_size(slot->obj);
+        atomic_fetch_add_explicit(&tq->budget->used, slot->size, memory_order_relaxed);
     }
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
 
-finish:
-    pthread_mutex_unlock(&tq->lock);
+    wake_waiters(tq);
 
-    return ret;
+    return 0;
 }
 
-static int receive_locked(ThreadQueue *tq, int *stream_idx,
-                          void *data)
+/**
+ * Revise the limit of an adaptive queue, based on who had to wait during the
+ * last period. If both the producers and the consumer waited, the input
+ * arrives in bursts that the queue is too short to absorb, so it is doubled.
+ * If only the producers waited, the consumer is the bottleneck and a longer
+ * queue would only add latency and memory use, so it is shrunk.
+ */
+static void adapt_limit(ThreadQueue *tq)
 {
-    FifoElem elem;
-    unsigned int nb_finished = 0;
+    unsigned send_waits = atomic_exchange_explicit(&tq->nb_send_waits, 0,
+                                                   memory_order_relaxed);
+    size_t limit = atomic_load_explicit(&tq->limit, memory_order_relaxed);
 
-    while (av_fifo_read(tq->fifo, &elem, 1) >= 0) {
-        if (tq->finished[elem.stream_idx] & FINISHED_RECV) {
-            objpool_release(tq->obj_pool, &elem.obj);
-            continue;
+    if (send_waits && tq->nb_recv_waits)
+        limit = FFMIN(2 * limit, tq->nb_slots);
+    else if (send_waits && limit > 1)
+        limit--;
+
+    atomic_store_explicit(&tq->limit, limit, memory_order_relaxed);
+
+    tq->nb_received   = 0;
+    tq->nb_recv_waits = 0;
+}
+
+static int receive_item(ThreadQueue *tq, int *stream_idx, void *data)
+{
+    while (1) {
+        uint64_t head = atomic_load_explicit(&tq->head, memory_order_relaxed);
+        Slot *slot    = &tq->slots[head % tq->nb_slots];
+        uint64_t seq  = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        int discard;
+
+        if (seq != head + 1)
+            return AVERROR(EAGAIN);
+
+        discard = atomic_load_explicit(&tq->finished[slot->stream_idx],
+                                       memory_order_relaxed) & FINISHED_RECV;
+        if (discard) {
+            tq->obj_move(tq->discard, slot->obj);
+            objpool_release(tq->obj_pool, &tq->discard);
+            // cannot fail, as the object released above is returned
+            objpool_get(tq->obj_pool, &tq->discard);
+        } else {
+            tq->obj_move(data, slot->obj);
+            *stream_idx = slot->stream_idx;
         }
 
-        tq->obj_move(data, elem.obj);
-        objpool_release(tq->obj_pool, &elem.obj);
-        *stream_idx = elem.stream_idx;
-        return 0;
+        if (tq->budget)
+            atomic_fetch_sub_explicit(&tq->budget->used, slot->size,
+                                      memory_order_relaxed);
+
+        atomic_store_explicit(&slot->seq, head + tq->nb_slots,
+                              memory_order_release);
+        atomic_store_explicit(&tq->head, head + 1, memory_order_relaxed);
+
+        if (tq->adaptive && ++tq->nb_received == ADAPT_PERIOD)
+            adapt_limit(tq);
+
+        wake_waiters(tq);
+
+        if (!discard)
+            return 0;
     }
+}
+
+static int receive_eof(ThreadQueue *tq, int *stream_idx)
+{
+    unsigned int nb_finished = 0;
+    int eof_idx = -1;
 
     for (unsigned int i = 0; i < tq->nb_streams; i++) {
-        if (!tq->finished[i])
+        int flags = atomic_load_explicit(&tq->finished[i], memory_order_acquire);
+
+        if (!flags)
             continue;
 
-        /* return EOF to the consumer at most once for each stream */
-        if (!(tq->finished[i] & FINISHED_RECV)) {
-            tq->finished[i] |= FINISHED_RECV;
-            *stream_idx   = i;
-            return AVERROR_EOF;
+        if (!(flags & FINISHED_RECV)) {
+            if (eof_idx < 0)
+                eof_idx = i;
+            continue;
         }
 
         nb_finished++;
     }
 
+    // the flags were loaded first, so that if the queue is empty now, it
+    // will contain nothing more for streams that were seen as finished
+    if (atomic_load_explicit(&tq->tail, memory_order_relaxed) !=
+        atomic_load_explicit(&tq->head, memory_order_relaxed))
+        return AVERROR(EAGAIN);
+
+    /* return EOF to the consumer at most once for each stream */
+    if (eof_idx >= 0) {
+        atomic_fetch_or(&tq->finished[eof_idx], FINISHED_RECV);
+        *stream_idx = eof_idx;
+        return AVERROR_EOF;
+    }
+
     return nb_finished == tq->nb_streams ? AVERROR_EOF : AVERROR(EAGAIN);
 }
 
+static int receive_ready(ThreadQueue *tq, unsigned int stream_idx)
+{
+    uint64_t head = atomic_load_explicit(&tq->head, memory_order_relaxed);
+    Slot *slot    = &tq->slots[head % tq->nb_slots];
+    unsigned int nb_active = 0;
+
+    if (atomic_load_explicit(&slot->seq, memory_order_acquire) == head + 1)
+        return 1;
+
+    // something is being written, wait for it to be finished
+    if (atomic_load_explicit(&tq->tail, memory_order_relaxed) != head)
+        return 0;
+
+    for (unsigned int i = 0; i < tq->nb_streams; i++) {
+        int flags = atomic_load_explicit(&tq->finished[i], memory_order_relaxed);
+
+        // there is an EOF to return
+        if (flags == FINISHED_SEND)
+            return 1;
+        if (!(flags & FINISHED_RECV))
+            nb_active++;
+    }
+
+    return !nb_active;
+}
+
 int tq_receive(ThreadQueue *tq, int *stream_idx, void *data)
 {
     int ret;
 
     *stream_idx = -1;
 
-    pthread_mutex_lock(&tq->lock);
-
     while (1) {
-        size_t can_read = av_fifo_can_read(tq->fifo);
-
-        ret = receive_locked(tq, stream_idx, data);
+        ret = receive_item(tq, stream_idx, data);
+        if (ret != AVERROR(EAGAIN))
+            break;
 
-        // signal other threads if the fifo state changed
-        if (can_read != av_fifo_can_read(tq->fifo))
-            pthread_cond_broadcast(&tq->cond);
+        ret = receive_eof(tq, stream_idx);
+        if (ret != AVERROR(EAGAIN))
+            break;
 
-        if (ret == AVERROR(EAGAIN)) {
-            pthread_cond_wait(&tq->cond, &tq->lock);
-            continue;
-        }
-
-        break;
+        tq->nb_recv_waits++;
+        tq->spin_recv = wait_until(tq, receive_ready, 0, tq->spin_recv);
     }
 
-    pthread_mutex_unlock(&tq->lock);
-
     return ret;
 }
 
@@ -227,28 +490,44 @@ void tq_send_finish(ThreadQueue *tq, unsigned int stream_idx)
 {
     av_assert0(stream_idx < tq->nb_streams);
 
-    pthread_mutex_lock(&tq->lock);
-
     /* mark the stream as send-finished;
      * next time the consumer thread tries to read this stream it will get
      * an EOF and recv-finished flag will be set */
-    tq->finished[stream_idx] |= FINISHED_SEND;
-    pthread_cond_broadcast(&tq->cond);
+    atomic_fetch_or(&tq->finished[stream_idx], FINISHED_SEND);
 
-    pthread_mutex_unlock(&tq->lock);
+    wake_waiters(tq);
 }
 
 void tq_receive_finish(ThreadQueue *tq, unsigned int stream_idx)
 {
     av_assert0(stream_idx < tq->nb_streams);
 
-    pthread_mutex_lock(&tq->lock);
-
     /* mark the stream as recv-finished;
      * next time the producer thread tries to send for this stream, it will
      * get an EOF and send-finished flag will be set */
-    tq->finished[stream_idx] |= FINISHED_RECV;
-    pthread_cond_broadcast(&tq->cond);
+    atomic_fetch_or(&tq->finished[stream_idx], FINISHED_RECV);
 
-    pthread_mutex_unlock(&tq->lock);
+    wake_waiters(tq);
+}
+
+size_t tq_depth(ThreadQueue *tq)
+{
+    uint64_t head = atomic_load_explicit(&tq->head, memory_order_relaxed);
+    uint64_t tail = atomic_load_explicit(&tq->tail, memory_order_relaxed);
+
+    // the two loads are not synchronized, clip to the valid range
+    return tail > head ? FFMIN(tail - head, tq->nb_slots) : 0;
+}
+
+void tq_set_adaptive(ThreadQueue *tq, size_t initial_size)
+{
+    tq->adaptive = 1;
+    atomic_store(&tq->limit, av_clip(initial_size, 1, tq->nb_slots));
+}
+
+void tq_set_budget(ThreadQueue *tq, TQBudget *budget,
+                   size_t (*obj_size)(void *obj))
+{
+    tq->budget   = budget;
+    tq->obj_size = obj_size;
 }
@@ -19,12 +19,28 @@
 #ifndef FFTOOLS_THREAD_QUEUE_H
 #define FFTOOLS_THREAD_QUEUE_H
 
+#include <stdatomic.h>
+#include <stdint.h>
 #include <string.h>
 
 #include "objpool.h"
 
 typedef struct ThreadQueue ThreadQueue;
 
+/**
+ * Memory budget shared by several queues.
+ */
+typedef struct TQBudget {
+    /**
+     * Total size of the items currently stored in the queues using the budget.
+     */
+    atomic_int_least64_t used;
+    /**
+     * Sending to a non-empty queue blocks while used is at least this large.
+     */
+    int64_t              max;
+} TQBudget;
+
 /**
  * Allocate a queue for sending data between threads.
  *
@@ -78,4 +94,34 @@ int tq_receive(ThreadQueue *tq, int *stream_idx, void *data);
  */
 void tq_receive_finish(ThreadQueue *tq, unsigned int stream_idx);
 
+/**
+ * Get the number of items currently stored in the queue. May be called from
+ * any thread; the value is only a snapshot and may be stale by the time it is
+ * returned.
+ */
+size_t tq_depth(ThreadQueue *tq);
+
+/**
+ * Make the queue adapt its length to the traffic passing through it. It starts
+ * out accepting initial_size items and is then periodically lengthened, if the
+ * input arrives in bursts during which its producers block, or shortened, if
+ * the consumer is too slow for a longer queue to help. The length stays within
+ * 1 and the queue_size passed to tq_alloc().
+ *
+ * Must be called before the queue is used.
+ */
+void tq_set_adaptive(ThreadQueue *tq, size_t initial_size);
+
+/**
+ * Account the memory used by the items stored in this queue against the given
+ * budget. Sending to this queue blocks while the budget is exhausted, unless
+ * the queue is empty, so that every consumer can always make progress.
+ *
+ * Must be called before the queue is used.
+ *
+ * @param obj_size callback returning the memory used by an item
+ */
+void tq_set_budget(ThreadQueue *tq, TQBudget *budget,
+                   size_t (*obj_size)(void *obj));
+
 #endif // FFTOOLS_THREAD_QUEUE_H
@@ -430,7 +430,7 @@ av_cold void ff_codec_close(AVCodecContext *avctx)
             avci->frame_thread_encoder && avctx->thread_count > 1) {
             ff_frame_thread_encoder_free(avctx);
         }
-        if (HAVE_THREADS && avci->thread_ctx)
+        if (HAVE_THREADS && (avci->thread_ctx || avci->slice_thread_ctx))
             ff_thread_free(avctx);
         if (avci->needs_close && ffcodec(avctx->codec)->close)
             ffcodec(avctx->codec)->close(avctx);
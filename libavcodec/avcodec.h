@@ -1589,7 +1589,8 @@ typedef struct AVCodecContext {
     /**
      * Which multithreading methods to use.
      * Use of FF_THREAD_FRAME will increase decoding delay by one frame per thread,
-     * so clients which cannot provide future frames should not use it.
+     * so clients which cannot provide future frames should not use it, unless
+     * FF_THREAD_LOW_DELAY is also set.
      *
      * - encoding: Set by user, otherwise the default is used.
      * - decoding: Set by user, otherwise the default is used.
@@ -1597,6 +1598,15 @@ typedef struct AVCodecContext {
     int thread_type;
 #define FF_THREAD_FRAME   1 ///< Decode more than one frame at once
 #define FF_THREAD_SLICE   2 ///< Decode more than one part of a single frame at once
+/**
+ * With FF_THREAD_FRAME, return each frame as soon as it and all the frames
+ * before it are decoded, instead of only once all threads are busy. While
+ * the oldest frame is still being decoded, AVERROR(EAGAIN) is returned as
+ * usual so that the next packet can start on a free thread, and a later
+ * call returns the frame as soon as it is done. This also allows frame
+ * threading with AV_CODEC_FLAG_LOW_DELAY.
+ */
+#define FF_THREAD_LOW_DELAY 4
 
     /**
      * Which multithreading methods are in use by the codec.
@@ -2080,6 +2090,26 @@ typedef struct AVCodecContext {
      */
     AVFrameSideData  **decoded_side_data;
     int             nb_decoded_side_data;
+
+    /**
+     * Executor allocated with av_executor_alloc_shared(). If set, slice
+     * threading runs its jobs on the threads of this executor, which may be
+     * shared with other codec contexts and filter graphs, instead of creating
+     * its own threads. thread_count then limits the number of threads working
+     * for this context at the same time.
+     *
+     * Frame threading keeps its own threads. If thread_type also includes
+     * FF_THREAD_SLICE, decoders supporting it (currently H.264) additionally
+     * decode the slices of each frame in parallel on this executor. As with
+     * slice threading alone, H.264 then disables error resilience unless
+     * its enable_er option is set.
+     *
+     * - encoding: may be set by the user before calling avcodec_open2(); the
+     *             executor is not owned by the context and must outlive it.
+     * - decoding: may be set by the user before calling avcodec_open2(); the
+     *             executor is not owned by the context and must outlive it.
+     */
+    struct AVExecutor *executor;
 } AVCodecContext;
 
 /**
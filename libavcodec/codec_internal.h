@@ -88,6 +88,12 @@
  * encoders do.
  */
 #define FF_CODEC_CAP_EOF_FLUSH              (1 << 10)
+/**
+ * With frame threading, the per-thread contexts can decode their slices in
+ * parallel on AVCodecContext.executor, if slice threading was requested as
+ * well. Their active_thread_type is then FF_THREAD_FRAME | FF_THREAD_SLICE.
+ */
+#define FF_CODEC_CAP_FRAME_SLICE_THREADS    (1 << 11)
 
 /**
  * FFCodec.codec_tags termination value
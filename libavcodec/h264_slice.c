@@ -2525,7 +2525,7 @@ static void decode_finish_row(const H264Context *h, H264SliceContext *sl)
 
     ff_h264_draw_horiz_band(h, sl, top, height);
 
-    if (h->droppable || h->er.error_occurred)
+    if (h->droppable || h->er.error_occurred || h->postpone_progress)
         return;
 
     ff_thread_report_progress(&h->cur_pic_ptr->tf, top + height - 1,
@@ -2801,6 +2801,8 @@ int ff_h264_execute_decode_slices(H264Context *h)
             sl->next_slice_idx = next_slice_idx;
         }
 
+        h->postpone_progress = !!(avctx->active_thread_type & FF_THREAD_FRAME);
+
         avctx->execute(avctx, decode_slice, h->slice_ctx,
                        NULL, context_count, sizeof(h->slice_ctx[0]));
 
@@ -2825,6 +2827,17 @@ int ff_h264_execute_decode_slices(H264Context *h)
                 }
             }
         }
+
+        if (h->postpone_progress) {
+            /* the rows above the last slice are complete, except for the
+             * pixels the deblocking of its first row may still change */
+            int top = 16 * (h->mb_y >> FIELD_PICTURE(h)) - ((16 + 4) << FRAME_MBAFF(h));
+
+            h->postpone_progress = 0;
+            if (top > 0 && !h->droppable && !h->er.error_occurred)
+                ff_thread_report_progress(&h->cur_pic_ptr->tf, top - 1,
+                                          h->picture_structure == PICT_BOTTOM_FIELD);
+        }
     }
 
 finish:
@@ -374,6 +374,11 @@ typedef struct H264Context {
      * during normal MB decoding and execute it serially at the end.
      */
     int postpone_filter;
+    /* Set while slices are decoded in parallel in a frame thread. The rows
+     * finished by one slice thread may follow rows still being decoded by
+     * another, so the frame progress is only reported once all of them are
+     * done. */
+    int postpone_progress;
 
     /*
      * Set to 1 when the current picture is IDR, 0 otherwise.
@@ -23,7 +23,10 @@
  */
 
 #include "libavutil/common.h"
+#include "libavutil/executor.h"
 #include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libavutil/thread.h"
 
 #include "hevcdec.h"
 #include "progressframe.h"
@@ -922,3 +925,250 @@ void ff_hevc_hls_filters(HEVCLocalContext *lc, const HEVCLayerContext *l,
     if (x_ctb && y_end)
         ff_hevc_hls_filter(lc, l, pps, x_ctb - ctb_size, y_ctb, ctb_size);
 }
+
+/*
+ * Loop filtering on an executor.
+ *
+ * ff_hevc_hls_filters() filters CTB (x, y) once (x + 1, y + 1) has been
+ * decoded, i.e. the filters run one CTB row and column behind the decoding.
+ * The row jobs below keep these dependencies, together with the raster
+ * order of the filter calls between neighbouring CTBs: CTB (x, y) is
+ * filtered once the CTBs up to x + 1 of rows y and y + 1 are decoded and
+ * the CTBs up to x + 1 of row y - 1 are filtered. This needs the decoding
+ * order to be the raster order of the rows, so frames with tiles are
+ * filtered inline.
+ *
+ * The last row is filtered while the row above is, as each CTB of it comes
+ * right after CTB (x, y - 1), and before (x + 1, y - 1) unless that one
+ * ends its row. The SAO of the row above reads samples the last row has not
+ * deblocked yet then, which must be kept for the output to be the same.
+ *
+ * A row job filters as many CTBs as it can, then parks the row until one of
+ * its dependencies advances. Whoever advances it queues the row again, so
+ * the decoding only touches the executor when a row is waiting for it.
+ */
+
+static int filter_row_ready(const HEVCContext *s, const HEVCFilterRow *r, int x_ctb)
+{
+    const HEVCSPS *const sps = s->pps->sps;
+    const int last = sps->ctb_height - 1;
+    const int need = FFMIN(x_ctb + 2, sps->ctb_width);
+    int need_above = need;
+
+    if (r->y_ctb == last)
+        need_above = x_ctb + 2 == sps->ctb_width ? sps->ctb_width : x_ctb + 1;
+
+    /* atomic_load's prototype requires a pointer to non-const atomic
+     * variable, the casts are safe. */
+    if (atomic_load((atomic_int*)&r->decoded) < need)
+        return 0;
+    if (r->y_ctb < last &&
+        atomic_load((atomic_int*)&r[1].decoded) < need)
+        return 0;
+    if (r->y_ctb && atomic_load((atomic_int*)&r[-1].filtered) < need_above)
+        return 0;
+    if (r->y_ctb + 1 == last &&
+        atomic_load((atomic_int*)&r[1].filtered) < FFMIN(x_ctb, sps->ctb_width - 2))
+        return 0;
+    return 1;
+}
+
+/* queue a parked row again, after one of its dependencies advanced */
+static void filter_row_wake(const HEVCContext *s, HEVCFilterRow *r)
+{
+    if (atomic_load(&r->parked) && atomic_exchange(&r->parked, 0))
+        av_executor_execute(s->filter_executor, &r->job.task);
+}
+
+/* at most filter_nb_lcs row jobs run at once, one per executor thread */
+static HEVCLocalContext *filter_lc_get(HEVCContext *s)
+{
+    for (int i = 0;; i = (i + 1) % s->filter_nb_lcs)
+        if (!atomic_exchange(&s->filter_lc_busy[i], 1))
+            return &s->filter_lcs[i];
+}
+
+static void filter_lc_put(HEVCContext *s, HEVCLocalContext *lc)
+{
+    atomic_store(&s->filter_lc_busy[lc - s->filter_lcs], 0);
+}
+
+static void filter_row_run(FFExecutorJob *job)
+{
+    HEVCFilterRow *r     = (HEVCFilterRow*)job;
+    HEVCContext *s       = r->s;
+    HEVCLocalContext *lc = filter_lc_get(s);
+    const HEVCLayerContext *l = &s->layers[s->cur_layer];
+    const HEVCPPS *const pps  = s->pps;
+    const HEVCSPS *const sps  = pps->sps;
+    const int ctb_size        = 1 << sps->log2_ctb_size;
+
+    lc->parent = s;
+    lc->logctx = s->avctx;
+
+    while (1) {
+        int x_ctb;
+
+        while (r->x_ctb < sps->ctb_width && filter_row_ready(s, r, r->x_ctb)) {
+            ff_hevc_hls_filter(lc, l, pps, r->x_ctb << sps->log2_ctb_size,
+                               r->y_ctb << sps->log2_ctb_size, ctb_size);
+            atomic_store(&r->filtered, ++r->x_ctb);
+            if (r->y_ctb + 1 < sps->ctb_height)
+                filter_row_wake(s, r + 1);
+            else if (r->y_ctb)
+                filter_row_wake(s, r - 1);
+        }
+        if (r->x_ctb == sps->ctb_width)
+            break;
+
+        /* the row belongs to whoever queues it again once it is parked */
+        x_ctb = r->x_ctb;
+        atomic_store(&r->parked, 1);
+        /* a dependency may have advanced before the row was parked, then
+         * take the row back unless it has been queued again meanwhile */
+        if (!filter_row_ready(s, r, x_ctb) || !atomic_exchange(&r->parked, 0)) {
+            filter_lc_put(s, lc);
+            return;
+        }
+    }
+    filter_lc_put(s, lc);
+
+    ff_mutex_lock(&s->filter_lock);
+    if (++s->nb_filter_rows_done == sps->ctb_height)
+        ff_cond_signal(&s->filter_cond);
+    ff_mutex_unlock(&s->filter_lock);
+}
+
+int ff_hevc_filter_thread_init(HEVCContext *s)
+{
+    int nb_threads, ret;
+
+    /* share the executor the decoder was given, if any */
+    s->filter_executor = s->avctx->executor;
+    if (!s->filter_executor) {
+        s->filter_executor = av_executor_alloc_shared(s->filter_threads);
+        if (!s->filter_executor)
+            return AVERROR(ENOMEM);
+    }
+
+    nb_threads = avpriv_executor_shared_threads(s->filter_executor);
+    if (nb_threads <= 0) {
+        /* not a shared executor or no threads, filter inline */
+        ff_hevc_filter_thread_free(s);
+        return 0;
+    }
+
+    s->filter_lcs     = av_calloc(nb_threads, sizeof(*s->filter_lcs));
+    s->filter_lc_busy = av_calloc(nb_threads, sizeof(*s->filter_lc_busy));
+    if (!s->filter_lcs || !s->filter_lc_busy) {
+        ff_hevc_filter_thread_free(s);
+        return AVERROR(ENOMEM);
+    }
+    s->filter_nb_lcs = nb_threads;
+
+    if ((ret = ff_mutex_init(&s->filter_lock, NULL))) {
+        ff_hevc_filter_thread_free(s);
+        return AVERROR(ret);
+    }
+    if ((ret = ff_cond_init(&s->filter_cond, NULL))) {
+        ff_mutex_destroy(&s->filter_lock);
+        ff_hevc_filter_thread_free(s);
+        return AVERROR(ret);
+    }
+    s->filter_sync_init = 1;
+
+    return 0;
+}
+
+void ff_hevc_filter_thread_free(HEVCContext *s)
+{
+    if (s->filter_executor != s->avctx->executor)
+        av_executor_free(&s->filter_executor);
+    s->filter_executor = NULL;
+
+    if (s->filter_sync_init) {
+        ff_cond_destroy(&s->filter_cond);
+        ff_mutex_destroy(&s->filter_lock);
+        s->filter_sync_init = 0;
+    }
+    av_freep(&s->filter_lcs);
+    av_freep(&s->filter_lc_busy);
+    s->filter_nb_lcs = 0;
+    av_freep(&s->filter_rows);
+    s->nb_filter_rows = 0;
+}
+
+int ff_hevc_filter_frame_start(HEVCContext *s)
+{
+    const HEVCPPS *const pps = s->pps;
+    const HEVCSPS *const sps = pps->sps;
+
+    s->filter_active = 0;
+
+    /* ff_hevc_hls_filter() checks the type of the current slice for these,
+     * which is not known anymore when the filters are deferred */
+    if (!s->filter_nb_lcs || s->avctx->hwaccel || pps->tiles_enabled_flag ||
+        s->avctx->skip_loop_filter >= AVDISCARD_NONREF)
+        return 0;
+
+    if (sps->ctb_height > s->nb_filter_rows) {
+        av_freep(&s->filter_rows);
+        s->nb_filter_rows = 0;
+        s->filter_rows = av_calloc(sps->ctb_height, sizeof(*s->filter_rows));
+        if (!s->filter_rows)
+            return AVERROR(ENOMEM);
+        s->nb_filter_rows = sps->ctb_height;
+    }
+
+    /* the rows start parked and are queued by the first decoded CTBs */
+    s->nb_filter_rows_done = 0;
+    for (int y = 0; y < sps->ctb_height; y++) {
+        HEVCFilterRow *r = &s->filter_rows[y];
+
+        memset(&r->job, 0, sizeof(r->job));
+        r->job.run = filter_row_run;
+        r->s       = s;
+        r->y_ctb   = y;
+        r->x_ctb   = 0;
+        atomic_init(&r->decoded,  0);
+        atomic_init(&r->filtered, 0);
+        atomic_init(&r->parked,   1);
+    }
+
+    s->filter_active = 1;
+
+    return 0;
+}
+
+void ff_hevc_filter_ctb_decoded(const HEVCContext *s, int x_ctb, int y_ctb)
+{
+    const int log2_ctb_size = s->pps->sps->log2_ctb_size;
+    HEVCFilterRow *r = &s->filter_rows[y_ctb >> log2_ctb_size];
+
+    atomic_store(&r->decoded, (x_ctb >> log2_ctb_size) + 1);
+    filter_row_wake(s, r);
+    if (r->y_ctb)
+        filter_row_wake(s, r - 1);
+}
+
+void ff_hevc_filter_frame_finish(HEVCContext *s)
+{
+    const HEVCSPS *sps;
+
+    if (!s->filter_active)
+        return;
+    sps = s->pps->sps;
+
+    /* CTBs missing after decoding errors are filtered as well */
+    for (int y = 0; y < sps->ctb_height; y++)
+        atomic_store(&s->filter_rows[y].decoded, sps->ctb_width);
+    for (int y = 0; y < sps->ctb_height; y++)
+        filter_row_wake(s, &s->filter_rows[y]);
+
+    ff_mutex_lock(&s->filter_lock);
+    while (s->nb_filter_rows_done < sps->ctb_height)
+        ff_cond_wait(&s->filter_cond, &s->filter_lock);
+    ff_mutex_unlock(&s->filter_lock);
+
+    s->filter_active = 0;
+}
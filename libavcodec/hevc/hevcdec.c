@@ -2576,11 +2576,14 @@ static int hls_decode_entry(HEVCContext *s, GetBitContext *gb)
 
         ctb_addr_ts++;
         ff_hevc_save_states(lc, pps, ctb_addr_ts);
-        ff_hevc_hls_filters(lc, l, pps, x_ctb, y_ctb, ctb_size);
+        if (s->filter_active)
+            ff_hevc_filter_ctb_decoded(s, x_ctb, y_ctb);
+        else
+            ff_hevc_hls_filters(lc, l, pps, x_ctb, y_ctb, ctb_size);
     }
 
     if (x_ctb + ctb_size >= sps->width &&
-        y_ctb + ctb_size >= sps->height)
+        y_ctb + ctb_size >= sps->height && !s->filter_active)
         ff_hevc_hls_filter(lc, l, pps, x_ctb, y_ctb, ctb_size);
 
     return ctb_addr_ts;
@@ -2645,7 +2648,10 @@ static int hls_decode_entry_wpp(AVCodecContext *avctx, void *hevc_lclist,
 
         ff_hevc_save_states(lc, pps, ctb_addr_ts);
         ff_thread_report_progress2(s->avctx, ctb_row, thread, 1);
-        ff_hevc_hls_filters(lc, l, pps, x_ctb, y_ctb, ctb_size);
+        if (s->filter_active)
+            ff_hevc_filter_ctb_decoded(s, x_ctb, y_ctb);
+        else
+            ff_hevc_hls_filters(lc, l, pps, x_ctb, y_ctb, ctb_size);
 
         if (!more_data && (x_ctb+ctb_size) < sps->width && ctb_row != s->sh.num_entry_point_offsets) {
             /* Casting const away here is safe, because it is an atomic operation. */
@@ -2655,7 +2661,8 @@ static int hls_decode_entry_wpp(AVCodecContext *avctx, void *hevc_lclist,
         }
 
         if ((x_ctb+ctb_size) >= sps->width && (y_ctb+ctb_size) >= sps->height ) {
-            ff_hevc_hls_filter(lc, l, pps, x_ctb, y_ctb, ctb_size);
+            if (!s->filter_active)
+                ff_hevc_hls_filter(lc, l, pps, x_ctb, y_ctb, ctb_size);
             ff_thread_report_progress2(s->avctx, ctb_row , thread, SHIFT_CTB_WPP);
             return ctb_addr_ts;
         }
@@ -3056,6 +3063,10 @@ static int hevc_frame_start(HEVCContext *s, HEVCLayerContext *l)
             goto fail;
     }
 
+    ret = ff_hevc_filter_frame_start(s);
+    if (ret < 0)
+        goto fail;
+
     ff_thread_finish_setup(s->avctx);
 
     return 0;
@@ -3401,6 +3412,8 @@ static int decode_nal_units(HEVCContext *s, const uint8_t *buf, int length)
 
 fail:
     if (s->cur_frame) {
+        ff_hevc_filter_frame_finish(s);
+
         if (ret >= 0)
             ret = hevc_frame_end(s);
 
@@ -3563,6 +3576,8 @@ static av_cold int hevc_decode_free(AVCodecContext *avctx)
 
     av_freep(&s->local_ctx);
 
+    ff_hevc_filter_thread_free(s);
+
     ff_h2645_packet_uninit(&s->pkt);
 
     ff_hevc_reset_sei(&s->sei);
@@ -3607,6 +3622,12 @@ static av_cold int hevc_init_context(AVCodecContext *avctx)
     s->dovi_ctx.logctx = avctx;
     s->eos = 0;
 
+    if (s->filter_threads) {
+        int ret = ff_hevc_filter_thread_init(s);
+        if (ret < 0)
+            return ret;
+    }
+
     ff_hevc_reset_sei(&s->sei);
 
     return 0;
@@ -3754,6 +3775,8 @@ static const AVOption options[] = {
         AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, PAR },
     { "strict-displaywin", "stricly apply default display window size", OFFSET(apply_defdispwin),
         AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, PAR },
+    { "loop_filter_threads", "Number of threads running the in-loop filters of each decoding thread, or any on the executor if one is set (0 = inline)", OFFSET(filter_threads),
+        AV_OPT_TYPE_INT, {.i64 = 0}, 0, INT_MAX, PAR },
     { NULL },
 };
 
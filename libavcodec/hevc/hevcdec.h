@@ -26,7 +26,10 @@
 #include <stdatomic.h>
 
 #include "libavutil/buffer.h"
+#include "libavutil/executor.h"
+#include "libavutil/executor_internal.h"
 #include "libavutil/mem_internal.h"
+#include "libavutil/thread.h"
 
 #include "libavcodec/avcodec.h"
 #include "libavcodec/bswapdsp.h"
@@ -476,6 +479,22 @@ typedef struct HEVCLayerContext {
     struct FFRefStructPool *rpl_tab_pool;
 } HEVCLayerContext;
 
+/**
+ * In-loop filtering of one CTB row, run as a job on
+ * HEVCContext.filter_executor.
+ */
+typedef struct HEVCFilterRow {
+    FFExecutorJob job;
+    struct HEVCContext *s;
+
+    int y_ctb;
+    int x_ctb;              ///< next CTB of the row to filter
+
+    atomic_int decoded;     ///< number of CTBs of the row decoded
+    atomic_int filtered;    ///< number of CTBs of the row filtered
+    atomic_int parked;      ///< set while the row waits for its dependencies
+} HEVCFilterRow;
+
 typedef struct HEVCContext {
     const AVClass *c;  // needed by private avoptions
     AVCodecContext *avctx;
@@ -550,6 +569,25 @@ typedef struct HEVCContext {
 
     AVBufferRef *rpu_buf;       ///< 0 or 1 Dolby Vision RPUs.
     DOVIContext dovi_ctx;       ///< Dolby Vision decoding context
+
+    int filter_threads;
+    /**
+     * When set, the deblocking and SAO of the current frame run on
+     * filter_executor, one job per CTB row, while the slices are decoded.
+     */
+    int filter_active;
+    /* AVCodecContext.executor if set, otherwise a private one */
+    struct AVExecutor *filter_executor;
+    /* one local context per executor thread for the running row jobs */
+    HEVCLocalContext *filter_lcs;
+    atomic_int *filter_lc_busy;
+    int filter_nb_lcs;
+    HEVCFilterRow *filter_rows;
+    int nb_filter_rows;
+    int nb_filter_rows_done;    ///< protected by filter_lock
+    int filter_sync_init;
+    AVMutex filter_lock;
+    AVCond  filter_cond;
 } HEVCContext;
 
 /**
@@ -666,6 +704,32 @@ void ff_hevc_hls_filter(HEVCLocalContext *lc, const HEVCLayerContext *l,
 void ff_hevc_hls_filters(HEVCLocalContext *lc, const HEVCLayerContext *l,
                          const HEVCPPS *pps,
                          int x_ctb, int y_ctb, int ctb_size);
+
+/**
+ * Set up the in-loop filters running next to the decoding, on
+ * AVCodecContext.executor or on a private executor with
+ * HEVCContext.filter_threads worker threads.
+ */
+int ff_hevc_filter_thread_init(HEVCContext *s);
+void ff_hevc_filter_thread_free(HEVCContext *s);
+
+/**
+ * Queue the in-loop filter tasks of the frame being started, if the filters
+ * of this frame can run on the executor. Sets HEVCContext.filter_active.
+ */
+int ff_hevc_filter_frame_start(HEVCContext *s);
+
+/**
+ * Signal that the CTB at (x_ctb, y_ctb) has been decoded. Replaces the
+ * calls to ff_hevc_hls_filters() when HEVCContext.filter_active is set.
+ */
+void ff_hevc_filter_ctb_decoded(const HEVCContext *s, int x_ctb, int y_ctb);
+
+/**
+ * Filter the remaining CTBs of the current frame and wait for all filter
+ * tasks to finish.
+ */
+void ff_hevc_filter_frame_finish(HEVCContext *s);
 void ff_hevc_set_qPy(HEVCLocalContext *lc,
                      const HEVCLayerContext *l, const HEVCPPS *pps,
                      int xBase, int yBase, int log2_cb_size);
@@ -71,6 +71,11 @@ typedef struct AVCodecInternal {
     struct FFRefStructPool *progress_frame_pool;
 
     void *thread_ctx;
+    /**
+     * Slice threading context. With frame threading, this is set in the
+     * per-thread contexts that decode their slices in parallel.
+     */
+    void *slice_thread_ctx;
 
     /**
      * This packet is used to hold the packet given to decoders
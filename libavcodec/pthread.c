@@ -42,14 +42,16 @@
  *
  * Threading requires more than one thread.
  * Frame threading requires entire frames to be passed to the codec,
- * and introduces extra decoding delay, so is incompatible with low_delay.
+ * and introduces extra decoding delay, so is incompatible with low_delay
+ * unless it runs in its low delay mode.
  *
  * @param avctx The context.
  */
 static void validate_thread_parameters(AVCodecContext *avctx)
 {
     int frame_threading_supported = (avctx->codec->capabilities & AV_CODEC_CAP_FRAME_THREADS)
-                                && !(avctx->flags  & AV_CODEC_FLAG_LOW_DELAY)
+                                && (!(avctx->flags & AV_CODEC_FLAG_LOW_DELAY) ||
+                                    avctx->thread_type & FF_THREAD_LOW_DELAY)
                                 && !(avctx->flags2 & AV_CODEC_FLAG2_CHUNKS);
     if (avctx->thread_count == 1) {
         avctx->active_thread_type = 0;
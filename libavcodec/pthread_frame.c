@@ -149,6 +149,19 @@ typedef struct FrameThreadContext {
 
     int next_decoding;             ///< The next context to submit a packet to.
     int next_finished;             ///< The next context to return output from.
+    int nb_pending;                ///< Number of contexts with output not yet returned.
+
+    /**
+     * Return the output of a context as soon as it is done instead of once
+     * all contexts are busy, see FF_THREAD_LOW_DELAY.
+     */
+    int low_delay;
+
+    /**
+     * The per-thread contexts decode their slices in parallel on
+     * AVCodecContext.executor, see FF_CODEC_CAP_FRAME_SLICE_THREADS.
+     */
+    int slice_threads;
 
     /* hwaccel state for thread-unsafe hwaccels is temporarily stored here in
      * order to transfer its ownership to the next decoding thread without the
@@ -557,11 +570,36 @@ static int submit_packet(PerThreadContext *p, AVCodecContext *user_avctx,
     pthread_mutex_unlock(&p->mutex);
 
     fctx->prev_thread = p;
-    fctx->next_decoding = (fctx->next_decoding + 1) % p->avctx->thread_count;
+    fctx->next_decoding = (fctx->next_decoding + 1) % user_avctx->thread_count;
+    fctx->nb_pending++;
 
     return 0;
 }
 
+/**
+ * Wait for the oldest pending context to finish and take its output.
+ */
+static void receive_from_thread(AVCodecContext *avctx, PerThreadContext *p)
+{
+    FrameThreadContext *fctx = p->parent;
+
+    fctx->next_finished = (fctx->next_finished + 1) % avctx->thread_count;
+    fctx->nb_pending--;
+
+    if (atomic_load(&p->state) != STATE_INPUT_READY) {
+        pthread_mutex_lock(&p->progress_mutex);
+        while (atomic_load_explicit(&p->state, memory_order_relaxed) != STATE_INPUT_READY)
+            pthread_cond_wait(&p->output_cond, &p->progress_mutex);
+        pthread_mutex_unlock(&p->progress_mutex);
+    }
+
+    update_context_from_thread(avctx, p->avctx, 1);
+    fctx->result = p->result;
+    p->result    = 0;
+    if (p->df.nb_f)
+        FFSWAP(DecodedFrames, fctx->df, p->df);
+}
+
 int ff_thread_receive_frame(AVCodecContext *avctx, AVFrame *frame)
 {
     FrameThreadContext *fctx = avctx->internal->thread_ctx;
@@ -573,7 +611,18 @@ int ff_thread_receive_frame(AVCodecContext *avctx, AVFrame *frame)
 
     /* submit packets to threads while there are no buffered results to return */
     while (!fctx->df.nb_f && !fctx->result) {
-        PerThreadContext *p;
+        PerThreadContext *p = &fctx->threads[fctx->next_finished];
+
+        /* in low delay mode, return the oldest frame as soon as it is done
+         * and only wait for it if no thread is free or the input has ended;
+         * otherwise keep decoding the following packets */
+        if (fctx->low_delay && fctx->nb_pending &&
+            (atomic_load(&p->state) == STATE_INPUT_READY ||
+             fctx->nb_pending == avctx->thread_count ||
+             avctx->internal->draining)) {
+            receive_from_thread(avctx, p);
+            continue;
+        }
 
         /* get a packet to be submitted to the next thread */
         av_packet_unref(fctx->next_pkt);
@@ -587,25 +636,12 @@ int ff_thread_receive_frame(AVCodecContext *avctx, AVFrame *frame)
              goto finish;
 
         /* do not return any frames until all threads have something to do */
-        if (fctx->next_decoding != fctx->next_finished &&
-            !avctx->internal->draining)
+        if (fctx->low_delay ||
+            (fctx->next_decoding != fctx->next_finished &&
+             !avctx->internal->draining))
             continue;
 
-        p                   = &fctx->threads[fctx->next_finished];
-        fctx->next_finished = (fctx->next_finished + 1) % avctx->thread_count;
-
-        if (atomic_load(&p->state) != STATE_INPUT_READY) {
-            pthread_mutex_lock(&p->progress_mutex);
-            while (atomic_load_explicit(&p->state, memory_order_relaxed) != STATE_INPUT_READY)
-                pthread_cond_wait(&p->output_cond, &p->progress_mutex);
-            pthread_mutex_unlock(&p->progress_mutex);
-        }
-
-        update_context_from_thread(avctx, p->avctx, 1);
-        fctx->result = p->result;
-        p->result    = 0;
-        if (p->df.nb_f)
-            FFSWAP(DecodedFrames, fctx->df, p->df);
+        receive_from_thread(avctx, p);
     }
 
     /* a thread may return multiple frames AND an error
@@ -769,6 +805,9 @@ void ff_frame_thread_free(AVCodecContext *avctx, int thread_count)
             if (codec->close && p->thread_init != UNINITIALIZED)
                 codec->close(ctx);
 
+            if (ctx->internal->slice_thread_ctx)
+                ff_slice_thread_free(ctx);
+
             /* When using a threadsafe hwaccel, this is where
              * each thread's context is uninit'd and freed. */
             ff_hwaccel_uninit(ctx);
@@ -882,6 +921,13 @@ static av_cold int init_thread(PerThreadContext *p, int *threads_to_free,
     if (!copy->internal->last_pkt_props)
         return AVERROR(ENOMEM);
 
+    if (fctx->slice_threads) {
+        copy->active_thread_type |= FF_THREAD_SLICE;
+        err = ff_slice_thread_init(copy);
+        if (err < 0)
+            return err;
+    }
+
     if (codec->init) {
         err = codec->init(copy);
         if (err < 0) {
@@ -953,6 +999,13 @@ int ff_frame_thread_init(AVCodecContext *avctx)
 
     fctx->async_lock = 1;
 
+    fctx->slice_threads = avctx->executor &&
+                          avctx->thread_type & FF_THREAD_SLICE &&
+                          codec->p.capabilities & AV_CODEC_CAP_SLICE_THREADS &&
+                          codec->caps_internal & FF_CODEC_CAP_FRAME_SLICE_THREADS;
+
+    fctx->low_delay = !!(avctx->thread_type & FF_THREAD_LOW_DELAY);
+
     if (codec->p.type == AVMEDIA_TYPE_VIDEO)
         avctx->delay = avctx->thread_count - 1;
 
@@ -992,6 +1045,7 @@ void ff_thread_flush(AVCodecContext *avctx)
     }
 
     fctx->next_decoding = fctx->next_finished = 0;
+    fctx->nb_pending    = 0;
     fctx->prev_thread = NULL;
 
     decoded_frames_flush(&fctx->df);
@@ -63,14 +63,14 @@ typedef struct SliceThreadContext {
 
 static void main_function(void *priv) {
     AVCodecContext *avctx = priv;
-    SliceThreadContext *c = avctx->internal->thread_ctx;
+    SliceThreadContext *c = avctx->internal->slice_thread_ctx;
     c->mainfunc(avctx);
 }
 
 static void worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
 {
     AVCodecContext *avctx = priv;
-    SliceThreadContext *c = avctx->internal->thread_ctx;
+    SliceThreadContext *c = avctx->internal->slice_thread_ctx;
     int ret;
 
     ret = c->func ? c->func(avctx, (char *)c->args + c->job_size * jobnr)
@@ -81,7 +81,7 @@ static void worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb
 
 void ff_slice_thread_free(AVCodecContext *avctx)
 {
-    SliceThreadContext *c = avctx->internal->thread_ctx;
+    SliceThreadContext *c = avctx->internal->slice_thread_ctx;
     int i;
 
     avpriv_slicethread_free(&c->thread);
@@ -94,12 +94,12 @@ void ff_slice_thread_free(AVCodecContext *avctx)
 
     av_freep(&c->entries);
     av_freep(&c->progress);
-    av_freep(&avctx->internal->thread_ctx);
+    av_freep(&avctx->internal->slice_thread_ctx);
 }
 
 static int thread_execute(AVCodecContext *avctx, action_func* func, void *arg, int *ret, int job_count, int job_size)
 {
-    SliceThreadContext *c = avctx->internal->thread_ctx;
+    SliceThreadContext *c = avctx->internal->slice_thread_ctx;
 
     if (!(avctx->active_thread_type&FF_THREAD_SLICE) || avctx->thread_count <= 1)
         return avcodec_default_execute(avctx, func, arg, ret, job_count, job_size);
@@ -118,14 +118,14 @@ static int thread_execute(AVCodecContext *avctx, action_func* func, void *arg, i
 
 static int thread_execute2(AVCodecContext *avctx, action_func2* func2, void *arg, int *ret, int job_count)
 {
-    SliceThreadContext *c = avctx->internal->thread_ctx;
+    SliceThreadContext *c = avctx->internal->slice_thread_ctx;
     c->func2 = func2;
     return thread_execute(avctx, NULL, arg, ret, job_count, 0);
 }
 
 int ff_slice_thread_execute_with_mainfunc(AVCodecContext *avctx, action_func2* func2, main_func *mainfunc, void *arg, int *ret, int job_count)
 {
-    SliceThreadContext *c = avctx->internal->thread_ctx;
+    SliceThreadContext *c = avctx->internal->slice_thread_ctx;
     c->func2 = func2;
     c->mainfunc = mainfunc;
     return thread_execute(avctx, NULL, arg, ret, job_count, 0);
@@ -155,18 +155,19 @@ int ff_slice_thread_init(AVCodecContext *avctx)
     }
 
     if (thread_count <= 1) {
-        avctx->active_thread_type = 0;
+        avctx->active_thread_type &= ~FF_THREAD_SLICE;
         return 0;
     }
 
-    avctx->internal->thread_ctx = c = av_mallocz(sizeof(*c));
+    avctx->internal->slice_thread_ctx = c = av_mallocz(sizeof(*c));
     mainfunc = ffcodec(avctx->codec)->caps_internal & FF_CODEC_CAP_SLICE_THREAD_HAS_MF ? &main_function : NULL;
-    if (!c || (thread_count = avpriv_slicethread_create(&c->thread, avctx, worker_func, mainfunc, thread_count)) <= 1) {
+    if (!c || (thread_count = avpriv_slicethread_create_executor(&c->thread, avctx->executor, avctx,
+                                                                 worker_func, mainfunc, thread_count)) <= 1) {
         if (c)
             avpriv_slicethread_free(&c->thread);
-        av_freep(&avctx->internal->thread_ctx);
+        av_freep(&avctx->internal->slice_thread_ctx);
         avctx->thread_count = 1;
-        avctx->active_thread_type = 0;
+        avctx->active_thread_type &= ~FF_THREAD_SLICE;
         return 0;
     }
     avctx->thread_count = thread_count;
@@ -178,7 +179,7 @@ int ff_slice_thread_init(AVCodecContext *avctx)
 
 int av_cold ff_slice_thread_init_progress(AVCodecContext *avctx)
 {
-    SliceThreadContext *const p = avctx->internal->thread_ctx;
+    SliceThreadContext *const p = avctx->internal->slice_thread_ctx;
     int err, i = 0, thread_count = avctx->thread_count;
 
     p->progress = av_calloc(thread_count, sizeof(*p->progress));
@@ -209,7 +210,7 @@ fail:
 
 void ff_thread_report_progress2(AVCodecContext *avctx, int field, int thread, int n)
 {
-    SliceThreadContext *p = avctx->internal->thread_ctx;
+    SliceThreadContext *p = avctx->internal->slice_thread_ctx;
     Progress *const progress = &p->progress[thread];
     int *entries = p->entries;
 
@@ -221,7 +222,7 @@ void ff_thread_report_progress2(AVCodecContext *avctx, int field, int thread, in
 
 void ff_thread_await_progress2(AVCodecContext *avctx, int field, int thread, int shift)
 {
-    SliceThreadContext *p  = avctx->internal->thread_ctx;
+    SliceThreadContext *p  = avctx->internal->slice_thread_ctx;
     Progress *progress;
     int *entries      = p->entries;
 
@@ -240,7 +241,7 @@ void ff_thread_await_progress2(AVCodecContext *avctx, int field, int thread, int
 int ff_slice_thread_allocz_entries(AVCodecContext *avctx, int count)
 {
     if (avctx->active_thread_type & FF_THREAD_SLICE)  {
-        SliceThreadContext *p = avctx->internal->thread_ctx;
+        SliceThreadContext *p = avctx->internal->slice_thread_ctx;
 
         if (p->entries_count == count) {
             memset(p->entries, 0, p->entries_count * sizeof(*p->entries));
@@ -178,6 +178,39 @@ cglobal hevc_add_residual_32_8, 3, 5, 7
     RET
 %endif ;HAVE_AVX2_EXTERNAL
 
+%if HAVE_AVX512ICL_EXTERNAL
+INIT_ZMM avx512icl
+; one row per register: widen the pixels, add with signed saturation, clamp
+; negative sums to zero and let vpmovuswb saturate the top end
+; void ff_hevc_add_residual_32_8_avx512icl(uint8_t *dst, const int16_t *res, ptrdiff_t stride)
+cglobal hevc_add_residual_32_8, 3, 5, 5
+    pxor                 m0, m0
+    lea                  r3, [r2*3]
+    mov                 r4d, 8
+.loop:
+    pmovzxbw             m1, [r0]
+    pmovzxbw             m2, [r0+r2]
+    pmovzxbw             m3, [r0+r2*2]
+    pmovzxbw             m4, [r0+r3]
+    paddsw               m1, [r1]
+    paddsw               m2, [r1+64]
+    paddsw               m3, [r1+128]
+    paddsw               m4, [r1+192]
+    pmaxsw               m1, m0
+    pmaxsw               m2, m0
+    pmaxsw               m3, m0
+    pmaxsw               m4, m0
+    vpmovuswb          [r0], m1
+    vpmovuswb       [r0+r2], m2
+    vpmovuswb     [r0+r2*2], m3
+    vpmovuswb       [r0+r3], m4
+    add                  r1, 256
+    lea                  r0, [r0+r2*4]
+    dec                 r4d
+    jg .loop
+    RET
+%endif ;HAVE_AVX512ICL_EXTERNAL
+
 %macro ADD_RES_SSE_8_10 4
     mova              m0, [%4]
     mova              m1, [%4+16]
@@ -367,3 +400,36 @@ cglobal hevc_add_residual_32_10, 3, 5, 6
     jg .loop
     RET
 %endif ;HAVE_AVX2_EXTERNAL
+
+%if HAVE_AVX512ICL_EXTERNAL
+INIT_ZMM avx512icl
+; the residual buffer is only guaranteed 32-byte alignment, hence movu
+cglobal hevc_add_residual_32_10, 3, 5, 6
+    pxor               m4, m4
+    vpbroadcastw       m5, [max_pixels_10]
+    lea                r3, [r2*3]
+
+    mov               r4d, 8
+.loop:
+    movu               m0, [r1]
+    movu               m1, [r1+64]
+    movu               m2, [r1+128]
+    movu               m3, [r1+192]
+    paddw              m0, [r0]
+    paddw              m1, [r0+r2]
+    paddw              m2, [r0+r2*2]
+    paddw              m3, [r0+r3]
+    CLIPW              m0, m4, m5
+    CLIPW              m1, m4, m5
+    CLIPW              m2, m4, m5
+    CLIPW              m3, m4, m5
+    movu             [r0], m0
+    movu          [r0+r2], m1
+    movu        [r0+r2*2], m2
+    movu          [r0+r3], m3
+    lea                r0, [r0+r2*4]
+    add                r1, 256
+    dec               r4d
+    jg .loop
+    RET
+%endif ;HAVE_AVX512ICL_EXTERNAL
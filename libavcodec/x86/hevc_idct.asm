@@ -249,16 +249,22 @@ cglobal hevc_idct_%1x%1_dc_%3, 1, 2, 1, coeff, tmp
     SPLATW              m0, xm0
     DEFINE_ARGS coeff, cnt
     mov               cntd, %2
+; coeffs are only 32-byte aligned
+%if mmsize == 64
+    %define %%mov movu
+%else
+    %define %%mov mova
+%endif
 .loop:
-    mova [coeffq+mmsize*0], m0
-    mova [coeffq+mmsize*1], m0
-    mova [coeffq+mmsize*2], m0
-    mova [coeffq+mmsize*3], m0
+    %%mov [coeffq+mmsize*0], m0
+    %%mov [coeffq+mmsize*1], m0
+    %%mov [coeffq+mmsize*2], m0
+    %%mov [coeffq+mmsize*3], m0
     add  coeffq, mmsize*8
-    mova [coeffq+mmsize*-4], m0
-    mova [coeffq+mmsize*-3], m0
-    mova [coeffq+mmsize*-2], m0
-    mova [coeffq+mmsize*-1], m0
+    %%mov [coeffq+mmsize*-4], m0
+    %%mov [coeffq+mmsize*-3], m0
+    %%mov [coeffq+mmsize*-2], m0
+    %%mov [coeffq+mmsize*-1], m0
     dec  cntd
     jg  .loop
     RET
@@ -822,6 +828,12 @@ IDCT_DC    32, 16,  %1
     IDCT_DC    16,  2,  %1
     IDCT_DC    32,  8,  %1
 %endif ;HAVE_AVX2_EXTERNAL
+
+%if HAVE_AVX512ICL_EXTERNAL
+    INIT_ZMM avx512icl
+    IDCT_DC    16,  1,  %1
+    IDCT_DC    32,  4,  %1
+%endif ;HAVE_AVX512ICL_EXTERNAL
 %endmacro
 
 %macro INIT_IDCT 2
@@ -23,6 +23,12 @@
 
 %include "libavutil/x86/x86util.asm"
 
+; VVC assembles these functions again with its own prefix and block size,
+; see libavcodec/x86/vvc/vvc_sao*.asm
+%ifndef SAO_PREFIX
+%define SAO_PREFIX hevc
+%endif
+
 SECTION_RODATA 32
 
 pw_m2:     times 16 dw -2
@@ -95,7 +101,7 @@ DEFINE_ARGS dst, src, dststride, srcstride, offset, height
 ;void ff_hevc_sao_band_filter_<width>_<depth>_<opt>(uint8_t *_dst, const uint8_t *_src, ptrdiff_t _stride_dst, ptrdiff_t _stride_src,
 ;                                                   int16_t *sao_offset_val, int sao_left_class, int width, int height);
 %macro HEVC_SAO_BAND_FILTER 3
-cglobal hevc_sao_band_filter_%2_%1, 6, 6, 15, 7*mmsize*ARCH_X86_32, dst, src, dststride, srcstride, offset, left
+cglobal SAO_PREFIX %+ _sao_band_filter_%2_%1, 6, 6, 15, 7*mmsize*ARCH_X86_32, dst, src, dststride, srcstride, offset, left
     HEVC_SAO_BAND_FILTER_INIT %1
 
 align 16
@@ -189,7 +195,9 @@ HEVC_SAO_BAND_FILTER 12, 64, 4
 ;SAO Edge Filter
 ;******************************************************************************
 
+%ifndef MAX_PB_SIZE
 %define MAX_PB_SIZE  64
+%endif
 %define PADDING_SIZE 64 ; AV_INPUT_BUFFER_PADDING_SIZE
 %define EDGE_SRCSTRIDE 2 * MAX_PB_SIZE + PADDING_SIZE
 
@@ -225,7 +233,7 @@ HEVC_SAO_BAND_FILTER 12, 64, 4
 ;                                                   int eo, int width, int height);
 %macro HEVC_SAO_EDGE_FILTER 3
 %if ARCH_X86_64
-cglobal hevc_sao_edge_filter_%2_%1, 4, 9, 16, dst, src, dststride, offset, eo, a_stride, b_stride, height, tmp
+cglobal SAO_PREFIX %+ _sao_edge_filter_%2_%1, 4, 9, 16, dst, src, dststride, offset, eo, a_stride, b_stride, height, tmp
 %define tmp2q heightq
     HEVC_SAO_EDGE_FILTER_INIT
     mov          heightd, r6m
@@ -233,7 +241,7 @@ cglobal hevc_sao_edge_filter_%2_%1, 4, 9, 16, dst, src, dststride, offset, eo, a
     add        b_strideq, b_strideq
 
 %else ; ARCH_X86_32
-cglobal hevc_sao_edge_filter_%2_%1, 1, 6, 8, 5*mmsize, dst, src, dststride, a_stride, b_stride, height
+cglobal SAO_PREFIX %+ _sao_edge_filter_%2_%1, 1, 6, 8, 5*mmsize, dst, src, dststride, a_stride, b_stride, height
 %define eoq   srcq
 %define tmpq  heightq
 %define tmp2q dststrideq
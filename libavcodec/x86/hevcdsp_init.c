@@ -71,6 +71,8 @@ IDCT_DC_FUNCS(16x16, sse2);
 IDCT_DC_FUNCS(32x32, sse2);
 IDCT_DC_FUNCS(16x16, avx2);
 IDCT_DC_FUNCS(32x32, avx2);
+IDCT_DC_FUNCS(16x16, avx512icl);
+IDCT_DC_FUNCS(32x32, avx512icl);
 
 #define IDCT_FUNCS(opt)                                             \
 void ff_hevc_idct_4x4_8_    ## opt(int16_t *coeffs, int col_limit); \
@@ -981,6 +983,13 @@ void ff_hevc_dsp_init_x86(HEVCDSPContext *c, const int bit_depth)
             c->put_hevc_qpel[7][0][1] = ff_hevc_put_hevc_qpel_h32_8_avx512icl;
             c->put_hevc_qpel[9][0][1] = ff_hevc_put_hevc_qpel_h64_8_avx512icl;
             c->put_hevc_qpel[3][1][1] = ff_hevc_put_hevc_qpel_hv8_8_avx512icl;
+
+            /* the full inverse transforms, deblocking and SAO have no
+             * AVX-512 versions at any bit depth, the AVX2 ones stay in use */
+            c->idct_dc[2] = ff_hevc_idct_16x16_dc_8_avx512icl;
+            c->idct_dc[3] = ff_hevc_idct_32x32_dc_8_avx512icl;
+
+            c->add_residual[3] = ff_hevc_add_residual_32_8_avx512icl;
         }
     } else if (bit_depth == 10) {
         if (EXTERNAL_MMXEXT(cpu_flags)) {
@@ -1198,6 +1207,12 @@ void ff_hevc_dsp_init_x86(HEVCDSPContext *c, const int bit_depth)
             c->add_residual[2] = ff_hevc_add_residual_16_10_avx2;
             c->add_residual[3] = ff_hevc_add_residual_32_10_avx2;
         }
+        if (EXTERNAL_AVX512ICL(cpu_flags) && ARCH_X86_64) {
+            c->idct_dc[2] = ff_hevc_idct_16x16_dc_10_avx512icl;
+            c->idct_dc[3] = ff_hevc_idct_32x32_dc_10_avx512icl;
+
+            c->add_residual[3] = ff_hevc_add_residual_32_10_avx512icl;
+        }
     } else if (bit_depth == 12) {
         if (EXTERNAL_MMXEXT(cpu_flags)) {
             c->idct_dc[0] = ff_hevc_idct_4x4_dc_12_mmxext;
@@ -1250,5 +1265,9 @@ void ff_hevc_dsp_init_x86(HEVCDSPContext *c, const int bit_depth)
             SAO_BAND_INIT(12, avx2);
             SAO_EDGE_INIT(12, avx2);
         }
+        if (EXTERNAL_AVX512ICL(cpu_flags) && ARCH_X86_64) {
+            c->idct_dc[2] = ff_hevc_idct_16x16_dc_12_avx512icl;
+            c->idct_dc[3] = ff_hevc_idct_32x32_dc_12_avx512icl;
+        }
     }
 }
@@ -143,7 +143,70 @@ ALF_PROTOTYPES(8,  8,  avx2)
 ALF_PROTOTYPES(16, 10, avx2)
 ALF_PROTOTYPES(16, 12, avx2)
 
+// The SAO filters are the HEVC ones, see vvc_sao.asm. Intra prediction, the
+// inverse transforms, LMCS and the deblocking filter have no x86 versions.
+#define SAO_BAND_FILTER_PROTOTYPE(w, bd, opt)                                                           \
+void ff_vvc_sao_band_filter_##w##_##bd##_##opt(uint8_t *dst, const uint8_t *src, ptrdiff_t dst_stride, \
+    ptrdiff_t src_stride, const int16_t *sao_offset_val, int sao_left_class, int width, int height);
+#define SAO_EDGE_FILTER_PROTOTYPE(w, bd, opt)                                                           \
+void ff_vvc_sao_edge_filter_##w##_##bd##_##opt(uint8_t *dst, const uint8_t *src, ptrdiff_t dst_stride, \
+    const int16_t *sao_offset_val, int eo, int width, int height);
+
+#define SAO_PROTOTYPES(bd, opt)            \
+    SAO_BAND_FILTER_PROTOTYPE( 8, bd, opt) \
+    SAO_BAND_FILTER_PROTOTYPE(16, bd, opt) \
+    SAO_BAND_FILTER_PROTOTYPE(32, bd, opt) \
+    SAO_BAND_FILTER_PROTOTYPE(48, bd, opt) \
+    SAO_BAND_FILTER_PROTOTYPE(64, bd, opt) \
+    SAO_EDGE_FILTER_PROTOTYPE( 8, bd, opt) \
+    SAO_EDGE_FILTER_PROTOTYPE(16, bd, opt) \
+    SAO_EDGE_FILTER_PROTOTYPE(32, bd, opt) \
+    SAO_EDGE_FILTER_PROTOTYPE(48, bd, opt) \
+    SAO_EDGE_FILTER_PROTOTYPE(64, bd, opt)
+
+SAO_EDGE_FILTER_PROTOTYPE( 8, 8, ssse3)
+SAO_EDGE_FILTER_PROTOTYPE(16, 8, ssse3)
+SAO_PROTOTYPES( 8, avx2)
+SAO_PROTOTYPES(10, avx2)
+SAO_PROTOTYPES(12, avx2)
+
 #if ARCH_X86_64
+// VVC blocks are up to 128 pixels wide, filter them as a 64 pixel wide
+// block and the rest
+#define SAO_BAND_FILTER_WIDE(w, bd, opt, rest)                                                          \
+static void vvc_sao_band_filter_##w##_##bd##_##opt(uint8_t *dst, const uint8_t *src,                    \
+    ptrdiff_t dst_stride, ptrdiff_t src_stride, const int16_t *sao_offset_val, int sao_left_class,      \
+    int width, int height)                                                                              \
+{                                                                                                       \
+    const int ps = bd > 8;                                                                              \
+    ff_vvc_sao_band_filter_64_##bd##_##opt(dst, src, dst_stride, src_stride,                            \
+        sao_offset_val, sao_left_class, 64, height);                                                    \
+    rest(dst + (64 << ps), src + (64 << ps), dst_stride, src_stride,                                    \
+        sao_offset_val, sao_left_class, width - 64, height);                                            \
+}
+#define SAO_EDGE_FILTER_WIDE(w, bd, opt, rest)                                                          \
+static void vvc_sao_edge_filter_##w##_##bd##_##opt(uint8_t *dst, const uint8_t *src,                    \
+    ptrdiff_t dst_stride, const int16_t *sao_offset_val, int eo, int width, int height)                 \
+{                                                                                                       \
+    const int ps = bd > 8;                                                                              \
+    ff_vvc_sao_edge_filter_64_##bd##_##opt(dst, src, dst_stride, sao_offset_val, eo, 64, height);       \
+    rest(dst + (64 << ps), src + (64 << ps), dst_stride, sao_offset_val, eo, width - 64, height);       \
+}
+
+#define SAO_FUNCS(bd, opt, edge16_opt)                                                   \
+    SAO_BAND_FILTER_WIDE( 80, bd, opt, ff_vvc_sao_band_filter_16_##bd##_##opt)           \
+    SAO_BAND_FILTER_WIDE( 96, bd, opt, ff_vvc_sao_band_filter_32_##bd##_##opt)           \
+    SAO_BAND_FILTER_WIDE(112, bd, opt, ff_vvc_sao_band_filter_48_##bd##_##opt)           \
+    SAO_BAND_FILTER_WIDE(128, bd, opt, ff_vvc_sao_band_filter_64_##bd##_##opt)           \
+    SAO_EDGE_FILTER_WIDE( 80, bd, opt, ff_vvc_sao_edge_filter_16_##bd##_##edge16_opt)    \
+    SAO_EDGE_FILTER_WIDE( 96, bd, opt, ff_vvc_sao_edge_filter_32_##bd##_##opt)           \
+    SAO_EDGE_FILTER_WIDE(112, bd, opt, ff_vvc_sao_edge_filter_48_##bd##_##opt)           \
+    SAO_EDGE_FILTER_WIDE(128, bd, opt, ff_vvc_sao_edge_filter_64_##bd##_##opt)
+
+SAO_FUNCS( 8, avx2, ssse3)
+SAO_FUNCS(10, avx2, avx2)
+SAO_FUNCS(12, avx2, avx2)
+
 #if HAVE_SSE4_EXTERNAL
 #define FW_PUT(name, depth, opt) \
 void ff_vvc_put_ ## name ## _ ## depth ## _##opt(int16_t *dst, const uint8_t *src, ptrdiff_t srcstride,        \
@@ -352,6 +415,27 @@ ALF_FUNCS(16, 12, avx2)
     c->alf.classify       = ff_vvc_alf_classify_##bd##_avx2;         \
 } while (0)
 
+#define SAO_INIT(bd, opt, edge16_opt) do {                                       \
+    c->sao.band_filter[0] = ff_vvc_sao_band_filter_8_##bd##_##opt;               \
+    c->sao.band_filter[1] = ff_vvc_sao_band_filter_16_##bd##_##opt;              \
+    c->sao.band_filter[2] = ff_vvc_sao_band_filter_32_##bd##_##opt;              \
+    c->sao.band_filter[3] = ff_vvc_sao_band_filter_48_##bd##_##opt;              \
+    c->sao.band_filter[4] = ff_vvc_sao_band_filter_64_##bd##_##opt;              \
+    c->sao.band_filter[5] = vvc_sao_band_filter_80_##bd##_##opt;                 \
+    c->sao.band_filter[6] = vvc_sao_band_filter_96_##bd##_##opt;                 \
+    c->sao.band_filter[7] = vvc_sao_band_filter_112_##bd##_##opt;                \
+    c->sao.band_filter[8] = vvc_sao_band_filter_128_##bd##_##opt;                \
+    c->sao.edge_filter[0] = ff_vvc_sao_edge_filter_8_##bd##_##edge16_opt;        \
+    c->sao.edge_filter[1] = ff_vvc_sao_edge_filter_16_##bd##_##edge16_opt;       \
+    c->sao.edge_filter[2] = ff_vvc_sao_edge_filter_32_##bd##_##opt;              \
+    c->sao.edge_filter[3] = ff_vvc_sao_edge_filter_48_##bd##_##opt;              \
+    c->sao.edge_filter[4] = ff_vvc_sao_edge_filter_64_##bd##_##opt;              \
+    c->sao.edge_filter[5] = vvc_sao_edge_filter_80_##bd##_##opt;                 \
+    c->sao.edge_filter[6] = vvc_sao_edge_filter_96_##bd##_##opt;                 \
+    c->sao.edge_filter[7] = vvc_sao_edge_filter_112_##bd##_##opt;                \
+    c->sao.edge_filter[8] = vvc_sao_edge_filter_128_##bd##_##opt;                \
+} while (0)
+
 int ff_vvc_sad_avx2(const int16_t *src0, const int16_t *src1, int dx, int dy, int block_w, int block_h);
 #define SAD_INIT() c->inter.sad = ff_vvc_sad_avx2
 #endif
@@ -373,6 +457,7 @@ void ff_vvc_dsp_init_x86(VVCDSPContext *const c, const int bd)
             OF_INIT(8);
             DMVR_INIT(8);
             SAD_INIT();
+            SAO_INIT(8, avx2, ssse3);
         }
         break;
     case 10:
@@ -387,6 +472,7 @@ void ff_vvc_dsp_init_x86(VVCDSPContext *const c, const int bd)
             OF_INIT(10);
             DMVR_INIT(10);
             SAD_INIT();
+            SAO_INIT(10, avx2, avx2);
         }
         break;
     case 12:
@@ -401,6 +487,7 @@ void ff_vvc_dsp_init_x86(VVCDSPContext *const c, const int bd)
             OF_INIT(12);
             DMVR_INIT(12);
             SAD_INIT();
+            SAO_INIT(12, avx2, avx2);
         }
         break;
     default:
@@ -43,12 +43,10 @@ AVFrame *ff_null_get_audio_buffer(AVFilterLink *link, int nb_samples)
     return ff_get_audio_buffer(link->dst->outputs[0], nb_samples);
 }
 
-AVFrame *ff_default_get_audio_buffer(AVFilterLink *link, int nb_samples)
+static AVFrame *pool_get_audio_frame(FilterLinkInternal *li, int channels,
+                                     int nb_samples, int align)
 {
-    AVFrame *frame = NULL;
-    FilterLinkInternal *const li = ff_link_internal(link);
-    int channels = link->ch_layout.nb_channels;
-    int align = av_cpu_max_align();
+    AVFilterLink *const link = &li->l.pub;
 
     if (!li->frame_pool) {
         li->frame_pool = ff_frame_pool_audio_init(av_buffer_allocz, channels,
@@ -78,7 +76,23 @@ AVFrame *ff_default_get_audio_buffer(AVFilterLink *link, int nb_samples)
         }
     }
 
-    frame = ff_frame_pool_get(li->frame_pool);
+    return ff_frame_pool_get(li->frame_pool);
+}
+
+AVFrame *ff_default_get_audio_buffer(AVFilterLink *link, int nb_samples)
+{
+    AVFrame *frame = NULL;
+    FilterLinkInternal *const li = ff_link_internal(link);
+    int channels = link->ch_layout.nb_channels;
+    int align = av_cpu_max_align();
+
+    /* the pool may be reached from filters running concurrently with the
+     * owner of the link, through pass-through get_buffer callbacks */
+    if (li->l.graph)
+        ff_graph_lock(li->l.graph);
+    frame = pool_get_audio_frame(li, channels, nb_samples, align);
+    if (li->l.graph)
+        ff_graph_unlock(li->l.graph);
     if (!frame)
         return NULL;
 
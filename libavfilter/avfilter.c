@@ -230,13 +230,28 @@ static void update_link_current_pts(FilterLinkInternal *li, int64_t pts)
     li->l.current_pts = pts;
     li->l.current_pts_us = av_rescale_q(pts, link->time_base, AV_TIME_BASE_Q);
     /* TODO use duration */
-    if (li->l.graph && li->age_index >= 0)
+    if (li->l.graph && li->age_index >= 0) {
+        ff_graph_lock(li->l.graph);
         ff_avfilter_graph_update_heap(li->l.graph, li);
+        ff_graph_unlock(li->l.graph);
+    }
 }
 
 void ff_filter_set_ready(AVFilterContext *filter, unsigned priority)
 {
-    filter->ready = FFMAX(filter->ready, priority);
+    AVFilterGraph *graph = filter->graph;
+
+    if (!graph) {
+        filter->ready = FFMAX(filter->ready, priority);
+        return;
+    }
+
+    ff_graph_lock(graph);
+    if (priority > filter->ready) {
+        filter->ready = priority;
+        ff_filter_graph_update_ready(graph, filter);
+    }
+    ff_graph_unlock(graph);
 }
 
 /**
@@ -657,8 +672,9 @@ static const AVClass *filter_child_class_iterate(void **iter)
 #define TFLAGS AV_OPT_FLAG_FILTERING_PARAM|AV_OPT_FLAG_RUNTIME_PARAM
 static const AVOption avfilter_options[] = {
     { "thread_type", "Allowed thread types", OFFSET(thread_type), AV_OPT_TYPE_FLAGS,
-        { .i64 = AVFILTER_THREAD_SLICE }, 0, INT_MAX, FLAGS, .unit = "thread_type" },
+        { .i64 = AVFILTER_THREAD_SLICE | AVFILTER_THREAD_GRAPH }, 0, INT_MAX, FLAGS, .unit = "thread_type" },
         { "slice", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_SLICE }, .flags = FLAGS, .unit = "thread_type" },
+        { "graph", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_GRAPH }, .flags = FLAGS, .unit = "thread_type" },
     { "enable", "set enable expression", OFFSET(enable_str), AV_OPT_TYPE_STRING, {.str=NULL}, .flags = TFLAGS },
     { "threads", "Allowed number of threads", OFFSET(nb_threads), AV_OPT_TYPE_INT,
         { .i64 = 0 }, 0, INT_MAX, FLAGS, .unit = "threads" },
@@ -725,7 +741,8 @@ AVFilterContext *ff_filter_alloc(const AVFilter *filter, const char *inst_name)
         av_opt_set_defaults(ret->priv);
     }
 
-    ctx->execute = default_execute;
+    ctx->execute     = default_execute;
+    ctx->ready_index = -1;
 
     ret->nb_inputs  = filter->nb_inputs;
     if (ret->nb_inputs ) {
@@ -907,6 +924,7 @@ int ff_filter_process_command(AVFilterContext *ctx, const char *cmd,
 int avfilter_init_dict(AVFilterContext *ctx, AVDictionary **options)
 {
     FFFilterContext *ctxi = fffilterctx(ctx);
+    int thread_type;
     int ret = 0;
 
     if (ctxi->initialized) {
@@ -920,14 +938,18 @@ int avfilter_init_dict(AVFilterContext *ctx, AVDictionary **options)
         return ret;
     }
 
+    thread_type = ctx->thread_type & ctx->graph->thread_type;
     if (ctx->filter->flags & AVFILTER_FLAG_SLICE_THREADS &&
-        ctx->thread_type & ctx->graph->thread_type & AVFILTER_THREAD_SLICE &&
+        thread_type & AVFILTER_THREAD_SLICE &&
         fffiltergraph(ctx->graph)->thread_execute) {
         ctx->thread_type       = AVFILTER_THREAD_SLICE;
         ctxi->execute    = fffiltergraph(ctx->graph)->thread_execute;
     } else {
         ctx->thread_type = 0;
     }
+    if (thread_type & AVFILTER_THREAD_GRAPH &&
+        !(ctx->filter->flags_internal & FF_FILTER_FLAG_GRAPH_EXCLUSIVE))
+        ctx->thread_type |= AVFILTER_THREAD_GRAPH;
 
     if (ctx->filter->init)
         ret = ctx->filter->init(ctx);
@@ -1318,7 +1340,8 @@ static int ff_filter_activate_default(AVFilterContext *filter)
      link_set_out_status().
 
    Filters are activated according to the ready field, set using the
-   ff_filter_set_ready(). Eventually, a priority queue will be used.
+   ff_filter_set_ready(). The graph keeps the ready filters in a priority
+   queue, so finding the most urgent one does not depend on the graph size.
    ff_filter_set_ready() is called whenever anything could cause progress to
    be possible. Marking a filter ready when it is not is not a problem,
    except for the small overhead it causes.
@@ -1387,7 +1410,10 @@ int ff_filter_activate(AVFilterContext *filter)
     /* Generic timeline support is not yet implemented but should be easy */
     av_assert1(!(filter->filter->flags & AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC &&
                  filter->filter->activate));
+    ff_graph_lock(filter->graph);
     filter->ready = 0;
+    ff_filter_graph_update_ready(filter->graph, filter);
+    ff_graph_unlock(filter->graph);
     ret = filter->filter->activate ? filter->filter->activate(filter) :
           ff_filter_activate_default(filter);
     if (ret == FFERROR_NOT_READY)
@@ -1532,6 +1558,13 @@ int ff_inlink_make_frame_writable(AVFilterLink *link, AVFrame **rframe)
 
     av_frame_free(&frame);
     *rframe = out;
+
+    if (link->dst->graph) {
+        ff_graph_lock(link->dst->graph);
+        fffiltergraph(link->dst->graph)->nb_frame_copies++;
+        ff_graph_unlock(link->dst->graph);
+    }
+
     return 0;
 }
 
@@ -453,6 +453,13 @@ unsigned avfilter_filter_pad_count(const AVFilter *filter, int is_output);
  */
 #define AVFILTER_THREAD_SLICE (1 << 0)
 
+/**
+ * Activate independent filters of the graph concurrently, e.g. the branches
+ * following a split filter. Two filters are never activated at the same
+ * time if they are directly connected by a link.
+ */
+#define AVFILTER_THREAD_GRAPH (1 << 1)
+
 /** An instance of a filter */
 struct AVFilterContext {
     const AVClass *av_class;        ///< needed for av_log() and filters common options
@@ -769,7 +776,10 @@ typedef struct AVFilterGraph {
      * of AVFILTER_THREAD_* flags.
      *
      * May be set by the caller at any point, the setting will apply to all
-     * filters initialized after that. The default is allowing everything.
+     * filters initialized after that. The default is allowing slice threading.
+     *
+     * AVFILTER_THREAD_GRAPH must be set before adding any filters to the
+     * graph, since it requires a dedicated thread pool.
      *
      * When a filter in this graph is initialized, this field is combined using
      * bit AND with AVFilterContext.thread_type to get the final mask used for
@@ -807,6 +817,17 @@ typedef struct AVFilterGraph {
     avfilter_execute_func *execute;
 
     char *aresample_swr_opts; ///< swr options to use for the auto-inserted aresample filters, Access ONLY through AVOptions
+
+    /**
+     * Executor allocated with av_executor_alloc_shared(), whose threads are
+     * used for multithreading in this graph instead of threads private to
+     * it. nb_threads then limits the number of threads working for this graph
+     * at the same time. Has no effect when a custom execute callback is set.
+     *
+     * May be set by the caller before adding any filters to the filtergraph.
+     * The executor is not owned by the graph and must outlive it.
+     */
+    struct AVExecutor *executor;
 } AVFilterGraph;
 
 /**
@@ -27,6 +27,8 @@
 
 #include <stdint.h>
 
+#include "libavutil/thread.h"
+
 #include "avfilter.h"
 #include "filters.h"
 #include "framequeue.h"
@@ -103,6 +105,15 @@ typedef struct FFFilterContext {
     // 1 when avfilter_init_*() was successfully called on this filter
     // 0 otherwise
     int initialized;
+
+    // index of this filter in the graph's filters array
+    unsigned graph_index;
+
+    // index of this filter in the graph's ready heap, -1 if not queued
+    int ready_index;
+
+    // set while this filter is being activated concurrently with others
+    int activating;
 } FFFilterContext;
 
 static inline FFFilterContext *fffilterctx(AVFilterContext *ctx)
@@ -132,6 +143,28 @@ typedef struct FFFilterGraph {
     void *thread;
     avfilter_execute_func *thread_execute;
     FFFrameQueueGlobal frame_queues;
+
+    /**
+     * Max-heap of the filters with a non-zero ready status, ordered by
+     * decreasing ready value, then by increasing position in the graph.
+     * Allocated with room for all the filters of the graph.
+     */
+    FFFilterContext **ready_heap;
+    int nb_ready;
+
+    /**
+     * Set while several filters are being activated concurrently. The ready
+     * heap, the age heap and the link frame pools must then only be accessed
+     * with lock held, see ff_graph_lock().
+     */
+    int concurrent;
+    AVMutex lock;
+
+    /**
+     * Number of frames whose data was copied by ff_inlink_make_frame_writable(),
+     * exported as the frame_copies option.
+     */
+    int64_t nb_frame_copies;
 } FFFilterGraph;
 
 static inline FFFilterGraph *fffiltergraph(AVFilterGraph *graph)
@@ -139,12 +172,32 @@ static inline FFFilterGraph *fffiltergraph(AVFilterGraph *graph)
     return (FFFilterGraph*)graph;
 }
 
+static inline void ff_graph_lock(AVFilterGraph *graph)
+{
+    FFFilterGraph *graphi = fffiltergraph(graph);
+    if (graphi->concurrent)
+        ff_mutex_lock(&graphi->lock);
+}
+
+static inline void ff_graph_unlock(AVFilterGraph *graph)
+{
+    FFFilterGraph *graphi = fffiltergraph(graph);
+    if (graphi->concurrent)
+        ff_mutex_unlock(&graphi->lock);
+}
+
 /**
  * Update the position of a link in the age heap.
  */
 void ff_avfilter_graph_update_heap(AVFilterGraph *graph,
                                    struct FilterLinkInternal *li);
 
+/**
+ * Update the position of a filter in the ready heap after its ready
+ * status changed, inserting or removing it as needed.
+ */
+void ff_filter_graph_update_ready(AVFilterGraph *graph, AVFilterContext *filter);
+
 /**
  * Allocate a new filter context and return it.
  *
@@ -179,6 +232,14 @@ int ff_graph_thread_init(FFFilterGraph *graph);
 
 void ff_graph_thread_free(FFFilterGraph *graph);
 
+/**
+ * Activate the most urgent ready filter together with as many other ready
+ * filters not directly connected to it or to each other as there are threads.
+ *
+ * @return 0 or the first error returned by one of the activations
+ */
+int ff_graph_run_concurrent(FFFilterGraph *graph);
+
 /**
  * Negotiate the media format, dimensions, etc of all inputs to a filter.
  *
@@ -49,6 +49,7 @@ static const AVOption filtergraph_options[] = {
     { "thread_type", "Allowed thread types", OFFSET(thread_type), AV_OPT_TYPE_FLAGS,
         { .i64 = AVFILTER_THREAD_SLICE }, 0, INT_MAX, F|V|A, .unit = "thread_type" },
         { "slice", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_SLICE }, .flags = F|V|A, .unit = "thread_type" },
+        { "graph", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_GRAPH }, .flags = F|V|A, .unit = "thread_type" },
     { "threads",     "Maximum number of threads", OFFSET(nb_threads), AV_OPT_TYPE_INT,
         { .i64 = 0 }, 0, INT_MAX, F|V|A, .unit = "threads"},
         {"auto", "autodetect a suitable number of threads to use", 0, AV_OPT_TYPE_CONST, {.i64 = 0 }, .flags = F|V|A, .unit = "threads"},
@@ -56,6 +57,9 @@ static const AVOption filtergraph_options[] = {
         AV_OPT_TYPE_STRING, {.str = NULL}, 0, 0, F|V },
     {"aresample_swr_opts"   , "default aresample filter options"    , OFFSET(aresample_swr_opts)    ,
         AV_OPT_TYPE_STRING, {.str = NULL}, 0, 0, F|A },
+    { "frame_copies", "number of frames copied to make them writable",
+        offsetof(FFFilterGraph, nb_frame_copies), AV_OPT_TYPE_INT64,
+        { .i64 = 0 }, 0, INT64_MAX, F|V|A|AV_OPT_FLAG_READONLY|AV_OPT_FLAG_EXPORT },
     { NULL },
 };
 
@@ -78,6 +82,11 @@ int ff_graph_thread_init(FFFilterGraph *graph)
     graph->p.nb_threads  = 1;
     return 0;
 }
+
+int ff_graph_run_concurrent(FFFilterGraph *graph)
+{
+    return ff_filter_activate(&graph->ready_heap[0]->p);
+}
 #endif
 
 AVFilterGraph *avfilter_graph_alloc(void)
@@ -88,6 +97,11 @@ AVFilterGraph *avfilter_graph_alloc(void)
     if (!graph)
         return NULL;
 
+    if (ff_mutex_init(&graph->lock, NULL)) {
+        av_free(graph);
+        return NULL;
+    }
+
     ret = &graph->p;
     ret->av_class = &filtergraph_class;
     av_opt_set_defaults(ret);
@@ -101,9 +115,16 @@ void ff_filter_graph_remove_filter(AVFilterGraph *graph, AVFilterContext *filter
     int i, j;
     for (i = 0; i < graph->nb_filters; i++) {
         if (graph->filters[i] == filter) {
+            filter->ready = 0;
+            ff_filter_graph_update_ready(graph, filter);
             FFSWAP(AVFilterContext*, graph->filters[i],
                    graph->filters[graph->nb_filters - 1]);
             graph->nb_filters--;
+            if (i < graph->nb_filters) {
+                /* the last filter moved: its tie-break order changed */
+                fffilterctx(graph->filters[i])->graph_index = i;
+                ff_filter_graph_update_ready(graph, graph->filters[i]);
+            }
             filter->graph = NULL;
             for (j = 0; j<filter->nb_outputs; j++)
                 if (filter->outputs[j])
@@ -128,6 +149,9 @@ void avfilter_graph_free(AVFilterGraph **graphp)
     ff_graph_thread_free(graphi);
 
     av_freep(&graphi->sink_links);
+    av_freep(&graphi->ready_heap);
+
+    ff_mutex_destroy(&graphi->lock);
 
     av_opt_free(graph);
 
@@ -167,6 +191,7 @@ AVFilterContext *avfilter_graph_alloc_filter(AVFilterGraph *graph,
                                              const char *name)
 {
     AVFilterContext **filters, *s;
+    FFFilterContext **ready_heap;
     FFFilterGraph *graphi = fffiltergraph(graph);
 
     if (graph->thread_type && !graphi->thread_execute) {
@@ -186,13 +211,22 @@ AVFilterContext *avfilter_graph_alloc_filter(AVFilterGraph *graph,
         return NULL;
     graph->filters = filters;
 
+    ready_heap = av_realloc_array(graphi->ready_heap, graph->nb_filters + 1,
+                                  sizeof(*ready_heap));
+    if (!ready_heap)
+        return NULL;
+    graphi->ready_heap = ready_heap;
+
     s = ff_filter_alloc(filter, name);
     if (!s)
         return NULL;
 
+    fffilterctx(s)->graph_index = graph->nb_filters;
     graph->filters[graph->nb_filters++] = s;
 
     s->graph = graph;
+    if (s->ready)
+        ff_filter_graph_update_ready(graph, s);
 
     return s;
 }
@@ -1468,17 +1502,92 @@ int avfilter_graph_request_oldest(AVFilterGraph *graph)
     return 0;
 }
 
+static int ready_heap_before(const FFFilterContext *a, const FFFilterContext *b)
+{
+    if (a->p.ready != b->p.ready)
+        return a->p.ready > b->p.ready;
+    return a->graph_index < b->graph_index;
+}
+
+static void ready_heap_bubble_up(FFFilterGraph *graph,
+                                 FFFilterContext *ctx, int index)
+{
+    FFFilterContext **heap = graph->ready_heap;
+
+    av_assert0(index >= 0);
+
+    while (index) {
+        int parent = (index - 1) >> 1;
+        if (!ready_heap_before(ctx, heap[parent]))
+            break;
+        heap[index] = heap[parent];
+        heap[index]->ready_index = index;
+        index = parent;
+    }
+    heap[index] = ctx;
+    ctx->ready_index = index;
+}
+
+static void ready_heap_bubble_down(FFFilterGraph *graph,
+                                   FFFilterContext *ctx, int index)
+{
+    FFFilterContext **heap = graph->ready_heap;
+
+    av_assert0(index >= 0);
+
+    while (1) {
+        int child = 2 * index + 1;
+        if (child >= graph->nb_ready)
+            break;
+        if (child + 1 < graph->nb_ready &&
+            ready_heap_before(heap[child + 1], heap[child]))
+            child++;
+        if (!ready_heap_before(heap[child], ctx))
+            break;
+        heap[index] = heap[child];
+        heap[index]->ready_index = index;
+        index = child;
+    }
+    heap[index] = ctx;
+    ctx->ready_index = index;
+}
+
+void ff_filter_graph_update_ready(AVFilterGraph *graph, AVFilterContext *filter)
+{
+    FFFilterGraph   *graphi = fffiltergraph(graph);
+    FFFilterContext *ctx    = fffilterctx(filter);
+
+    if (!filter->ready) {
+        FFFilterContext *last;
+        int index = ctx->ready_index;
+
+        if (index < 0)
+            return;
+        ctx->ready_index = -1;
+        last = graphi->ready_heap[--graphi->nb_ready];
+        if (last == ctx)
+            return;
+        ready_heap_bubble_up  (graphi, last, index);
+        ready_heap_bubble_down(graphi, last, last->ready_index);
+        return;
+    }
+
+    if (ctx->ready_index < 0) {
+        av_assert0(graphi->nb_ready < graph->nb_filters);
+        ctx->ready_index = graphi->nb_ready++;
+    }
+    ready_heap_bubble_up  (graphi, ctx, ctx->ready_index);
+    ready_heap_bubble_down(graphi, ctx, ctx->ready_index);
+}
+
 int ff_filter_graph_run_once(AVFilterGraph *graph)
 {
-    AVFilterContext *filter;
-    unsigned i;
+    FFFilterGraph *graphi = fffiltergraph(graph);
 
     av_assert0(graph->nb_filters);
-    filter = graph->filters[0];
-    for (i = 1; i < graph->nb_filters; i++)
-        if (graph->filters[i]->ready > filter->ready)
-            filter = graph->filters[i];
-    if (!filter->ready)
+    if (!graphi->nb_ready)
         return AVERROR(EAGAIN);
-    return ff_filter_activate(filter);
+    if (graphi->nb_ready > 1 && graph->thread_type & AVFILTER_THREAD_GRAPH)
+        return ff_graph_run_concurrent(graphi);
+    return ff_filter_activate(&graphi->ready_heap[0]->p);
 }
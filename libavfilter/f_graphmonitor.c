@@ -585,6 +585,7 @@ const AVFilter ff_vf_graphmonitor = {
     .init          = init,
     .uninit        = uninit,
     .activate      = activate,
+    .flags_internal = FF_FILTER_FLAG_GRAPH_EXCLUSIVE,
     FILTER_INPUTS(ff_video_default_filterpad),
     FILTER_OUTPUTS(graphmonitor_outputs),
     FILTER_QUERY_FUNC(query_formats),
@@ -603,6 +604,7 @@ const AVFilter ff_avf_agraphmonitor = {
     .init          = init,
     .uninit        = uninit,
     .activate      = activate,
+    .flags_internal = FF_FILTER_FLAG_GRAPH_EXCLUSIVE,
     FILTER_INPUTS(ff_audio_default_filterpad),
     FILTER_OUTPUTS(graphmonitor_outputs),
     FILTER_QUERY_FUNC(query_formats),
@@ -205,6 +205,13 @@ static inline FilterLink* ff_filter_link(AVFilterLink *link)
  */
 #define FF_FILTER_FLAG_HWFRAME_AWARE (1 << 0)
 
+/**
+ * The filter accesses other filters of the graph, e.g. to send them commands
+ * or to inspect their links, and must not be activated concurrently with any
+ * other filter.
+ */
+#define FF_FILTER_FLAG_GRAPH_EXCLUSIVE (1 << 1)
+
 /**
  * Find the index of a link.
  *
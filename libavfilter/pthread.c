@@ -27,6 +27,7 @@
 #include "libavutil/macros.h"
 #include "libavutil/mem.h"
 #include "libavutil/slicethread.h"
+#include "libavutil/thread.h"
 
 #include "avfilter.h"
 #include "avfilter_internal.h"
@@ -40,6 +41,16 @@ typedef struct ThreadContext {
     AVFilterContext *ctx;
     void *arg;
     int   *rets;
+
+    /* concurrent activation of independent filters */
+    AVSliceThread *graph_thread;
+    int nb_graph_threads;
+    /* serializes slice jobs submitted by concurrently activated filters */
+    AVMutex execute_lock;
+
+    /* per-run parameters */
+    AVFilterContext **run_filters;
+    int              *run_rets;
 } ThreadContext;
 
 static void worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
@@ -50,30 +61,170 @@ static void worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb
         c->rets[jobnr] = ret;
 }
 
+static void graph_worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
+{
+    ThreadContext *c = priv;
+    c->run_rets[jobnr] = ff_filter_activate(c->run_filters[jobnr]);
+}
+
 static void slice_thread_uninit(ThreadContext *c)
 {
     avpriv_slicethread_free(&c->thread);
+    if (c->graph_thread) {
+        avpriv_slicethread_free(&c->graph_thread);
+        ff_mutex_destroy(&c->execute_lock);
+    }
+    av_freep(&c->run_filters);
+    av_freep(&c->run_rets);
 }
 
 static int thread_execute(AVFilterContext *ctx, avfilter_action_func *func,
                           void *arg, int *ret, int nb_jobs)
 {
-    ThreadContext *c = fffiltergraph(ctx->graph)->thread;
+    FFFilterGraph *graphi = fffiltergraph(ctx->graph);
+    ThreadContext *c = graphi->thread;
+    int concurrent = graphi->concurrent;
 
     if (nb_jobs <= 0)
         return 0;
+
+    if (concurrent)
+        ff_mutex_lock(&c->execute_lock);
+
     c->ctx         = ctx;
     c->arg         = arg;
     c->func        = func;
     c->rets        = ret;
 
     avpriv_slicethread_execute(c->thread, nb_jobs, 0);
+
+    if (concurrent)
+        ff_mutex_unlock(&c->execute_lock);
     return 0;
 }
 
-static int thread_init_internal(ThreadContext *c, int nb_threads)
+static int graph_thread_init(ThreadContext *c, AVExecutor *executor, int nb_threads)
 {
-    nb_threads = avpriv_slicethread_create(&c->thread, c, worker_func, NULL, nb_threads);
+    int ret;
+
+    c->run_filters = av_calloc(nb_threads, sizeof(*c->run_filters));
+    c->run_rets    = av_calloc(nb_threads, sizeof(*c->run_rets));
+    if (!c->run_filters || !c->run_rets)
+        return AVERROR(ENOMEM);
+
+    ret = ff_mutex_init(&c->execute_lock, NULL);
+    if (ret)
+        return AVERROR(ret);
+
+    ret = avpriv_slicethread_create_executor(&c->graph_thread, executor, c,
+                                             graph_worker_func, NULL, nb_threads);
+    if (ret <= 1) {
+        avpriv_slicethread_free(&c->graph_thread);
+        ff_mutex_destroy(&c->execute_lock);
+        return ret < 0 ? ret : 0;
+    }
+    c->nb_graph_threads = ret;
+
+    return 0;
+}
+
+static int is_connected_to_running(AVFilterContext *f)
+{
+    for (unsigned i = 0; i < f->nb_inputs; i++)
+        if (f->inputs[i] && fffilterctx(f->inputs[i]->src)->activating)
+            return 1;
+    for (unsigned i = 0; i < f->nb_outputs; i++)
+        if (f->outputs[i] && fffilterctx(f->outputs[i]->dst)->activating)
+            return 1;
+    return 0;
+}
+
+static int has_get_buffer(const AVFilterLink *link)
+{
+    return link->type == AVMEDIA_TYPE_VIDEO ? !!link->dstpad->get_buffer.video :
+           link->type == AVMEDIA_TYPE_AUDIO ? !!link->dstpad->get_buffer.audio : 0;
+}
+
+/**
+ * Walk the filters whose get_buffer callbacks f may end up calling: the
+ * destinations of its outputs with a custom callback and, since the callback
+ * may forward the request (e.g. ff_null_get_video_buffer()), recursively
+ * their own destinations. Those callbacks can touch the state of their
+ * filter, so f and these filters are scheduled as one unit.
+ *
+ * @param mark if >= 0, set the activating field of the filters to it,
+ *             otherwise check whether any of them is already activating
+ * @return 1 if mark < 0 and one of the filters is activating, 0 otherwise
+ */
+static int walk_get_buffer_chain(AVFilterContext *f, int mark)
+{
+    for (unsigned i = 0; i < f->nb_outputs; i++) {
+        AVFilterLink *link = f->outputs[i];
+        FFFilterContext *dsti;
+
+        if (!link || !has_get_buffer(link))
+            continue;
+
+        dsti = fffilterctx(link->dst);
+        if (mark >= 0)
+            dsti->activating = mark;
+        else if (dsti->activating)
+            return 1;
+
+        if (walk_get_buffer_chain(link->dst, mark))
+            return 1;
+    }
+    return 0;
+}
+
+int ff_graph_run_concurrent(FFFilterGraph *graphi)
+{
+    ThreadContext   *c = graphi->thread;
+    AVFilterContext *first = &graphi->ready_heap[0]->p;
+    int nb_run = 0, ret = 0;
+
+    if (!c || !c->graph_thread || !(first->thread_type & AVFILTER_THREAD_GRAPH))
+        return ff_filter_activate(first);
+
+    /* the heap array is roughly ordered by urgency, so scanning it in order
+     * favours the most urgent filters */
+    for (int i = 0; i < graphi->nb_ready && nb_run < c->nb_graph_threads; i++) {
+        AVFilterContext *f = &graphi->ready_heap[i]->p;
+
+        if (!(f->thread_type & AVFILTER_THREAD_GRAPH) ||
+            fffilterctx(f)->activating || is_connected_to_running(f) ||
+            walk_get_buffer_chain(f, -1))
+            continue;
+
+        fffilterctx(f)->activating = 1;
+        walk_get_buffer_chain(f, 1);
+        c->run_filters[nb_run++]   = f;
+    }
+
+    if (nb_run > 1) {
+        graphi->concurrent = 1;
+        avpriv_slicethread_execute(c->graph_thread, nb_run, 0);
+        graphi->concurrent = 0;
+
+        for (int i = 0; i < nb_run; i++)
+            if (c->run_rets[i] < 0 && !ret)
+                ret = c->run_rets[i];
+    } else {
+        ret = ff_filter_activate(first);
+    }
+
+    for (int i = 0; i < nb_run; i++) {
+        fffilterctx(c->run_filters[i])->activating = 0;
+        walk_get_buffer_chain(c->run_filters[i], 0);
+    }
+
+    return ret;
+}
+
+static int thread_init_internal(ThreadContext *c, AVExecutor *executor, int nb_threads)
+{
+    nb_threads = avpriv_slicethread_create_executor(&c->thread, executor, c,
+                                                    worker_func, NULL, nb_threads);
     if (nb_threads <= 1)
         avpriv_slicethread_free(&c->thread);
     return FFMAX(nb_threads, 1);
@@ -93,7 +244,7 @@ int ff_graph_thread_init(FFFilterGraph *graphi)
     if (!graphi->thread)
         return AVERROR(ENOMEM);
 
-    ret = thread_init_internal(graphi->thread, graph->nb_threads);
+    ret = thread_init_internal(graphi->thread, graph->executor, graph->nb_threads);
     if (ret <= 1) {
         av_freep(&graphi->thread);
         graph->thread_type = 0;
@@ -104,6 +255,16 @@ int ff_graph_thread_init(FFFilterGraph *graphi)
 
     graphi->thread_execute = thread_execute;
 
+    if (graph->thread_type & AVFILTER_THREAD_GRAPH) {
+        ThreadContext *c = graphi->thread;
+
+        ret = graph_thread_init(c, graph->executor, graph->nb_threads);
+        if (ret < 0)
+            return ret;
+        if (!c->graph_thread)
+            graph->thread_type &= ~AVFILTER_THREAD_GRAPH;
+    }
+
     return 0;
 }
 
@@ -0,0 +1,156 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Measure the cost of pushing frames through filter graphs of growing size,
+ * reported per filter activation.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "libavutil/error.h"
+#include "libavutil/frame.h"
+#include "libavutil/time.h"
+
+#include "libavfilter/avfilter.h"
+#include "libavfilter/buffersink.h"
+#include "libavfilter/buffersrc.h"
+
+static int build_graph(AVFilterGraph **pgraph, AVFilterContext **psrc,
+                       AVFilterContext **psink, int nb_filters)
+{
+    AVFilterGraph *graph;
+    AVFilterContext *prev;
+    int ret, i;
+
+    graph = avfilter_graph_alloc();
+    if (!graph)
+        return AVERROR(ENOMEM);
+
+    ret = avfilter_graph_create_filter(psrc, avfilter_get_by_name("buffer"), "in",
+                                       "video_size=16x16:pix_fmt=gray:time_base=1/25",
+                                       NULL, graph);
+    if (ret < 0)
+        goto fail;
+
+    prev = *psrc;
+    for (i = 0; i < nb_filters; i++) {
+        AVFilterContext *f;
+
+        ret = avfilter_graph_create_filter(&f, avfilter_get_by_name("null"),
+                                           NULL, NULL, NULL, graph);
+        if (ret < 0)
+            goto fail;
+        ret = avfilter_link(prev, 0, f, 0);
+        if (ret < 0)
+            goto fail;
+        prev = f;
+    }
+
+    ret = avfilter_graph_create_filter(psink, avfilter_get_by_name("buffersink"),
+                                       "out", NULL, NULL, graph);
+    if (ret < 0)
+        goto fail;
+    ret = avfilter_link(prev, 0, *psink, 0);
+    if (ret < 0)
+        goto fail;
+
+    ret = avfilter_graph_config(graph, NULL);
+    if (ret < 0)
+        goto fail;
+
+    *pgraph = graph;
+    return 0;
+fail:
+    avfilter_graph_free(&graph);
+    return ret;
+}
+
+static int run_graph(int nb_filters, int nb_frames)
+{
+    AVFilterGraph *graph = NULL;
+    AVFilterContext *src, *sink;
+    AVFrame *in = NULL, *out = NULL;
+    int64_t t0, t1;
+    int ret, i;
+
+    ret = build_graph(&graph, &src, &sink, nb_filters);
+    if (ret < 0)
+        return ret;
+
+    in  = av_frame_alloc();
+    out = av_frame_alloc();
+    if (!in || !out) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    in->format = AV_PIX_FMT_GRAY8;
+    in->width  = 16;
+    in->height = 16;
+    ret = av_frame_get_buffer(in, 0);
+    if (ret < 0)
+        goto end;
+
+    t0 = av_gettime_relative();
+    for (i = 0; i < nb_frames; i++) {
+        in->pts = i;
+        ret = av_buffersrc_add_frame_flags(src, in, AV_BUFFERSRC_FLAG_KEEP_REF);
+        if (ret < 0)
+            goto end;
+        ret = av_buffersink_get_frame(sink, out);
+        if (ret < 0)
+            goto end;
+        av_frame_unref(out);
+    }
+    t1 = av_gettime_relative();
+
+    /* each frame activates every filter of the chain at least once */
+    printf("%8d %12.1f %12.1f\n", nb_filters + 2,
+           (t1 - t0) * 1000.0 / nb_frames,
+           (t1 - t0) * 1000.0 / nb_frames / (nb_filters + 2));
+
+end:
+    av_frame_free(&in);
+    av_frame_free(&out);
+    avfilter_graph_free(&graph);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    int max_filters = argc > 1 ? atoi(argv[1]) : 256;
+    int nb_frames   = argc > 2 ? atoi(argv[2]) : 2000;
+    int n, ret;
+
+    if (max_filters <= 0 || nb_frames <= 0) {
+        fprintf(stderr, "Usage: %s [max_filters] [nb_frames]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%8s %12s %12s\n", "filters", "ns/frame", "ns/filter");
+    for (n = 1; n <= max_filters; n *= 2) {
+        ret = run_graph(n, nb_frames);
+        if (ret < 0) {
+            fprintf(stderr, "Graph with %d filters failed: %s\n", n, av_err2str(ret));
+            return 1;
+        }
+    }
+
+    return 0;
+}
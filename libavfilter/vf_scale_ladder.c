@@ -0,0 +1,317 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * scale the input to several output sizes at once, see sws_alloc_ladder()
+ */
+
+#include "libavutil/avstring.h"
+#include "libavutil/dict.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/parseutils.h"
+#include "libavutil/pixdesc.h"
+#include "libswscale/swscale.h"
+
+#include "avfilter.h"
+#include "filters.h"
+#include "formats.h"
+#include "video.h"
+
+typedef struct ScaleLadderContext {
+    const AVClass *class;
+    char *sizes_str;
+    char *flags_str;
+
+    int nb_rungs;
+    int *w, *h;
+    enum AVPixelFormat *formats;
+
+    SwsLadder *ladder;
+    /* source properties the ladder was made for */
+    int src_w, src_h;
+    enum AVPixelFormat src_format;
+
+    AVFrame **out;
+} ScaleLadderContext;
+
+static int config_output(AVFilterLink *outlink)
+{
+    AVFilterContext *ctx = outlink->src;
+    ScaleLadderContext *s = ctx->priv;
+    AVFilterLink *inlink = ctx->inputs[0];
+    const int i = FF_OUTLINK_IDX(outlink);
+
+    outlink->w = s->w[i];
+    outlink->h = s->h[i];
+    if (inlink->sample_aspect_ratio.num)
+        outlink->sample_aspect_ratio = av_mul_q((AVRational){ outlink->h * inlink->w,
+                                                              outlink->w * inlink->h },
+                                                inlink->sample_aspect_ratio);
+    else
+        outlink->sample_aspect_ratio = inlink->sample_aspect_ratio;
+    s->formats[i] = outlink->format;
+
+    return 0;
+}
+
+static av_cold int init(AVFilterContext *ctx)
+{
+    ScaleLadderContext *s = ctx->priv;
+    const char *p = s->sizes_str;
+    int ret;
+
+    while (p && *p) {
+        char *size = av_get_token(&p, "|");
+        int *w, *h;
+
+        if (!size)
+            return AVERROR(ENOMEM);
+        if (*p)
+            p++;
+
+        w = av_realloc_array(s->w, s->nb_rungs + 1, sizeof(*s->w));
+        if (w)
+            s->w = w;
+        h = av_realloc_array(s->h, s->nb_rungs + 1, sizeof(*s->h));
+        if (h)
+            s->h = h;
+        if (!w || !h) {
+            av_free(size);
+            return AVERROR(ENOMEM);
+        }
+
+        ret = av_parse_video_size(&s->w[s->nb_rungs], &s->h[s->nb_rungs], size);
+        if (ret < 0)
+            av_log(ctx, AV_LOG_ERROR, "Invalid size '%s'\n", size);
+        av_free(size);
+        if (ret < 0)
+            return ret;
+        s->nb_rungs++;
+    }
+
+    if (!s->nb_rungs) {
+        av_log(ctx, AV_LOG_ERROR, "No output sizes given\n");
+        return AVERROR(EINVAL);
+    }
+
+    s->formats = av_calloc(s->nb_rungs, sizeof(*s->formats));
+    s->out     = av_calloc(s->nb_rungs, sizeof(*s->out));
+    if (!s->formats || !s->out)
+        return AVERROR(ENOMEM);
+
+    for (int i = 0; i < s->nb_rungs; i++) {
+        AVFilterPad pad = { 0 };
+
+        pad.type         = AVMEDIA_TYPE_VIDEO;
+        pad.config_props = config_output;
+        pad.name         = av_asprintf("output%d", i);
+        if (!pad.name)
+            return AVERROR(ENOMEM);
+
+        if ((ret = ff_append_outpad_free_name(ctx, &pad)) < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static av_cold void uninit(AVFilterContext *ctx)
+{
+    ScaleLadderContext *s = ctx->priv;
+
+    sws_free_ladder(&s->ladder);
+    if (s->out)
+        for (int i = 0; i < s->nb_rungs; i++)
+            av_frame_free(&s->out[i]);
+    av_freep(&s->out);
+    av_freep(&s->w);
+    av_freep(&s->h);
+    av_freep(&s->formats);
+}
+
+static int query_formats(AVFilterContext *ctx)
+{
+    AVFilterFormats *formats = NULL;
+    const AVPixFmtDescriptor *desc = NULL;
+    int ret;
+
+    /* all outputs get the format of the input, which makes rungs of the
+     * same format that can be scaled from each other */
+    while ((desc = av_pix_fmt_desc_next(desc))) {
+        enum AVPixelFormat pix_fmt = av_pix_fmt_desc_get_id(desc);
+
+        if (sws_isSupportedInput(pix_fmt) && sws_isSupportedOutput(pix_fmt) &&
+            (ret = ff_add_format(&formats, pix_fmt)) < 0)
+            return ret;
+    }
+
+    return ff_set_common_formats(ctx, formats);
+}
+
+static int init_ladder(AVFilterContext *ctx, const AVFrame *in)
+{
+    ScaleLadderContext *s = ctx->priv;
+    AVDictionary *opts = NULL;
+    int ret;
+
+    if (s->ladder && in->width == s->src_w && in->height == s->src_h &&
+        in->format == s->src_format)
+        return 0;
+
+    sws_free_ladder(&s->ladder);
+
+    if (*s->flags_str &&
+        (ret = av_dict_set(&opts, "sws_flags", s->flags_str, 0)) < 0)
+        goto end;
+    if ((ret = av_dict_set_int(&opts, "threads", ff_filter_get_nb_threads(ctx), 0)) < 0)
+        goto end;
+
+    s->ladder = sws_alloc_ladder(in->width, in->height, in->format, s->nb_rungs,
+                                 s->w, s->h, s->formats, opts);
+    if (!s->ladder) {
+        av_log(ctx, AV_LOG_ERROR, "Failed to create the scaler for %dx%d %s input\n",
+               in->width, in->height, av_get_pix_fmt_name(in->format));
+        ret = AVERROR(EINVAL);
+        goto end;
+    }
+    s->src_w      = in->width;
+    s->src_h      = in->height;
+    s->src_format = in->format;
+
+end:
+    av_dict_free(&opts);
+    return ret;
+}
+
+static int filter_frame(AVFilterContext *ctx, AVFrame *in)
+{
+    ScaleLadderContext *s = ctx->priv;
+    int ret = 0;
+
+    if ((ret = init_ladder(ctx, in)) < 0)
+        goto end;
+
+    for (int i = 0; i < s->nb_rungs; i++) {
+        AVFilterLink *outlink = ctx->outputs[i];
+        AVFrame *out;
+
+        out = s->out[i] = ff_get_video_buffer(outlink, outlink->w, outlink->h);
+        if (!out) {
+            ret = AVERROR(ENOMEM);
+            goto end;
+        }
+
+        av_frame_copy_props(out, in);
+        out->width  = outlink->w;
+        out->height = outlink->h;
+        av_reduce(&out->sample_aspect_ratio.num, &out->sample_aspect_ratio.den,
+                  (int64_t)in->sample_aspect_ratio.num * outlink->h * in->width,
+                  (int64_t)in->sample_aspect_ratio.den * outlink->w * in->height,
+                  INT_MAX);
+    }
+
+    if ((ret = sws_ladder_scale_frame(s->ladder, s->out, in)) < 0)
+        goto end;
+
+    for (int i = 0; i < s->nb_rungs; i++) {
+        AVFrame *out = s->out[i];
+
+        s->out[i] = NULL;
+        if (ff_outlink_get_status(ctx->outputs[i])) {
+            av_frame_free(&out);
+            continue;
+        }
+        if ((ret = ff_filter_frame(ctx->outputs[i], out)) < 0)
+            goto end;
+    }
+
+end:
+    for (int i = 0; i < s->nb_rungs; i++)
+        av_frame_free(&s->out[i]);
+    av_frame_free(&in);
+    return ret;
+}
+
+static int activate(AVFilterContext *ctx)
+{
+    AVFilterLink *inlink = ctx->inputs[0];
+    AVFrame *in;
+    int status, ret, nb_eofs = 0;
+    int64_t pts;
+
+    for (int i = 0; i < ctx->nb_outputs; i++)
+        nb_eofs += ff_outlink_get_status(ctx->outputs[i]) == AVERROR_EOF;
+
+    if (nb_eofs == ctx->nb_outputs) {
+        ff_inlink_set_status(inlink, AVERROR_EOF);
+        return 0;
+    }
+
+    ret = ff_inlink_consume_frame(inlink, &in);
+    if (ret < 0)
+        return ret;
+    if (ret > 0)
+        return filter_frame(ctx, in);
+
+    if (ff_inlink_acknowledge_status(inlink, &status, &pts)) {
+        for (int i = 0; i < ctx->nb_outputs; i++) {
+            if (ff_outlink_get_status(ctx->outputs[i]))
+                continue;
+            ff_outlink_set_status(ctx->outputs[i], status, pts);
+        }
+        return 0;
+    }
+
+    for (int i = 0; i < ctx->nb_outputs; i++) {
+        if (ff_outlink_get_status(ctx->outputs[i]))
+            continue;
+
+        if (ff_outlink_frame_wanted(ctx->outputs[i])) {
+            ff_inlink_request_frame(inlink);
+            return 0;
+        }
+    }
+
+    return FFERROR_NOT_READY;
+}
+
+#define OFFSET(x) offsetof(ScaleLadderContext, x)
+#define FLAGS AV_OPT_FLAG_VIDEO_PARAM | AV_OPT_FLAG_FILTERING_PARAM
+static const AVOption scale_ladder_options[] = {
+    { "sizes", "set the output sizes, separated by '|'", OFFSET(sizes_str), AV_OPT_TYPE_STRING, { .str = NULL }, .flags = FLAGS },
+    { "flags", "set the libswscale scaling flags",       OFFSET(flags_str), AV_OPT_TYPE_STRING, { .str = "" },   .flags = FLAGS },
+    { NULL }
+};
+
+AVFILTER_DEFINE_CLASS(scale_ladder);
+
+const AVFilter ff_vf_scale_ladder = {
+    .name            = "scale_ladder",
+    .description     = NULL_IF_CONFIG_SMALL("Scale the input video to several sizes."),
+    .priv_size       = sizeof(ScaleLadderContext),
+    .priv_class      = &scale_ladder_class,
+    .init            = init,
+    .uninit          = uninit,
+    .activate        = activate,
+    FILTER_INPUTS(ff_video_default_filterpad),
+    .outputs         = NULL,
+    FILTER_QUERY_FUNC(query_formats),
+    .flags           = AVFILTER_FLAG_DYNAMIC_OUTPUTS,
+};
@@ -22,10 +22,13 @@
 
 #include <stdbool.h>
 
+#include "cpu.h"
+#include "error.h"
 #include "mem.h"
 #include "thread.h"
 
 #include "executor.h"
+#include "executor_internal.h"
 
 #if !HAVE_THREADS
 
@@ -52,6 +55,7 @@ struct AVExecutor {
     AVTaskCallbacks cb;
     int thread_count;
     bool recursive;
+    bool shared;
 
     ThreadInfo *threads;
     uint8_t *local_contexts;
@@ -139,12 +143,10 @@ static void executor_free(AVExecutor *e, const int has_lock, const int has_cond)
     av_free(e);
 }
 
-AVExecutor* av_executor_alloc(const AVTaskCallbacks *cb, int thread_count)
+static AVExecutor *executor_alloc(const AVTaskCallbacks *cb, int thread_count)
 {
     AVExecutor *e;
     int has_lock = 0, has_cond = 0;
-    if (!cb || !cb->user_data || !cb->ready || !cb->run || !cb->priority_higher)
-        return NULL;
 
     e = av_mallocz(sizeof(*e));
     if (!e)
@@ -181,6 +183,78 @@ free_executor:
     return NULL;
 }
 
+AVExecutor* av_executor_alloc(const AVTaskCallbacks *cb, int thread_count)
+{
+    if (!cb || !cb->user_data || !cb->ready || !cb->run || !cb->priority_higher)
+        return NULL;
+
+    return executor_alloc(cb, thread_count);
+}
+
+// jobs are run in the order they were submitted
+static int shared_priority_higher(const AVTask *a, const AVTask *b)
+{
+    return 1;
+}
+
+static int shared_ready(const AVTask *t, void *user_data)
+{
+    return 1;
+}
+
+static int shared_run(AVTask *t, void *local_context, void *user_data)
+{
+    FFExecutorJob *job = (FFExecutorJob*)t;
+    job->run(job);
+    return 0;
+}
+
+AVExecutor *av_executor_alloc_shared(int thread_count)
+{
+    static const AVTaskCallbacks callbacks = {
+        .priority_higher = shared_priority_higher,
+        .ready           = shared_ready,
+        .run             = shared_run,
+    };
+    AVExecutor *e;
+
+    if (thread_count < 0)
+        return NULL;
+    if (!thread_count)
+        thread_count = av_cpu_count();
+
+    e = executor_alloc(&callbacks, thread_count);
+    if (e)
+        e->shared = true;
+
+    return e;
+}
+
+int avpriv_executor_shared_threads(const AVExecutor *e)
+{
+    return e->shared ? e->thread_count : AVERROR(EINVAL);
+}
+
+int ff_executor_cancel(AVExecutor *e, AVTask *t)
+{
+    AVTask **prev;
+    int found = 0;
+
+    if (e->thread_count)
+        ff_mutex_lock(&e->lock);
+    for (prev = &e->tasks; *prev; prev = &(*prev)->next) {
+        if (*prev == t) {
+            remove_task(prev, t);
+            found = 1;
+            break;
+        }
+    }
+    if (e->thread_count)
+        ff_mutex_unlock(&e->lock);
+
+    return found;
+}
+
 void av_executor_free(AVExecutor **executor)
 {
     int thread_count;
@@ -51,6 +51,23 @@ typedef struct AVTaskCallbacks {
  */
 AVExecutor* av_executor_alloc(const AVTaskCallbacks *callbacks, int thread_count);
 
+/**
+ * Allocate an executor whose worker threads can be shared by several codec
+ * contexts and filter graphs for their slice threading, see
+ * AVCodecContext.executor and AVFilterGraph.executor.
+ *
+ * Jobs submitted by all users are run in the order of submission, while the
+ * number of jobs of a single codec context or filter graph running at the same
+ * time is limited by its own thread count.
+ *
+ * The executor must be freed with av_executor_free() only after all codec
+ * contexts and filter graphs using it have been freed.
+ *
+ * @param thread_count worker thread number, 0 for one per CPU
+ * @return the executor or NULL on failure
+ */
+AVExecutor *av_executor_alloc_shared(int thread_count);
+
 /**
  * Free executor
  * @param e  pointer to executor
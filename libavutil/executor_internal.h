@@ -0,0 +1,47 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVUTIL_EXECUTOR_INTERNAL_H
+#define AVUTIL_EXECUTOR_INTERNAL_H
+
+#include "executor.h"
+
+/**
+ * A job submitted with av_executor_execute() to an executor allocated with
+ * av_executor_alloc_shared().
+ */
+typedef struct FFExecutorJob {
+    AVTask task;
+    void (*run)(struct FFExecutorJob *job);
+} FFExecutorJob;
+
+/**
+ * @return the number of worker threads of a shared executor, or a negative
+ *         AVERROR if the executor was not allocated with
+ *         av_executor_alloc_shared()
+ */
+int avpriv_executor_shared_threads(const AVExecutor *e);
+
+/**
+ * Remove a task that has not been started yet from the executor.
+ *
+ * @return 1 if the task was removed, 0 if it is already running or finished
+ */
+int ff_executor_cancel(AVExecutor *e, AVTask *t);
+
+#endif /* AVUTIL_EXECUTOR_INTERNAL_H */
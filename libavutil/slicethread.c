@@ -18,6 +18,7 @@
 
 #include <stdatomic.h>
 #include "cpu.h"
+#include "executor_internal.h"
 #include "internal.h"
 #include "slicethread.h"
 #include "mem.h"
@@ -36,6 +37,11 @@ typedef struct WorkerContext {
     int             done;
 } WorkerContext;
 
+typedef struct SliceTask {
+    FFExecutorJob   job;
+    AVSliceThread   *ctx;
+} SliceTask;
+
 struct AVSliceThread {
     WorkerContext   *workers;
     int             nb_threads;
@@ -52,6 +58,11 @@ struct AVSliceThread {
     void            *priv;
     void            (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads);
     void            (*main_func)(void *priv);
+
+    /* jobs are run on the threads of a shared executor instead of workers */
+    AVExecutor      *executor;
+    SliceTask       *tasks;
+    int             nb_tasks_running;
 };
 
 static int run_jobs(AVSliceThread *ctx)
@@ -68,6 +79,61 @@ static int run_jobs(AVSliceThread *ctx)
     return current_job == nb_jobs + nb_active_threads - 1;
 }
 
+/*
+ * Run jobs on a shared executor. Unlike with private workers, no job is
+ * reserved for a given thread, as some of the tasks may start late or not at
+ * all; jobs are picked strictly in order, so that a job can always wait for
+ * the progress of previous ones.
+ */
+static void run_jobs_shared(AVSliceThread *ctx)
+{
+    unsigned nb_jobs  = ctx->nb_jobs;
+    unsigned threadnr = atomic_fetch_add_explicit(&ctx->first_job, 1, memory_order_relaxed);
+    unsigned jobnr;
+
+    while ((jobnr = atomic_fetch_add_explicit(&ctx->current_job, 1, memory_order_acq_rel)) < nb_jobs)
+        ctx->worker_func(ctx->priv, jobnr, threadnr, nb_jobs, ctx->nb_active_threads);
+}
+
+static void slice_task_run(FFExecutorJob *job)
+{
+    AVSliceThread *ctx = ((SliceTask*)job)->ctx;
+
+    run_jobs_shared(ctx);
+
+    pthread_mutex_lock(&ctx->done_mutex);
+    if (!--ctx->nb_tasks_running)
+        pthread_cond_signal(&ctx->done_cond);
+    pthread_mutex_unlock(&ctx->done_mutex);
+}
+
+static void execute_shared(AVSliceThread *ctx, int nb_jobs)
+{
+    int nb_tasks, nb_cancelled = 0;
+
+    ctx->nb_jobs           = nb_jobs;
+    ctx->nb_active_threads = FFMIN(nb_jobs, ctx->nb_threads);
+    atomic_store_explicit(&ctx->first_job, 0, memory_order_relaxed);
+    atomic_store_explicit(&ctx->current_job, 0, memory_order_relaxed);
+
+    nb_tasks = ctx->nb_active_threads - 1;
+    ctx->nb_tasks_running = nb_tasks;
+    for (int i = 0; i < nb_tasks; i++)
+        av_executor_execute(ctx->executor, &ctx->tasks[i].job.task);
+
+    run_jobs_shared(ctx);
+
+    // all jobs have been picked, tasks that did not start are not needed
+    for (int i = 0; i < nb_tasks; i++)
+        nb_cancelled += ff_executor_cancel(ctx->executor, &ctx->tasks[i].job.task);
+
+    pthread_mutex_lock(&ctx->done_mutex);
+    ctx->nb_tasks_running -= nb_cancelled;
+    while (ctx->nb_tasks_running)
+        pthread_cond_wait(&ctx->done_cond, &ctx->done_mutex);
+    pthread_mutex_unlock(&ctx->done_mutex);
+}
+
 static void *attribute_align_arg thread_worker(void *v)
 {
     WorkerContext *w = v;
@@ -187,11 +253,80 @@ int avpriv_slicethread_create(AVSliceThread **pctx, void *priv,
     return nb_threads;
 }
 
+int avpriv_slicethread_create_executor(AVSliceThread **pctx, AVExecutor *executor,
+                                       void *priv,
+                                       void (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads),
+                                       void (*main_func)(void *priv),
+                                       int nb_threads)
+{
+    AVSliceThread *ctx;
+    int max_threads;
+    int ret;
+
+    // main_func may wait for the jobs, which is only safe with own workers
+    if (!executor || main_func)
+        return avpriv_slicethread_create(pctx, priv, worker_func, main_func, nb_threads);
+
+    av_assert0(nb_threads >= 0);
+    max_threads = avpriv_executor_shared_threads(executor);
+    if (max_threads < 0)
+        return max_threads;
+    // the calling thread runs jobs as well
+    max_threads++;
+    if (!nb_threads || nb_threads > max_threads)
+        nb_threads = max_threads;
+
+    *pctx = ctx = av_mallocz(sizeof(*ctx));
+    if (!ctx)
+        return AVERROR(ENOMEM);
+
+    if (nb_threads > 1) {
+        ctx->tasks = av_calloc(nb_threads - 1, sizeof(*ctx->tasks));
+        if (!ctx->tasks) {
+            av_freep(pctx);
+            return AVERROR(ENOMEM);
+        }
+        for (int i = 0; i < nb_threads - 1; i++) {
+            ctx->tasks[i].job.run = slice_task_run;
+            ctx->tasks[i].ctx     = ctx;
+        }
+    }
+
+    ctx->priv        = priv;
+    ctx->worker_func = worker_func;
+    ctx->nb_threads  = nb_threads;
+    ctx->executor    = executor;
+
+    atomic_init(&ctx->first_job, 0);
+    atomic_init(&ctx->current_job, 0);
+    ret = pthread_mutex_init(&ctx->done_mutex, NULL);
+    if (ret) {
+        av_freep(&ctx->tasks);
+        av_freep(pctx);
+        return AVERROR(ret);
+    }
+    ret = pthread_cond_init(&ctx->done_cond, NULL);
+    if (ret) {
+        pthread_mutex_destroy(&ctx->done_mutex);
+        av_freep(&ctx->tasks);
+        av_freep(pctx);
+        return AVERROR(ret);
+    }
+
+    return nb_threads;
+}
+
 void avpriv_slicethread_execute(AVSliceThread *ctx, int nb_jobs, int execute_main)
 {
     int nb_workers, i, is_last = 0;
 
     av_assert0(nb_jobs > 0);
+
+    if (ctx->executor) {
+        execute_shared(ctx, nb_jobs);
+        return;
+    }
+
     ctx->nb_jobs           = nb_jobs;
     ctx->nb_active_threads = FFMIN(nb_jobs, ctx->nb_threads);
     atomic_store_explicit(&ctx->first_job, 0, memory_order_relaxed);
@@ -231,8 +366,8 @@ void avpriv_slicethread_free(AVSliceThread **pctx)
         return;
 
     ctx = *pctx;
-    nb_workers = ctx->nb_threads;
-    if (!ctx->main_func)
+    nb_workers = ctx->executor ? 0 : ctx->nb_threads;
+    if (!ctx->main_func && !ctx->executor)
         nb_workers--;
 
     ctx->finished = 1;
@@ -254,6 +389,7 @@ void avpriv_slicethread_free(AVSliceThread **pctx)
     pthread_cond_destroy(&ctx->done_cond);
     pthread_mutex_destroy(&ctx->done_mutex);
     av_freep(&ctx->workers);
+    av_freep(&ctx->tasks);
     av_freep(pctx);
 }
 
@@ -268,6 +404,16 @@ int avpriv_slicethread_create(AVSliceThread **pctx, void *priv,
     return AVERROR(ENOSYS);
 }
 
+int avpriv_slicethread_create_executor(AVSliceThread **pctx, AVExecutor *executor,
+                                       void *priv,
+                                       void (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads),
+                                       void (*main_func)(void *priv),
+                                       int nb_threads)
+{
+    *pctx = NULL;
+    return AVERROR(ENOSYS);
+}
+
 void avpriv_slicethread_execute(AVSliceThread *ctx, int nb_jobs, int execute_main)
 {
     av_assert0(0);
@@ -19,6 +19,8 @@
 #ifndef AVUTIL_SLICETHREAD_H
 #define AVUTIL_SLICETHREAD_H
 
+#include "executor.h"
+
 typedef struct AVSliceThread AVSliceThread;
 
 /**
@@ -35,6 +37,23 @@ int avpriv_slicethread_create(AVSliceThread **pctx, void *priv,
                               void (*main_func)(void *priv),
                               int nb_threads);
 
+/**
+ * Create slice threading context running its jobs on the worker threads of an
+ * executor shared with other users.
+ * @param executor executor allocated with av_executor_alloc_shared(); if NULL,
+ *                 or if main_func is set, this is equivalent to
+ *                 avpriv_slicethread_create()
+ * @param nb_threads maximum number of threads running the jobs of one execute
+ *                   call, including the calling thread; 0 for all threads of
+ *                   the executor
+ * @return return number of threads or negative AVERROR on failure
+ */
+int avpriv_slicethread_create_executor(AVSliceThread **pctx, AVExecutor *executor,
+                                       void *priv,
+                                       void (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads),
+                                       void (*main_func)(void *priv),
+                                       int nb_threads);
+
 /**
  * Execute slice threading.
  * @param ctx slice threading context
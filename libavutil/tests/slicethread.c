@@ -0,0 +1,138 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Run slice threading contexts of several threads on one shared executor,
+ * with every job waiting for the previous one as in wavefront decoding.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/executor.h"
+#include "libavutil/macros.h"
+#include "libavutil/slicethread.h"
+#include "libavutil/thread.h"
+
+#define NB_USERS  4
+#define NB_RUNS 200
+#define MAX_JOBS 24
+
+typedef struct User {
+    AVSliceThread  *slicethread;
+    int             nb_threads;
+
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    int             done[MAX_JOBS];
+
+    int             nb_jobs_run;
+    int             errors;
+} User;
+
+static void worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
+{
+    User *u = priv;
+
+    pthread_mutex_lock(&u->lock);
+    while (jobnr > 0 && !u->done[jobnr - 1])
+        pthread_cond_wait(&u->cond, &u->lock);
+
+    if (u->done[jobnr] || threadnr < 0 || threadnr >= nb_threads ||
+        nb_threads > u->nb_threads)
+        u->errors++;
+    u->done[jobnr] = 1;
+    u->nb_jobs_run++;
+
+    pthread_cond_broadcast(&u->cond);
+    pthread_mutex_unlock(&u->lock);
+}
+
+static void *user_main(void *arg)
+{
+    User *u = arg;
+
+    for (int i = 0; i < NB_RUNS; i++) {
+        int nb_jobs = 1 + i % MAX_JOBS;
+
+        avpriv_slicethread_execute(u->slicethread, nb_jobs, 0);
+
+        for (int j = 0; j < nb_jobs; j++) {
+            if (!u->done[j])
+                u->errors++;
+        }
+        memset(u->done, 0, sizeof(u->done));
+    }
+
+    return NULL;
+}
+
+int main(void)
+{
+    AVExecutor *executor;
+    User users[NB_USERS] = { 0 };
+    pthread_t threads[NB_USERS];
+    int ret = 0;
+
+    executor = av_executor_alloc_shared(3);
+    if (!executor) {
+        fprintf(stderr, "Failed to allocate the executor\n");
+        return 1;
+    }
+
+    for (int i = 0; i < NB_USERS; i++) {
+        User *u = &users[i];
+
+        pthread_mutex_init(&u->lock, NULL);
+        pthread_cond_init(&u->cond, NULL);
+
+        // the executor has 3 threads, the calling thread makes 4
+        u->nb_threads = avpriv_slicethread_create_executor(&u->slicethread, executor, u,
+                                                           worker_func, NULL, i + 2);
+        if (u->nb_threads != FFMIN(i + 2, 4)) {
+            fprintf(stderr, "Unexpected thread count %d\n", u->nb_threads);
+            return 1;
+        }
+    }
+
+    for (int i = 0; i < NB_USERS; i++) {
+        if (pthread_create(&threads[i], NULL, user_main, &users[i])) {
+            fprintf(stderr, "pthread_create failed\n");
+            return 1;
+        }
+    }
+
+    for (int i = 0; i < NB_USERS; i++) {
+        User *u = &users[i];
+
+        pthread_join(threads[i], NULL);
+
+        printf("user %d: %d threads, %d jobs, %d errors\n",
+               i, u->nb_threads, u->nb_jobs_run, u->errors);
+        if (u->errors)
+            ret = 1;
+
+        avpriv_slicethread_free(&u->slicethread);
+        pthread_cond_destroy(&u->cond);
+        pthread_mutex_destroy(&u->lock);
+    }
+
+    av_executor_free(&executor);
+
+    return ret;
+}
@@ -560,25 +560,13 @@ av_cold void swri_rematrix_free(SwrContext *s){
     av_freep(&s->native_simd_one);
 }
 
-int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mustcopy){
+/* mix the output channels [start, end[ */
+static void rematrix_channels(SwrContext *s, AudioData *out, AudioData *in,
+                              int len, int len1, int mustcopy, int start, int end){
     int out_i, in_i, i, j;
-    int len1 = 0;
-    int off = 0;
+    int off = len1 * out->bps;
 
-    if(s->mix_any_f) {
-        s->mix_any_f(out->ch, (const uint8_t **)in->ch, s->native_matrix, len);
-        return 0;
-    }
-
-    if(s->mix_2_1_simd || s->mix_1_1_simd){
-        len1= len&~15;
-        off = len1 * out->bps;
-    }
-
-    av_assert0(s->out_ch_layout.order == AV_CHANNEL_ORDER_UNSPEC || out->ch_count == s->out_ch_layout.nb_channels);
-    av_assert0(s-> in_ch_layout.order == AV_CHANNEL_ORDER_UNSPEC || in ->ch_count == s->in_ch_layout.nb_channels);
-
-    for(out_i=0; out_i<out->ch_count; out_i++){
+    for(out_i=start; out_i<end; out_i++){
         switch(s->matrix_ch[out_i][0]){
         case 0:
             if(mustcopy)
@@ -638,5 +626,40 @@ int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mus
             }
         }
     }
+}
+
+typedef struct RematrixJob {
+    SwrContext *s;
+    AudioData *out, *in;
+    int len, len1, mustcopy;
+} RematrixJob;
+
+static void rematrix_job(void *arg, int jobnr, int nb_jobs){
+    RematrixJob *job = arg;
+    int start = job->out->ch_count *  jobnr      / nb_jobs;
+    int end   = job->out->ch_count * (jobnr + 1) / nb_jobs;
+
+    rematrix_channels(job->s, job->out, job->in, job->len, job->len1, job->mustcopy, start, end);
+}
+
+int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mustcopy){
+    int len1 = 0;
+
+    if(s->mix_any_f) {
+        s->mix_any_f(out->ch, (const uint8_t **)in->ch, s->native_matrix, len);
+        return 0;
+    }
+
+    if(s->mix_2_1_simd || s->mix_1_1_simd)
+        len1= len&~15;
+
+    av_assert0(s->out_ch_layout.order == AV_CHANNEL_ORDER_UNSPEC || out->ch_count == s->out_ch_layout.nb_channels);
+    av_assert0(s-> in_ch_layout.order == AV_CHANNEL_ORDER_UNSPEC || in ->ch_count == s->in_ch_layout.nb_channels);
+
+    if(s->slicethread && out->ch_count > 1){
+        RematrixJob job = { s, out, in, len, len1, mustcopy };
+        swri_execute(s, rematrix_job, &job, FFMIN(out->ch_count, s->nb_threads));
+    }else
+        rematrix_channels(s, out, in, len, len1, mustcopy, 0, out->ch_count);
     return 0;
 }
@@ -346,6 +346,59 @@ static int set_compensation(ResampleContext *c, int sample_delta, int compensati
     return 0;
 }
 
+/* resample the channels [start, end[ and update the context after the last one */
+static int resample_channels(ResampleContext *c, AudioData *dst, AudioData *src,
+                             int start, int end, int n, int linear)
+{
+    int (*resample_func)(struct ResampleContext *c, void *dst,
+                         const void *src, int n, int update_ctx);
+    int i, consumed = 0;
+
+    if (!linear && c->dsp.resample_common_multi && end - start > 1)
+        return c->dsp.resample_common_multi(c, dst->ch + start,
+                                            (const uint8_t * const *)src->ch + start,
+                                            end - start, n, 1);
+
+    resample_func = linear ? c->dsp.resample_linear : c->dsp.resample_common;
+    for (i = start; i < end; i++)
+        consumed = resample_func(c, dst->ch[i], src->ch[i], n, i + 1 == end);
+    return consumed;
+}
+
+/* the largest number of channels resample_common_multi() processes at once */
+#define RESAMPLE_JOB_CHANNELS 4
+
+typedef struct ResampleJob {
+    ResampleContext *c;
+    AudioData *dst, *src;
+    int n, linear;
+    int ch_per_job;
+    /* state after the last channel */
+    int consumed, index, frac;
+} ResampleJob;
+
+static void resample_job(void *arg, int jobnr, int nb_jobs)
+{
+    ResampleJob *job = arg;
+    /* every job starts from the same position, the filter bank is only read */
+    ResampleContext c = *job->c;
+    int start = jobnr * job->ch_per_job;
+    int end   = FFMIN(start + job->ch_per_job, job->dst->ch_count);
+    int consumed;
+
+    consumed = resample_channels(&c, job->dst, job->src, start, end, job->n, job->linear);
+    if (end == job->dst->ch_count) {
+        job->consumed = consumed;
+        job->index    = c.index;
+        job->frac     = c.frac;
+    }
+}
+
+void swri_resample_set_threads(ResampleContext *c, SwrContext *s)
+{
+    c->thread_ctx = s;
+}
+
 static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, AudioData *src, int src_size, int *consumed){
     int i;
     int64_t max_src_size = (INT64_MAX/2 / c->phase_count) / c->src_incr;
@@ -379,17 +432,33 @@ static int multiple_resample(ResampleContext *c, AudioData *dst, int dst_size, A
         int64_t end_index = (1LL + src_size - c->filter_length) * c->phase_count;
         int64_t delta_frac = (end_index - c->index) * c->src_incr - c->frac;
         int delta_n = (delta_frac + c->dst_incr - 1) / c->dst_incr;
-        int (*resample_func)(struct ResampleContext *c, void *dst,
-                             const void *src, int n, int update_ctx);
 
         dst_size = FFMAX(FFMIN(dst_size, delta_n), 0);
         if (dst_size > 0) {
             /* resample_linear and resample_common should have same behavior
              * when frac and dst_incr_mod are zero */
-            resample_func = (c->linear && (c->frac || c->dst_incr_mod)) ?
-                            c->dsp.resample_linear : c->dsp.resample_common;
-            for (i = 0; i < dst->ch_count; i++)
-                *consumed = resample_func(c, dst->ch[i], src->ch[i], dst_size, i+1 == dst->ch_count);
+            int linear = c->linear && (c->frac || c->dst_incr_mod);
+
+            if (c->thread_ctx && dst->ch_count > RESAMPLE_JOB_CHANNELS) {
+                ResampleJob job = {
+                    .c      = c,
+                    .dst    = dst,
+                    .src    = src,
+                    .n      = dst_size,
+                    .linear = linear,
+                    /* whole groups of channels for resample_common_multi(),
+                     * so that the output does not depend on the split */
+                    .ch_per_job = FFALIGN((dst->ch_count + c->thread_ctx->nb_threads - 1) /
+                                          c->thread_ctx->nb_threads, RESAMPLE_JOB_CHANNELS),
+                };
+                swri_execute(c->thread_ctx, resample_job, &job,
+                             (dst->ch_count + job.ch_per_job - 1) / job.ch_per_job);
+                c->index  = job.index;
+                c->frac   = job.frac;
+                *consumed = job.consumed;
+            } else {
+                *consumed = resample_channels(c, dst, src, 0, dst->ch_count, dst_size, linear);
+            }
         }
     }
 
@@ -57,7 +57,16 @@ typedef struct ResampleContext {
                                const void *src, int n, int update_ctx);
         int (*resample_linear)(struct ResampleContext *c, void *dst,
                                const void *src, int n, int update_ctx);
+        /* resample_common() for nb_channels channels at once, NULL if the
+         * per channel function is faster */
+        int (*resample_common_multi)(struct ResampleContext *c, uint8_t *const *dst,
+                                     const uint8_t *const *src, int nb_channels,
+                                     int n, int update_ctx);
     } dsp;
+
+    /* the SwrContext whose threads the channels are split across, NULL if
+     * they are resampled on the calling thread */
+    struct SwrContext *thread_ctx;
 } ResampleContext;
 
 void swri_resample_dsp_init(ResampleContext *c);
@@ -45,29 +45,42 @@
 
 void swri_resample_dsp_init(ResampleContext *c)
 {
+    int (*common)(struct ResampleContext *c, void *dst,
+                  const void *src, int n, int update_ctx);
+    int (*common_multi)(struct ResampleContext *c, uint8_t *const *dst,
+                        const uint8_t *const *src, int nb_channels,
+                        int n, int update_ctx);
+
     switch(c->format){
     case AV_SAMPLE_FMT_S16P:
         c->dsp.resample_one = resample_one_int16;
         c->dsp.resample_common = resample_common_int16;
         c->dsp.resample_linear = resample_linear_int16;
+        c->dsp.resample_common_multi = resample_common_multi_int16;
         break;
     case AV_SAMPLE_FMT_S32P:
         c->dsp.resample_one = resample_one_int32;
         c->dsp.resample_common = resample_common_int32;
         c->dsp.resample_linear = resample_linear_int32;
+        c->dsp.resample_common_multi = resample_common_multi_int32;
         break;
     case AV_SAMPLE_FMT_FLTP:
         c->dsp.resample_one = resample_one_float;
         c->dsp.resample_common = resample_common_float;
         c->dsp.resample_linear = resample_linear_float;
+        c->dsp.resample_common_multi = resample_common_multi_float;
         break;
     case AV_SAMPLE_FMT_DBLP:
         c->dsp.resample_one = resample_one_double;
         c->dsp.resample_common = resample_common_double;
         c->dsp.resample_linear = resample_linear_double;
+        c->dsp.resample_common_multi = resample_common_multi_double;
         break;
     }
 
+    common       = c->dsp.resample_common;
+    common_multi = c->dsp.resample_common_multi;
+
 #if ARCH_X86
     swri_resample_dsp_x86_init(c);
 #elif ARCH_ARM
@@ -75,4 +88,8 @@ void swri_resample_dsp_init(ResampleContext *c)
 #elif ARCH_AARCH64
     swri_resample_dsp_aarch64_init(c);
 #endif
+
+    /* the multichannel C function only wins over the C per channel one */
+    if (c->dsp.resample_common != common && c->dsp.resample_common_multi == common_multi)
+        c->dsp.resample_common_multi = NULL;
 }
@@ -200,6 +200,90 @@ static int RENAME(resample_linear)(ResampleContext *c,
     return sample_index;
 }
 
+static int RENAME(resample_common_multi)(ResampleContext *c,
+                                         uint8_t *const *dest,
+                                         const uint8_t *const *source,
+                                         int nb_channels, int n, int update_ctx)
+{
+    int dst_index;
+    int index= c->index;
+    int frac= c->frac;
+    int sample_index = 0;
+
+    while (index >= c->phase_count) {
+        sample_index++;
+        index -= c->phase_count;
+    }
+
+    for (dst_index = 0; dst_index < n; dst_index++) {
+        FELEM *filter = ((FELEM *) c->filter_bank) + c->filter_alloc * index;
+        int ch, i;
+
+        /* apply each filter phase to several channels at once, the sums are
+         * split like in resample_common() to give the same results */
+        for (ch = 0; ch + 1 < nb_channels; ch += 2) {
+            const DELEM *src0 = (const DELEM *)source[ch    ] + sample_index;
+            const DELEM *src1 = (const DELEM *)source[ch + 1] + sample_index;
+            FELEM2 val0 = FOFFSET, val0b = 0;
+            FELEM2 val1 = FOFFSET, val1b = 0;
+
+            for (i = 0; i + 1 < c->filter_length; i+=2) {
+                FELEM2 f0 = filter[i], f1 = filter[i + 1];
+                val0  += src0[i    ] * f0;
+                val1  += src1[i    ] * f0;
+                val0b += src0[i + 1] * f1;
+                val1b += src1[i + 1] * f1;
+            }
+            if (i < c->filter_length) {
+                val0  += src0[i] * (FELEM2)filter[i];
+                val1  += src1[i] * (FELEM2)filter[i];
+            }
+#ifdef FELEML
+            OUT(((DELEM *)dest[ch    ])[dst_index], val0 + (FELEML)val0b);
+            OUT(((DELEM *)dest[ch + 1])[dst_index], val1 + (FELEML)val1b);
+#else
+            OUT(((DELEM *)dest[ch    ])[dst_index], val0 + val0b);
+            OUT(((DELEM *)dest[ch + 1])[dst_index], val1 + val1b);
+#endif
+        }
+        if (ch < nb_channels) {
+            const DELEM *src = (const DELEM *)source[ch] + sample_index;
+            FELEM2 val = FOFFSET, val2 = 0;
+
+            for (i = 0; i + 1 < c->filter_length; i+=2) {
+                val  += src[i    ] * (FELEM2)filter[i    ];
+                val2 += src[i + 1] * (FELEM2)filter[i + 1];
+            }
+            if (i < c->filter_length)
+                val  += src[i    ] * (FELEM2)filter[i    ];
+#ifdef FELEML
+            OUT(((DELEM *)dest[ch])[dst_index], val + (FELEML)val2);
+#else
+            OUT(((DELEM *)dest[ch])[dst_index], val + val2);
+#endif
+        }
+
+        frac  += c->dst_incr_mod;
+        index += c->dst_incr_div;
+        if (frac >= c->src_incr) {
+            frac -= c->src_incr;
+            index++;
+        }
+
+        while (index >= c->phase_count) {
+            sample_index++;
+            index -= c->phase_count;
+        }
+    }
+
+    if(update_ctx){
+        c->frac= frac;
+        c->index= index;
+    }
+
+    return sample_index;
+}
+
 #undef RENAME
 #undef FILTER_SHIFT
 #undef DELEM
@@ -113,6 +113,8 @@ static void clear_context(SwrContext *s){
     swri_audio_convert_free(&s->out_convert);
     swri_audio_convert_free(&s->full_convert);
     swri_rematrix_free(s);
+    avpriv_slicethread_free(&s->slicethread);
+    s->nb_threads = 1;
 
     s->delayed_samples_fixup = 0;
     s->flushed = 0;
@@ -137,6 +139,50 @@ av_cold void swr_close(SwrContext *s){
     clear_context(s);
 }
 
+static void thread_worker(void *priv, int jobnr, int threadnr,
+                          int nb_jobs, int nb_threads)
+{
+    SwrContext *s = priv;
+
+    s->job_func(s->job_arg, jobnr, nb_jobs);
+}
+
+void swri_execute(SwrContext *s, swri_job_func func, void *arg, int nb_jobs)
+{
+    int i;
+
+    if (!s->slicethread) {
+        for (i = 0; i < nb_jobs; i++)
+            func(arg, i, nb_jobs);
+        return;
+    }
+
+    s->job_func = func;
+    s->job_arg  = arg;
+    avpriv_slicethread_execute(s->slicethread, nb_jobs, 0);
+}
+
+static av_cold int init_threads(SwrContext *s)
+{
+    int ret;
+
+    if (s->threads != 1) {
+        ret = avpriv_slicethread_create(&s->slicethread, s, thread_worker,
+                                        NULL, s->threads);
+        if (ret < 0 && ret != AVERROR(ENOSYS))
+            return ret;
+        if (ret > 1)
+            s->nb_threads = ret;
+        else
+            avpriv_slicethread_free(&s->slicethread);
+    }
+
+    if (s->resample && s->engine == SWR_ENGINE_SWR)
+        swri_resample_set_threads(s->resample, s->slicethread ? s : NULL);
+
+    return 0;
+}
+
 av_cold int swr_init(struct SwrContext *s){
     int ret;
     char l1[1024], l2[1024];
@@ -343,6 +389,9 @@ av_assert0(s->out.ch_count);
         return 0;
     }
 
+    if ((ret = init_threads(s)) < 0)
+        goto fail;
+
     s->in_convert = swri_audio_convert_alloc(s->int_sample_fmt,
                                              s-> in_sample_fmt, s->used_ch_layout.nb_channels, s->channel_map, 0);
     s->out_convert= swri_audio_convert_alloc(s->out_sample_fmt,
@@ -23,6 +23,7 @@
 
 #include "swresample.h"
 #include "libavutil/channel_layout.h"
+#include "libavutil/slicethread.h"
 #include "config.h"
 
 #define SWR_CH_MAX 64
@@ -68,6 +69,8 @@ struct DitherContext {
     int output_sample_bits;                         ///< the number of used output bits, needed to scale dither correctly
 };
 
+typedef void (* swri_job_func)(void *arg, int jobnr, int nb_jobs);
+
 typedef struct ResampleContext * (* resample_init_func)(struct ResampleContext *c, int out_rate, int in_rate, int filter_size, int phase_shift, int linear,
                                     double cutoff, enum AVSampleFormat format, enum SwrFilterType filter_type, double kaiser_beta, double precision, int cheby, int exact_rational);
 typedef void    (* resample_free_func)(struct ResampleContext **c);
@@ -182,12 +185,26 @@ struct SwrContext {
 
     mix_any_func_type *mix_any_f;
 
+    int threads;                                    ///< number of threads requested by the user, 0 for automatic
+    int nb_threads;                                 ///< number of threads the channels are split across
+    AVSliceThread *slicethread;
+    swri_job_func job_func;                         ///< function run by the slice threads
+    void *job_arg;
+
     /* TODO: callbacks for ASM optimizations */
 };
 
 av_warn_unused_result
 int swri_realloc_audio(AudioData *a, int count);
 
+/**
+ * Run func for nb_jobs jobs on the slice threads of s, or on the calling
+ * thread if s is not threaded, and wait for all of them to finish.
+ */
+void swri_execute(SwrContext *s, swri_job_func func, void *arg, int nb_jobs);
+
+void swri_resample_set_threads(struct ResampleContext *c, SwrContext *s);
+
 void swri_noise_shaping_int16 (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
 void swri_noise_shaping_int32 (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
 void swri_noise_shaping_float (SwrContext *s, AudioData *dsts, const AudioData *srcs, const AudioData *noises, int count);
@@ -0,0 +1,193 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Check that resampling many channels at once, with and without threads,
+ * gives the same output as a mono conversion: every channel carries the same
+ * signal, so each of them must match it exactly. With -bench, the throughput
+ * for growing channel counts is measured as well.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/mathematics.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/samplefmt.h"
+#include "libavutil/time.h"
+
+#include "libswresample/swresample.h"
+
+#define IN_RATE   48000
+#define OUT_RATE  44100
+#define RUNS      3
+#define THREADS   4
+
+static const int channel_counts[] = { 1, 2, 6, 16, 32, 64 };
+
+static const enum AVSampleFormat sample_fmts[] = {
+    AV_SAMPLE_FMT_S16P, AV_SAMPLE_FMT_FLTP, AV_SAMPLE_FMT_DBLP,
+};
+
+static void fill(uint8_t *data, enum AVSampleFormat fmt, int nb_samples)
+{
+    int i;
+
+    for (i = 0; i < nb_samples; i++) {
+        double v = 0.4 * sin(i * 2 * M_PI * 440 / IN_RATE) +
+                   0.3 * sin(i * 2 * M_PI * 9000 / IN_RATE);
+        switch (fmt) {
+        case AV_SAMPLE_FMT_S16P: ((int16_t *)data)[i] = lrint(v * 32767); break;
+        case AV_SAMPLE_FMT_FLTP: ((float   *)data)[i] = v;                break;
+        case AV_SAMPLE_FMT_DBLP: ((double  *)data)[i] = v;                break;
+        }
+    }
+}
+
+static double get(const uint8_t *data, enum AVSampleFormat fmt, int i)
+{
+    switch (fmt) {
+    case AV_SAMPLE_FMT_S16P: return ((const int16_t *)data)[i] / 32767.0;
+    case AV_SAMPLE_FMT_FLTP: return ((const float   *)data)[i];
+    default:                 return ((const double  *)data)[i];
+    }
+}
+
+/* returns the number of output samples, the output of the first channel is
+ * left in ref if it is not NULL, otherwise it is compared with it */
+static int convert(enum AVSampleFormat fmt, int nb_channels, int linear, int threads,
+                   int in_samples, uint8_t **ref, double *max_diff, int64_t *time)
+{
+    const int out_samples = av_rescale_rnd(in_samples, OUT_RATE, IN_RATE, AV_ROUND_UP) + 64;
+    AVChannelLayout layout;
+    SwrContext *swr = NULL;
+    uint8_t **in = NULL, **out = NULL;
+    int64_t start;
+    int ch, i, ret;
+
+    av_channel_layout_default(&layout, nb_channels);
+    ret = swr_alloc_set_opts2(&swr, &layout, fmt, OUT_RATE, &layout, fmt, IN_RATE, 0, NULL);
+    if (ret < 0)
+        goto end;
+    av_opt_set_sample_fmt(swr, "internal_sample_fmt", fmt, 0);
+    av_opt_set_int(swr, "linear_interp", linear, 0);
+    /* otherwise the interpolation is not needed for these rates */
+    av_opt_set_int(swr, "exact_rational", !linear, 0);
+    av_opt_set_int(swr, "threads", threads, 0);
+    if ((ret = swr_init(swr)) < 0)
+        goto end;
+
+    ret = AVERROR(ENOMEM);
+    in  = av_calloc(nb_channels, sizeof(*in));
+    out = av_calloc(nb_channels, sizeof(*out));
+    if (!in || !out ||
+        av_samples_alloc(in,  NULL, nb_channels, in_samples,  fmt, 0) < 0 ||
+        av_samples_alloc(out, NULL, nb_channels, out_samples, fmt, 0) < 0)
+        goto end;
+    for (ch = 0; ch < nb_channels; ch++)
+        fill(in[ch], fmt, in_samples);
+
+    start = av_gettime_relative();
+    ret = swr_convert(swr, out, out_samples, (const uint8_t **)in, in_samples);
+    *time = av_gettime_relative() - start;
+    if (ret < 0)
+        goto end;
+
+    if (!*ref) {
+        *ref = av_memdup(out[0], ret * av_get_bytes_per_sample(fmt));
+        if (!*ref)
+            ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    *max_diff = 0;
+    for (ch = 0; ch < nb_channels; ch++)
+        for (i = 0; i < ret; i++)
+            *max_diff = FFMAX(*max_diff, fabs(get(out[ch], fmt, i) - get(*ref, fmt, i)));
+
+end:
+    if (in)
+        av_freep(&in[0]);
+    if (out)
+        av_freep(&out[0]);
+    av_freep(&in);
+    av_freep(&out);
+    swr_free(&swr);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    int bench = argc > 1 && !strcmp(argv[1], "-bench");
+    /* a quarter of a second is enough to cross many filter phases */
+    int in_samples = bench ? IN_RATE * 2 : IN_RATE / 4;
+    int f, i, linear, threads, ret = 0;
+
+    for (linear = 0; linear < 2; linear++) {
+        for (f = 0; f < FF_ARRAY_ELEMS(sample_fmts); f++) {
+            enum AVSampleFormat fmt = sample_fmts[f];
+            uint8_t *ref = NULL;
+            double diff = 0;
+            int64_t time;
+
+            if (convert(fmt, 1, linear, 1, in_samples, &ref, &diff, &time) < 0) {
+                fprintf(stderr, "Failed to resample %s\n", av_get_sample_fmt_name(fmt));
+                return 1;
+            }
+
+            for (i = 0; i < FF_ARRAY_ELEMS(channel_counts); i++) {
+            for (threads = 1; threads <= THREADS; threads += THREADS - 1) {
+                const int nb_channels = channel_counts[i];
+                int64_t best = INT64_MAX;
+                int run;
+
+                /* the fastest run is the least disturbed by the system */
+                for (run = 0; run < (bench ? RUNS : 1); run++) {
+                    if (convert(fmt, nb_channels, linear, threads, in_samples,
+                                &ref, &diff, &time) < 0) {
+                        fprintf(stderr, "Failed to resample %s with %d channels\n",
+                                av_get_sample_fmt_name(fmt), nb_channels);
+                        av_free(ref);
+                        return 1;
+                    }
+                    best = FFMIN(best, time);
+                }
+
+                printf("%s %s %2d channels %d threads: max diff %g\n",
+                       linear ? "linear" : "common", av_get_sample_fmt_name(fmt),
+                       nb_channels, threads, diff);
+                if (bench) {
+                    double rate = (double)in_samples * nb_channels / FFMAX(best, 1);
+                    printf("    %7.2f Msamples/s, %6.2f per channel\n",
+                           rate, rate / nb_channels);
+                }
+                /* all channels are resampled with the same filters and
+                 * summed in the same order as a single one */
+                ret |= diff != 0;
+            }
+            }
+            av_free(ref);
+        }
+    }
+
+    return ret;
+}
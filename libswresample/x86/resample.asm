@@ -578,6 +578,154 @@ cglobal resample_linear_%1, 1, 7, 5, ctx, min_filter_length_x4, filter2, \
     RET
 %endmacro
 
+;-----------------------------------------------------------------------------
+; int resample_common_x4_float(ResampleContext *ctx, float **dst,
+;                              const float **src, int size, int update_ctx)
+;
+; resample_common_float() for 4 channels at once, each filter phase is
+; loaded once and applied to all of them
+;-----------------------------------------------------------------------------
+%if ARCH_X86_64
+%macro RESAMPLE_X4_FNS 0
+cglobal resample_common_x4_float, 0, 14, 6, ctx, dst, src0, consumed, src1, src2, src3, \
+                                            filter, count, index, frac, dst_idx, dst_end, tmp
+%if WIN64
+%define update_context_stackd r4m
+%else ; unix64
+%define update_context_stackd [rsp-0x8]
+    mov        update_context_stackd, r4d
+%endif
+    mov                    dst_endd, r3d
+    shl                    dst_endq, 2
+    mov                       src1q, [src0q+gprsize*1]
+    mov                       src2q, [src0q+gprsize*2]
+    mov                       src3q, [src0q+gprsize*3]
+    mov                       src0q, [src0q]
+
+    ; point the sources past the filter length, so the taps can be indexed
+    ; with a negative counter
+    mov                      countd, [ctxq+ResampleContext.filter_length]
+    shl                      countq, 2
+    add                       src0q, countq
+    add                       src1q, countq
+    add                       src2q, countq
+    add                       src3q, countq
+
+    mov                      indexd, [ctxq+ResampleContext.index]
+    mov                       fracd, [ctxq+ResampleContext.frac]
+    xor                   consumedd, consumedd
+    xor                    dst_idxd, dst_idxd
+    jmp .index_check
+
+.loop:
+    mov                     filterd, [ctxq+ResampleContext.filter_alloc]
+    imul                    filterd, indexd
+    shl                     filterq, 2
+    add                     filterq, [ctxq+ResampleContext.filter_bank]
+    mov                      countd, [ctxq+ResampleContext.filter_length]
+    shl                      countq, 2
+    add                     filterq, countq
+    neg                      countq
+    xorps                        m0, m0, m0
+    xorps                        m1, m1, m1
+    xorps                        m2, m2, m2
+    xorps                        m3, m3, m3
+
+    align 16
+.inner_loop:
+    movu                         m4, [filterq+countq]
+%if cpuflag(fma3)
+    fmaddps                      m0, m4, [src0q+countq], m0
+    fmaddps                      m1, m4, [src1q+countq], m1
+    fmaddps                      m2, m4, [src2q+countq], m2
+    fmaddps                      m3, m4, [src3q+countq], m3
+%else
+    mulps                        m5, m4, [src0q+countq]
+    addps                        m0, m0, m5
+    mulps                        m5, m4, [src1q+countq]
+    addps                        m1, m1, m5
+    mulps                        m5, m4, [src2q+countq]
+    addps                        m2, m2, m5
+    mulps                        m5, m4, [src3q+countq]
+    addps                        m3, m3, m5
+%endif
+    add                      countq, mmsize
+    js .inner_loop
+
+    ; horizontal sums of the 4 channels & store, adding the elements in the
+    ; same order as resample_common_float(): the upper half onto the lower
+    ; one, then (0 + 2) + (1 + 3)
+%if mmsize == 32
+    vextractf128                xm4, m0, 0x1
+    vextractf128                xm5, m1, 0x1
+    addps                       xm0, xm0, xm4
+    addps                       xm1, xm1, xm5
+    vextractf128                xm4, m2, 0x1
+    vextractf128                xm5, m3, 0x1
+    addps                       xm2, xm2, xm4
+    addps                       xm3, xm3, xm5
+%endif
+    unpcklpd                    xm4, xm0, xm1
+    unpckhpd                    xm0, xm0, xm1
+    addps                       xm0, xm0, xm4
+    unpcklpd                    xm4, xm2, xm3
+    unpckhpd                    xm2, xm2, xm3
+    addps                       xm2, xm2, xm4
+    haddps                      xm0, xm0, xm2
+    mov                        tmpq, [dstq]
+    movss           [tmpq+dst_idxq], xm0
+    mov                        tmpq, [dstq+gprsize*1]
+    extractps       [tmpq+dst_idxq], xm0, 1
+    mov                        tmpq, [dstq+gprsize*2]
+    extractps       [tmpq+dst_idxq], xm0, 2
+    mov                        tmpq, [dstq+gprsize*3]
+    extractps       [tmpq+dst_idxq], xm0, 3
+
+    add                       fracd, [ctxq+ResampleContext.dst_incr_mod]
+    add                      indexd, [ctxq+ResampleContext.dst_incr_div]
+    cmp                       fracd, [ctxq+ResampleContext.src_incr]
+    jl .skip
+    sub                       fracd, [ctxq+ResampleContext.src_incr]
+    inc                      indexd
+
+.skip:
+    add                    dst_idxq, 4
+.index_check:
+    cmp                      indexd, [ctxq+ResampleContext.phase_count]
+    jb .index_skip
+.index_while:
+    sub                      indexd, [ctxq+ResampleContext.phase_count]
+    add                       src0q, 4
+    add                       src1q, 4
+    add                       src2q, 4
+    add                       src3q, 4
+    inc                   consumedd
+    cmp                      indexd, [ctxq+ResampleContext.phase_count]
+    jnb .index_while
+.index_skip:
+    cmp                    dst_idxq, dst_endq
+    jne .loop
+
+    cmp  dword update_context_stackd, 0
+    jz .skip_store
+    mov [ctxq+ResampleContext.frac ], fracd
+    mov [ctxq+ResampleContext.index], indexd
+
+.skip_store:
+    mov                          eax, consumedd
+    RET
+%endmacro
+
+%if HAVE_AVX_EXTERNAL
+INIT_YMM avx
+RESAMPLE_X4_FNS
+%endif
+%if HAVE_FMA3_EXTERNAL
+INIT_YMM fma3
+RESAMPLE_X4_FNS
+%endif
+%endif ; ARCH_X86_64
+
 INIT_XMM sse
 RESAMPLE_FNS float, 4, 2, s, pf_1
 
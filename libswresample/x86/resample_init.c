@@ -45,6 +45,31 @@ RESAMPLE_FUNCS(double, sse2);
 RESAMPLE_FUNCS(double, avx);
 RESAMPLE_FUNCS(double, fma3);
 
+/* resample_common() of 4 channels at once, the others one by one */
+#define RESAMPLE_MULTI_FUNCS(type, opt) \
+int ff_resample_common_x4_##type##_##opt(ResampleContext *c, void *const *dst, \
+                                         const void *const *src, int sz, int upd); \
+static int resample_common_multi_##type##_##opt(ResampleContext *c, \
+                                                uint8_t *const *dst, \
+                                                const uint8_t *const *src, \
+                                                int nb_channels, int sz, int upd) \
+{ \
+    int ch, ret = 0; \
+    for (ch = 0; ch + 4 <= nb_channels; ch += 4) \
+        ret = ff_resample_common_x4_##type##_##opt(c, (void *const *)dst + ch, \
+                                                   (const void *const *)src + ch, \
+                                                   sz, upd && ch + 4 == nb_channels); \
+    for (; ch < nb_channels; ch++) \
+        ret = ff_resample_common_##type##_##opt(c, dst[ch], src[ch], sz, \
+                                                upd && ch + 1 == nb_channels); \
+    return ret; \
+}
+
+#if ARCH_X86_64
+RESAMPLE_MULTI_FUNCS(float, avx)
+RESAMPLE_MULTI_FUNCS(float, fma3)
+#endif
+
 av_cold void swri_resample_dsp_x86_init(ResampleContext *c)
 {
     int av_unused mm_flags = av_get_cpu_flags();
@@ -68,14 +93,22 @@ av_cold void swri_resample_dsp_x86_init(ResampleContext *c)
         if (EXTERNAL_AVX_FAST(mm_flags)) {
             c->dsp.resample_linear = ff_resample_linear_float_avx;
             c->dsp.resample_common = ff_resample_common_float_avx;
+#if ARCH_X86_64
+            c->dsp.resample_common_multi = resample_common_multi_float_avx;
+#endif
         }
         if (EXTERNAL_FMA3_FAST(mm_flags)) {
             c->dsp.resample_linear = ff_resample_linear_float_fma3;
             c->dsp.resample_common = ff_resample_common_float_fma3;
+#if ARCH_X86_64
+            c->dsp.resample_common_multi = resample_common_multi_float_fma3;
+#endif
         }
         if (EXTERNAL_FMA4(mm_flags)) {
             c->dsp.resample_linear = ff_resample_linear_float_fma4;
             c->dsp.resample_common = ff_resample_common_float_fma4;
+            /* the x4 kernels must sum like the single channel one */
+            c->dsp.resample_common_multi = NULL;
         }
         break;
     case AV_SAMPLE_FMT_DBLP:
@@ -18,56 +18,222 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include "libavutil/intreadwrite.h"
 #include "libavutil/mem.h"
+#include "libavutil/pixdesc.h"
 #include "swscale_internal.h"
 
-typedef struct GammaContext
+/* planes of the planar RGB working format are G, B, R, A */
+static const int linear_comp[4] = { 1, 2, 0, 3 };
+
+typedef struct LinearContext
 {
-    uint16_t *table;
-} GammaContext;
+    const AVPixFmtDescriptor *fmt;
+    const uint16_t *table;
+    uint16_t *buf;
+} LinearContext;
 
-// gamma_convert expects 16 bit rgb format
-// it writes directly in src slice thus it must be modifiable (done through cascade context)
-static int gamma_convert(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int sliceH)
+int ff_sws_linear_supported(enum AVPixelFormat fmt)
 {
-    GammaContext *instance = desc->instance;
-    uint16_t *table = instance->table;
-    int srcW = desc->src->width;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmt);
+    const int planar = desc->flags & AV_PIX_FMT_FLAG_PLANAR;
+    int i;
+
+    if (!(desc->flags & AV_PIX_FMT_FLAG_RGB) || desc->nb_components < 3 ||
+        desc->flags & (AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_BITSTREAM |
+                       AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_FLOAT))
+        return 0;
+
+    for (i = 0; i < desc->nb_components; i++) {
+        const AVComponentDescriptor *comp = &desc->comp[i];
+        const int bytes = comp->depth > 8 ? 2 : 1;
+
+        if (comp->shift || comp->depth < 8 || comp->depth != desc->comp[0].depth)
+            return 0;
+        /* packed formats are only handled with byte aligned samples and no
+         * padding, which would otherwise be left unwritten */
+        if (!planar && (comp->depth != 8 * bytes ||
+                        comp->step != desc->nb_components * bytes))
+            return 0;
+    }
+
+    return 1;
+}
 
+void ff_sws_linear_planes(enum AVPixelFormat fmt, const uint8_t *planes[4],
+                          int strides[4], const uint8_t * const data[],
+                          const int linesizes[])
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmt);
     int i;
-    for (i = 0; i < sliceH; ++i) {
-        uint8_t ** src = desc->src->plane[0].line;
-        int src_pos = sliceY+i - desc->src->plane[0].sliceY;
-
-        uint16_t *src1 = (uint16_t*)*(src+src_pos);
-        int j;
-        for (j = 0; j < srcW; ++j) {
-            uint16_t r = AV_RL16(src1 + j*4 + 0);
-            uint16_t g = AV_RL16(src1 + j*4 + 1);
-            uint16_t b = AV_RL16(src1 + j*4 + 2);
-
-            AV_WL16(src1 + j*4 + 0, table[r]);
-            AV_WL16(src1 + j*4 + 1, table[g]);
-            AV_WL16(src1 + j*4 + 2, table[b]);
+
+    for (i = 0; i < 4; i++) {
+        const int plane = desc->flags & AV_PIX_FMT_FLAG_PLANAR ? i : 0;
+
+        if (i == 3 && !(desc->flags & AV_PIX_FMT_FLAG_ALPHA)) {
+            planes[i]  = NULL;
+            strides[i] = 0;
+        } else {
+            planes[i]  = data[plane];
+            strides[i] = linesizes[plane];
         }
+    }
+}
+
+static void linearize_line(uint16_t *dst, const uint8_t *src, int step,
+                           int width, int depth, int be, const uint16_t *table)
+{
+    const int mask = (1 << depth) - 1;
+    int i;
+
+    if (depth == 8) {
+        for (i = 0; i < width; i++)
+            dst[i] = table[src[i * step]];
+    } else if (be) {
+        for (i = 0; i < width; i++)
+            dst[i] = table[AV_RB16(src + i * step) & mask];
+    } else {
+        for (i = 0; i < width; i++)
+            dst[i] = table[AV_RL16(src + i * step) & mask];
+    }
+}
+
+static void expand_alpha_line(uint16_t *dst, const uint8_t *src, int step,
+                              int width, int depth, int be)
+{
+    int i;
 
+    for (i = 0; i < width; i++) {
+        unsigned a = depth == 8 ? src[i * step] :
+                     be ? AV_RB16(src + i * step) : AV_RL16(src + i * step);
+        dst[i] = (a << (16 - depth)) | (a >> (2 * depth - 16));
     }
+}
+
+static int linear_input(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int sliceH)
+{
+    LinearContext *instance = desc->instance;
+    const AVPixFmtDescriptor *fmt = instance->fmt;
+    const int be = !!(fmt->flags & AV_PIX_FMT_FLAG_BE);
+    const int srcW = desc->src->width;
+    const int nb_planes = desc->alpha ? 4 : 3;
+    int i, p;
+
+    for (p = 0; p < 4; p++) {
+        desc->dst->plane[p].sliceY = sliceY;
+        desc->dst->plane[p].sliceH = sliceH;
+    }
+
+    for (i = 0; i < sliceH; i++) {
+        for (p = 0; p < nb_planes; p++) {
+            const AVComponentDescriptor *comp = &fmt->comp[linear_comp[p]];
+            const SwsPlane *plane = &desc->src->plane[comp->plane];
+            const uint8_t *src = plane->line[sliceY + i - plane->sliceY] + comp->offset;
+            uint16_t *dst = (uint16_t *)desc->dst->plane[p].line[i];
+
+            if (p == 3)
+                expand_alpha_line(dst, src, comp->step, srcW, comp->depth, be);
+            else
+                linearize_line(dst, src, comp->step, srcW, comp->depth, be,
+                               instance->table);
+        }
+    }
+
     return sliceH;
 }
 
+static int linear_output(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int sliceH)
+{
+    LinearContext *instance = desc->instance;
+    const AVPixFmtDescriptor *fmt = instance->fmt;
+    const uint16_t *table = instance->table;
+    const int be = !!(fmt->flags & AV_PIX_FMT_FLAG_BE);
+    const int has_alpha = !!(fmt->flags & AV_PIX_FMT_FLAG_ALPHA);
+    const int dstW = desc->dst->width;
+    int i, p, x;
+
+    for (i = 0; i < sliceH; i++) {
+        for (p = 0; p < 3 + has_alpha; p++) {
+            const AVComponentDescriptor *comp = &fmt->comp[linear_comp[p]];
+            const SwsPlane *plane = &desc->dst->plane[comp->plane];
+            const uint16_t *src = (const uint16_t *)desc->src->plane[p].line[sliceY + i];
+            uint8_t *dst = plane->line[sliceY + i - plane->sliceY] + comp->offset;
+            const int step = comp->step, depth = comp->depth;
+
+            if (p == 3) {
+                const unsigned max = (1 << depth) - 1;
+
+                for (x = 0; x < dstW; x++) {
+                    const unsigned a = desc->alpha ? src[x] >> (16 - depth) : max;
+
+                    if (depth == 8)
+                        dst[x * step] = a;
+                    else if (be)
+                        AV_WB16(dst + x * step, a);
+                    else
+                        AV_WL16(dst + x * step, a);
+                }
+            } else if (depth == 8) {
+                for (x = 0; x < dstW; x++)
+                    dst[x * step] = table[src[x]];
+            } else if (be) {
+                for (x = 0; x < dstW; x++)
+                    AV_WB16(dst + x * step, table[src[x]]);
+            } else {
+                for (x = 0; x < dstW; x++)
+                    AV_WL16(dst + x * step, table[src[x]]);
+            }
+        }
+    }
+
+    return sliceH;
+}
 
-int ff_init_gamma_convert(SwsFilterDescriptor *desc, SwsSlice * src, uint16_t *table)
+int ff_init_linear_input(SwsFilterDescriptor *desc, SwsSlice *src, SwsSlice *dst,
+                         enum AVPixelFormat fmt, const uint16_t *table, int alpha)
 {
-    GammaContext *li = av_malloc(sizeof(GammaContext));
+    LinearContext *li = av_mallocz(sizeof(LinearContext));
     if (!li)
         return AVERROR(ENOMEM);
+    li->fmt   = av_pix_fmt_desc_get(fmt);
     li->table = table;
 
     desc->instance = li;
+    desc->alpha = alpha;
     desc->src = src;
-    desc->dst = NULL;
-    desc->process = &gamma_convert;
+    desc->dst = dst;
+    desc->process = &linear_input;
 
     return 0;
 }
 
+int ff_init_linear_output(SwsFilterDescriptor *desc, SwsSlice *src, SwsSlice *dst,
+                          enum AVPixelFormat fmt, const uint16_t *table, int alpha)
+{
+    /* the vertical scaler writes one line at a time, which is converted
+     * right away, so every line of src shares the same buffer */
+    const size_t line_size = FFALIGN(src->width * sizeof(uint16_t) + 64, 64);
+    LinearContext *li = av_mallocz(sizeof(LinearContext) + 4 * line_size + 64);
+    int i, j;
+
+    if (!li)
+        return AVERROR(ENOMEM);
+    li->fmt   = av_pix_fmt_desc_get(fmt);
+    li->table = table;
+    li->buf   = (uint16_t *)FFALIGN((uintptr_t)(li + 1), 64);
+
+    for (i = 0; i < 4; i++) {
+        for (j = 0; j < src->plane[i].available_lines; j++)
+            src->plane[i].line[j] = (uint8_t *)li->buf + i * line_size;
+        src->plane[i].sliceY = 0;
+        src->plane[i].sliceH = src->plane[i].available_lines;
+    }
+
+    desc->instance = li;
+    desc->alpha = alpha;
+    desc->src = src;
+    desc->dst = dst;
+    desc->process = &linear_output;
+
+    return 0;
+}
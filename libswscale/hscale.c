@@ -18,6 +18,8 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <string.h>
+
 #include "libavutil/mem.h"
 #include "swscale_internal.h"
 
@@ -28,6 +30,10 @@ typedef struct FilterContext
     int *filter_pos;
     int filter_size;
     int xInc;
+    /// output pixels [fixed_start, fixed_end) use the coefficients of fixed_start, fixed_step input pixels apart
+    int fixed_start, fixed_end, fixed_step;
+    /// first output pixel of the current tile
+    int x;
 } FilterContext;
 
 /// Color conversion instance data
@@ -36,6 +42,82 @@ typedef struct ColorContext
     uint32_t *pal;
 } ColorContext;
 
+/* shorter runs are left to the generic scaler */
+#define MIN_FIXED_RUN 16
+
+/**
+ * Finds the run of output pixels around the center of the line that share
+ * their coefficients and whose filters are a constant number of input
+ * pixels apart, which for integer ratio scales is the whole line but for
+ * the edges.
+ */
+static void init_fixed_run(FilterContext *f, int dstW)
+{
+    const int size = f->filter_size;
+    const int mid  = dstW / 2;
+    const uint16_t *coeffs = f->filter + mid * size;
+    int start, end, step;
+
+    f->fixed_start = f->fixed_end = 0;
+    if (dstW < 2 * MIN_FIXED_RUN)
+        return;
+
+    step = f->filter_pos[mid + 1] - f->filter_pos[mid];
+    /* only exact integer ratios have a single phase */
+    if (step <= 0 || f->xInc != step << 16)
+        return;
+
+#define SAME_PHASE(i) (f->filter_pos[i] == f->filter_pos[mid] + ((i) - mid) * step && \
+                       !memcmp(f->filter + (i) * size, coeffs, size * sizeof(*coeffs)))
+    for (start = mid; start > 0 && SAME_PHASE(start - 1); start--)
+        ;
+    for (end = mid + 1; end < dstW && SAME_PHASE(end); end++)
+        ;
+#undef SAME_PHASE
+
+    if (end - start < MIN_FIXED_RUN)
+        return;
+    f->fixed_start = start;
+    f->fixed_end   = end;
+    f->fixed_step  = step;
+}
+
+/**
+ * Scales one line with the generic scaler, or with the fixed phase scaler
+ * on the part of it that is covered by the fixed run.
+ */
+static void h_scale(SwsContext *c, const FilterContext *f,
+                    void (*scale)(SwsContext *c, int16_t *dst, int dstW,
+                                  const uint8_t *src, const int16_t *filter,
+                                  const int32_t *filterPos, int filterSize),
+                    void (*scale_fixed)(SwsContext *c, int16_t *dst, int dstW,
+                                        const uint8_t *src, const int16_t *filter,
+                                        int srcPos, int srcStep, int filterSize),
+                    int16_t *dst, int dstW, const uint8_t *src)
+{
+    const int16_t *filter = (const int16_t *)f->filter;
+    const int size = f->filter_size;
+    const int bpp  = c->dstBpc > 14 ? 4 : 2;
+    int start, end;
+
+    if (!scale_fixed || f->fixed_end <= f->fixed_start) {
+        scale(c, dst, dstW, src, filter, f->filter_pos, size);
+        return;
+    }
+
+    start = av_clip(f->fixed_start - f->x, 0, dstW);
+    end   = av_clip(f->fixed_end   - f->x, start, dstW);
+
+    if (start > 0)
+        scale(c, dst, start, src, filter, f->filter_pos, size);
+    if (end > start)
+        scale_fixed(c, (int16_t *)((uint8_t *)dst + start * bpp), end - start, src,
+                    filter + start * size, f->filter_pos[start], f->fixed_step, size);
+    if (dstW > end)
+        scale(c, (int16_t *)((uint8_t *)dst + end * bpp), dstW - end, src,
+              filter + end * size, f->filter_pos + end, size);
+}
+
 static int lum_h_scale(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int sliceH)
 {
     FilterContext *instance = desc->instance;
@@ -54,8 +136,8 @@ static int lum_h_scale(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int
         if (c->hyscale_fast) {
             c->hyscale_fast(c, (int16_t*)dst[dst_pos], dstW, src[src_pos], srcW, xInc);
         } else {
-            c->hyScale(c, (int16_t*)dst[dst_pos], dstW, (const uint8_t *)src[src_pos], instance->filter,
-                       instance->filter_pos, instance->filter_size);
+            h_scale(c, instance, c->hyScale, c->hyScaleFixed,
+                    (int16_t*)dst[dst_pos], dstW, (const uint8_t *)src[src_pos]);
         }
 
         if (c->lumConvertRange)
@@ -75,8 +157,8 @@ static int lum_h_scale(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int
             if (c->hyscale_fast) {
                 c->hyscale_fast(c, (int16_t*)dst[dst_pos], dstW, src[src_pos], srcW, xInc);
             } else {
-                c->hyScale(c, (int16_t*)dst[dst_pos], dstW, (const uint8_t *)src[src_pos], instance->filter,
-                            instance->filter_pos, instance->filter_size);
+                h_scale(c, instance, c->hyScale, c->hyScaleFixed,
+                        (int16_t*)dst[dst_pos], dstW, (const uint8_t *)src[src_pos]);
             }
         }
     }
@@ -152,6 +234,8 @@ int ff_init_desc_hscale(SwsFilterDescriptor *desc, SwsSlice *src, SwsSlice *dst,
     li->filter_pos = filter_pos;
     li->filter_size = filter_size;
     li->xInc = xInc;
+    li->x = 0;
+    init_fixed_run(li, dst->width);
 
     desc->instance = li;
 
@@ -187,8 +271,8 @@ static int chr_h_scale(SwsContext *c, SwsFilterDescriptor *desc, int sliceY, int
         if (c->hcscale_fast) {
             c->hcscale_fast(c, (uint16_t*)dst1[dst_pos1+i], (uint16_t*)dst2[dst_pos2+i], dstW, src1[src_pos1+i], src2[src_pos2+i], srcW, xInc);
         } else {
-            c->hcScale(c, (uint16_t*)dst1[dst_pos1+i], dstW, src1[src_pos1+i], instance->filter, instance->filter_pos, instance->filter_size);
-            c->hcScale(c, (uint16_t*)dst2[dst_pos2+i], dstW, src2[src_pos2+i], instance->filter, instance->filter_pos, instance->filter_size);
+            h_scale(c, instance, c->hcScale, c->hcScaleFixed, (int16_t*)dst1[dst_pos1+i], dstW, src1[src_pos1+i]);
+            h_scale(c, instance, c->hcScale, c->hcScaleFixed, (int16_t*)dst2[dst_pos2+i], dstW, src2[src_pos2+i]);
         }
 
         if (c->chrConvertRange)
@@ -258,6 +342,8 @@ int ff_init_desc_chscale(SwsFilterDescriptor *desc, SwsSlice *src, SwsSlice *dst
     li->filter_pos = filter_pos;
     li->filter_size = filter_size;
     li->xInc = xInc;
+    li->x = 0;
+    init_fixed_run(li, AV_CEIL_RSHIFT(dst->width, dst->h_chr_sub_sample));
 
     desc->instance = li;
 
@@ -288,3 +374,21 @@ int ff_init_desc_no_chr(SwsFilterDescriptor *desc, SwsSlice * src, SwsSlice *dst
     desc->process = &no_chr_scale;
     return 0;
 }
+
+void ff_set_desc_hscale_tile(SwsContext *c, const SwsTile *tile)
+{
+    FilterContext *lum = c->desc[c->descIndex[0] - 1].instance;
+    FilterContext *chr = c->desc[c->descIndex[1] - 1].instance;
+    const int x     = tile ? tile->dst_x : 0;
+    const int chr_x = x >> c->chrDstHSubSample;
+
+    lum->filter     = (uint16_t *)c->hLumFilter + x * c->hLumFilterSize;
+    lum->filter_pos = tile ? c->tileLumFilterPos + x : c->hLumFilterPos;
+    lum->x          = x;
+
+    if (c->needs_hcscale) {
+        chr->filter     = (uint16_t *)c->hChrFilter + chr_x * c->hChrFilterSize;
+        chr->filter_pos = tile ? c->tileChrFilterPos + chr_x : c->hChrFilterPos;
+        chr->x          = chr_x;
+    }
+}
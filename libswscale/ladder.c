@@ -0,0 +1,180 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Scaling of one source to several output sizes.
+ *
+ * The rungs are scaled from the largest to the smallest. A rung is scaled
+ * from the smallest rung done before it that has the same format and at
+ * least twice its size in both dimensions, so a 2:1 ladder reads the source
+ * only for its first rung and every following rung reads a picture a
+ * quarter of the size of the one before. Rungs without such a parent are
+ * scaled from the source.
+ */
+
+#include "libavutil/dict.h"
+#include "libavutil/frame.h"
+#include "libavutil/log.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "swscale.h"
+
+typedef struct SwsLadderRung {
+    struct SwsContext *sws;
+    int parent;             ///< rung this one is scaled from, -1 for the source
+} SwsLadderRung;
+
+struct SwsLadder {
+    int nb_rungs;
+    SwsLadderRung *rungs;
+    int *order;             ///< rungs in the order they are scaled
+};
+
+static struct SwsContext *alloc_rung_context(int src_w, int src_h,
+                                             enum AVPixelFormat src_format,
+                                             int dst_w, int dst_h,
+                                             enum AVPixelFormat dst_format,
+                                             const AVDictionary *opts)
+{
+    struct SwsContext *sws = sws_alloc_context();
+    AVDictionary *tmp = NULL;
+    int ret;
+
+    if (!sws)
+        return NULL;
+
+    ret = av_dict_copy(&tmp, opts, 0);
+    if (ret >= 0)
+        ret = av_opt_set_dict(sws, &tmp);
+    if (ret >= 0 && av_dict_count(tmp)) {
+        av_log(sws, AV_LOG_ERROR, "Unknown option '%s'\n",
+               av_dict_iterate(tmp, NULL)->key);
+        ret = AVERROR_OPTION_NOT_FOUND;
+    }
+    av_dict_free(&tmp);
+    if (ret < 0)
+        goto fail;
+
+    av_opt_set_int(sws, "srcw",       src_w,      0);
+    av_opt_set_int(sws, "srch",       src_h,      0);
+    av_opt_set_int(sws, "src_format", src_format, 0);
+    av_opt_set_int(sws, "dstw",       dst_w,      0);
+    av_opt_set_int(sws, "dsth",       dst_h,      0);
+    av_opt_set_int(sws, "dst_format", dst_format, 0);
+
+    if (sws_init_context(sws, NULL, NULL) < 0)
+        goto fail;
+
+    return sws;
+fail:
+    sws_freeContext(sws);
+    return NULL;
+}
+
+SwsLadder *sws_alloc_ladder(int src_w, int src_h, enum AVPixelFormat src_format,
+                            int nb_rungs, const int *dst_w, const int *dst_h,
+                            const enum AVPixelFormat *dst_format,
+                            const AVDictionary *opts)
+{
+    SwsLadder *l;
+    int i, j, n;
+
+    if (nb_rungs <= 0)
+        return NULL;
+
+    l = av_mallocz(sizeof(*l));
+    if (!l)
+        return NULL;
+    l->nb_rungs = nb_rungs;
+    l->rungs    = av_calloc(nb_rungs, sizeof(*l->rungs));
+    l->order    = av_calloc(nb_rungs, sizeof(*l->order));
+    if (!l->rungs || !l->order)
+        goto fail;
+
+    /* largest first, rungs of the same size keep their order */
+    for (n = 0; n < nb_rungs; n++) {
+        const int64_t area = (int64_t)dst_w[n] * dst_h[n];
+
+        for (i = n; i > 0 && (int64_t)dst_w[l->order[i - 1]] * dst_h[l->order[i - 1]] < area; i--)
+            l->order[i] = l->order[i - 1];
+        l->order[i] = n;
+    }
+
+    for (n = 0; n < nb_rungs; n++) {
+        SwsLadderRung *r = &l->rungs[l->order[n]];
+        int w = src_w, h = src_h;
+        enum AVPixelFormat format = src_format;
+
+        i = l->order[n];
+        r->parent = -1;
+        for (int m = 0; m < n; m++) {
+            j = l->order[m];
+            if (dst_format[j] == dst_format[i] &&
+                dst_w[j] >= 2 * dst_w[i] && dst_h[j] >= 2 * dst_h[i] &&
+                (int64_t)dst_w[j] * dst_h[j] < (int64_t)w * h) {
+                r->parent = j;
+                w         = dst_w[j];
+                h         = dst_h[j];
+                format    = dst_format[j];
+            }
+        }
+
+        r->sws = alloc_rung_context(w, h, format, dst_w[i], dst_h[i],
+                                    dst_format[i], opts);
+        if (!r->sws)
+            goto fail;
+        av_log(r->sws, AV_LOG_VERBOSE, "Rung %d (%dx%d) scaled from %s (%dx%d)\n",
+               i, dst_w[i], dst_h[i], r->parent < 0 ? "the source" : "a rung", w, h);
+    }
+
+    return l;
+fail:
+    sws_free_ladder(&l);
+    return NULL;
+}
+
+int sws_ladder_scale_frame(SwsLadder *l, AVFrame **dst, const AVFrame *src)
+{
+    for (int n = 0; n < l->nb_rungs; n++) {
+        const int i = l->order[n];
+        const SwsLadderRung *r = &l->rungs[i];
+        int ret;
+
+        ret = sws_scale_frame(r->sws, dst[i], r->parent < 0 ? src : dst[r->parent]);
+        if (ret < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+void sws_free_ladder(SwsLadder **pl)
+{
+    SwsLadder *l = *pl;
+
+    if (!l)
+        return;
+
+    if (l->rungs)
+        for (int i = 0; i < l->nb_rungs; i++)
+            sws_freeContext(l->rungs[i].sws);
+    av_freep(&l->rungs);
+    av_freep(&l->order);
+    av_freep(pl);
+}
@@ -79,8 +79,12 @@ static const AVOption swscale_options[] = {
     { "uniform_color",   "blend onto a uniform color",    0,                 AV_OPT_TYPE_CONST,  { .i64  = SWS_ALPHA_BLEND_UNIFORM},INT_MIN, INT_MAX,     VE, .unit = "alphablend" },
     { "checkerboard",    "blend onto a checkerboard",     0,                 AV_OPT_TYPE_CONST,  { .i64  = SWS_ALPHA_BLEND_CHECKERBOARD},INT_MIN, INT_MAX,     VE, .unit = "alphablend" },
 
+    { "fused",           "use the fused scaler for planar 4:2:0 conversions", OFFSET(fused), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, VE },
+
     { "threads",         "number of threads",             OFFSET(nb_threads),   AV_OPT_TYPE_INT, {.i64 = 1 }, 0, INT_MAX, VE, .unit = "threads" },
         { "auto",        NULL,                            0,                  AV_OPT_TYPE_CONST, {.i64 = 0 },    .flags = VE, .unit = "threads" },
+    { "tile_width",      "scale in column tiles of this many output pixels", OFFSET(tile_width), AV_OPT_TYPE_INT, {.i64 = 0 }, -1, INT_MAX, VE, .unit = "tile_width" },
+        { "auto",        NULL,                            0,                  AV_OPT_TYPE_CONST, {.i64 = -1 },   .flags = VE, .unit = "tile_width" },
 
     { NULL }
 };
@@ -18,6 +18,7 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include "libavutil/imgutils.h"
 #include "libavutil/mem.h"
 #include "swscale_internal.h"
 
@@ -256,7 +257,7 @@ int ff_init_filters(SwsContext * c)
     int need_lum_conv = c->lumToYV12 || c->readLumPlanar || c->alpToYV12 || c->readAlpPlanar;
     int need_chr_conv = c->chrToYV12 || c->readChrPlanar;
     int need_gamma = c->is_internal_gamma;
-    int srcIdx, dstIdx;
+    int srcIdx, dstIdx, linIdx;
     int dst_stride = FFALIGN(c->dstW * sizeof(int16_t) + 66, 16);
 
     uint32_t * pal = usePal(c->srcFormat) ? c->pal_yuv : (uint32_t*)c->input_rgb2yuv_table;
@@ -278,10 +279,13 @@ int ff_init_filters(SwsContext * c)
     num_ydesc = need_lum_conv ? 2 : 1;
     num_cdesc = need_chr_conv ? 2 : 1;
 
-    c->numSlice = FFMAX(num_ydesc, num_cdesc) + 2;
-    c->numDesc = num_ydesc + num_cdesc + num_vdesc + (need_gamma ? 2 : 0);
+    /* the linear-light scaler linearizes the source separately for the
+     * luma and chroma chains and vertically scales into a line buffer */
+    c->numSlice = FFMAX(num_ydesc, num_cdesc) + 2 + (need_gamma ? 3 : 0);
+    c->numDesc = num_ydesc + num_cdesc + num_vdesc + (need_gamma ? 3 : 0);
     c->descIndex[0] = num_ydesc + (need_gamma ? 1 : 0);
-    c->descIndex[1] = num_ydesc + num_cdesc + (need_gamma ? 1 : 0);
+    c->descIndex[1] = num_ydesc + num_cdesc + (need_gamma ? 2 : 0);
+    linIdx = c->numSlice - 5;
 
     if (isFloat16(c->srcFormat)) {
         c->h2f_tables = av_malloc(sizeof(*c->h2f_tables));
@@ -302,12 +306,27 @@ int ff_init_filters(SwsContext * c)
 
     res = alloc_slice(&c->slice[0], c->srcFormat, c->srcH, c->chrSrcH, c->chrSrcHSubSample, c->chrSrcVSubSample, 0);
     if (res < 0) goto cleanup;
-    for (i = 1; i < c->numSlice-2; ++i) {
+    for (i = 1; i < c->numSlice - 2 - (need_gamma ? 3 : 0); ++i) {
         res = alloc_slice(&c->slice[i], c->srcFormat, lumBufSize, chrBufSize, c->chrSrcHSubSample, c->chrSrcVSubSample, 0);
         if (res < 0) goto cleanup;
         res = alloc_lines(&c->slice[i], FFALIGN(c->srcW*2+78, 16), c->srcW);
         if (res < 0) goto cleanup;
     }
+    if (need_gamma) {
+        // linearized source lines, for the luma and the chroma chain
+        for (; i < linIdx + 2; ++i) {
+            int lines = FFMAX(lumBufSize, chrBufSize);
+            res = alloc_slice(&c->slice[i], c->srcFormat, lines, lines, 0, 0, 0);
+            if (res < 0) goto cleanup;
+            res = alloc_lines(&c->slice[i], FFALIGN(c->srcW*2+78, 16), c->srcW);
+            if (res < 0) goto cleanup;
+        }
+        // vertical scaler output line, lines are set up by the output descriptor
+        res = alloc_slice(&c->slice[i], c->dstFormat, c->dstH, c->chrDstH, 0, 0, 0);
+        if (res < 0) goto cleanup;
+        c->slice[i].width = c->dstW;
+        ++i;
+    }
     // horizontal scaler output
     res = alloc_slice(&c->slice[i], c->srcFormat, lumBufSize, chrBufSize, c->chrDstHSubSample, c->chrDstVSubSample, 1);
     if (res < 0) goto cleanup;
@@ -326,9 +345,11 @@ int ff_init_filters(SwsContext * c)
     dstIdx = 1;
 
     if (need_gamma) {
-        res = ff_init_gamma_convert(c->desc + index, c->slice + srcIdx, c->inv_gamma);
+        res = ff_init_linear_input(&c->desc[index], &c->slice[srcIdx], &c->slice[linIdx],
+                                   c->lin_src_format, c->inv_gamma, c->needAlpha);
         if (res < 0) goto cleanup;
         ++index;
+        srcIdx = linIdx;
     }
 
     if (need_lum_conv) {
@@ -340,7 +361,7 @@ int ff_init_filters(SwsContext * c)
     }
 
 
-    dstIdx = FFMAX(num_ydesc, num_cdesc);
+    dstIdx = c->numSlice - 2;
     res = ff_init_desc_hscale(&c->desc[index], &c->slice[srcIdx], &c->slice[dstIdx], c->hLumFilter, c->hLumFilterPos, c->hLumFilterSize, c->lumXInc);
     if (res < 0) goto cleanup;
     c->desc[index].alpha = c->needAlpha;
@@ -350,6 +371,13 @@ int ff_init_filters(SwsContext * c)
     {
         srcIdx = 0;
         dstIdx = 1;
+        if (need_gamma) {
+            res = ff_init_linear_input(&c->desc[index], &c->slice[srcIdx], &c->slice[linIdx + 1],
+                                       c->lin_src_format, c->inv_gamma, 0);
+            if (res < 0) goto cleanup;
+            ++index;
+            srcIdx = linIdx + 1;
+        }
         if (need_chr_conv) {
             res = ff_init_desc_cfmt_convert(&c->desc[index], &c->slice[srcIdx], &c->slice[dstIdx], pal);
             if (res < 0) goto cleanup;
@@ -357,7 +385,7 @@ int ff_init_filters(SwsContext * c)
             srcIdx = dstIdx;
         }
 
-        dstIdx = FFMAX(num_ydesc, num_cdesc);
+        dstIdx = c->numSlice - 2;
         if (c->needs_hcscale)
             res = ff_init_desc_chscale(&c->desc[index], &c->slice[srcIdx], &c->slice[dstIdx], c->hChrFilter, c->hChrFilterPos, c->hChrFilterSize, c->chrXInc);
         else
@@ -368,14 +396,15 @@ int ff_init_filters(SwsContext * c)
     ++index;
     {
         srcIdx = c->numSlice - 2;
-        dstIdx = c->numSlice - 1;
+        dstIdx = need_gamma ? linIdx + 2 : c->numSlice - 1;
         res = ff_init_vscale(c, c->desc + index, c->slice + srcIdx, c->slice + dstIdx);
         if (res < 0) goto cleanup;
     }
 
     ++index;
     if (need_gamma) {
-        res = ff_init_gamma_convert(c->desc + index, c->slice + dstIdx, c->gamma);
+        res = ff_init_linear_output(&c->desc[index], &c->slice[linIdx + 2], &c->slice[c->numSlice - 1],
+                                    c->lin_dst_format, c->gamma, c->needAlpha);
         if (res < 0) goto cleanup;
     }
 
@@ -386,6 +415,107 @@ cleanup:
     return res;
 }
 
+/* cache budget of the lines buffered by the vertical scaler, in bytes */
+#define TILE_CACHE_SIZE (128 << 10)
+/* keeps the ordered dither patterns, the SIMD groups of the horizontal
+ * scalers and the packing of bitstream formats aligned */
+#define TILE_DST_ALIGN  64
+#define TILE_SRC_ALIGN  16
+
+static int auto_tile_width(const SwsContext *c)
+{
+    const int hsub  = c->chrDstHSubSample;
+    const int bytes = c->dstBpc > 14 ? 4 : 2;
+    /* lines of each plane read for an output line, counted in units of
+     * chroma columns per luma column */
+    const int64_t lines = ((int64_t)c->vLumFilterSize * (1 + c->needAlpha) << hsub) +
+                          (c->needs_hcscale ? 2 * c->vChrFilterSize : 0);
+
+    return FFMIN(((int64_t)TILE_CACHE_SIZE << hsub) / (lines * bytes), INT_MAX);
+}
+
+int ff_sws_init_tiles(SwsContext *c)
+{
+    const int chr_src_shift = c->chrSrcHSubSample;
+    const int chr_dst_shift = c->chrDstHSubSample;
+    int linesize[4];
+    int tile_w, src_x, t, i;
+
+    /* only the generic scaler is tiled, and only when every output column
+     * does not depend on the columns left of it */
+    if (!c->tile_width || c->convert_unscaled || c->convert_fused || c->is_internal_gamma ||
+        c->hyscale_fast || c->hcscale_fast || c->dither == SWS_DITHER_ED ||
+        c->dither == SWS_DITHER_A_DITHER || c->dither == SWS_DITHER_X_DITHER)
+        return 0;
+
+    tile_w = c->tile_width > 0 ? c->tile_width : auto_tile_width(c);
+    if (tile_w >= c->dstW)
+        return 0;
+    tile_w = FFALIGN(FFMAX(tile_w, 1), TILE_DST_ALIGN);
+    if (tile_w >= c->dstW)
+        return 0;
+
+    c->nb_tiles = (c->dstW + tile_w - 1) / tile_w;
+    c->tiles    = av_calloc(c->nb_tiles, sizeof(*c->tiles));
+    if (!c->tiles ||
+        !FF_ALLOC_TYPED_ARRAY(c->tileLumFilterPos, c->dstW + 3) ||
+        (c->needs_hcscale && !FF_ALLOC_TYPED_ARRAY(c->tileChrFilterPos, c->chrDstW + 3)))
+        return AVERROR(ENOMEM);
+
+    for (t = 0; t < c->nb_tiles; t++) {
+        SwsTile *tile  = &c->tiles[t];
+        const int x0   = t * tile_w;
+        const int x1   = FFMIN(x0 + tile_w, c->dstW);
+        const int chr0 = x0 >> chr_dst_shift;
+        const int chr1 = AV_CEIL_RSHIFT(x1, chr_dst_shift);
+        int src0 = INT_MAX, src1 = 0;
+
+        for (i = x0; i < x1; i++) {
+            src0 = FFMIN(src0, c->hLumFilterPos[i]);
+            src1 = FFMAX(src1, c->hLumFilterPos[i] + c->hLumFilterSize);
+        }
+        if (c->needs_hcscale) {
+            for (i = chr0; i < chr1; i++) {
+                src0 = FFMIN(src0, c->hChrFilterPos[i] << chr_src_shift);
+                src1 = FFMAX(src1, (c->hChrFilterPos[i] + c->hChrFilterSize) << chr_src_shift);
+            }
+        }
+
+        tile->dst_x = x0;
+        tile->dst_w = x1 - x0;
+        tile->src_x = src0 & ~(TILE_SRC_ALIGN - 1);
+        tile->src_w = FFMIN(src1, c->srcW) - tile->src_x;
+
+        for (i = x0; i < x1; i++)
+            c->tileLumFilterPos[i] = c->hLumFilterPos[i] - tile->src_x;
+        if (c->needs_hcscale) {
+            for (i = chr0; i < chr1; i++)
+                c->tileChrFilterPos[i] = c->hChrFilterPos[i] - (tile->src_x >> chr_src_shift);
+        }
+
+        av_image_fill_linesizes(linesize, c->srcFormat, tile->src_x);
+        for (i = 0; i < 4; i++)
+            tile->src_offset[i] = linesize[i];
+        av_image_fill_linesizes(linesize, c->dstFormat, tile->dst_x);
+        for (i = 0; i < 4; i++)
+            tile->dst_offset[i] = linesize[i];
+    }
+
+    av_log(c, AV_LOG_VERBOSE, "Scaling in %d column tiles of %d pixels\n",
+           c->nb_tiles, tile_w);
+
+    /* the SIMD scalers read past the last position */
+    src_x = c->tiles[c->nb_tiles - 1].src_x;
+    for (i = c->dstW; i < c->dstW + 3; i++)
+        c->tileLumFilterPos[i] = c->hLumFilterPos[i] - src_x;
+    if (c->needs_hcscale) {
+        for (i = c->chrDstW; i < c->chrDstW + 3; i++)
+            c->tileChrFilterPos[i] = c->hChrFilterPos[i] - (src_x >> chr_src_shift);
+    }
+
+    return 0;
+}
+
 int ff_free_filters(SwsContext *c)
 {
     int i;
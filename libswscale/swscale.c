@@ -62,22 +62,41 @@ static av_always_inline void fillPlane(uint8_t *plane, int stride, int width,
     }
 }
 
-static void hScale16To19_c(SwsContext *c, int16_t *_dst, int dstW,
-                           const uint8_t *_src, const int16_t *filter,
-                           const int32_t *filterPos, int filterSize)
+static int hscale16to19_shift(const SwsContext *c)
 {
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->srcFormat);
-    int i;
-    int32_t *dst        = (int32_t *) _dst;
-    const uint16_t *src = (const uint16_t *) _src;
-    int bits            = desc->comp[0].depth - 1;
-    int sh              = bits - 4;
+    int bits = desc->comp[0].depth - 1;
+    int sh   = bits - 4;
 
     if ((isAnyRGB(c->srcFormat) || c->srcFormat==AV_PIX_FMT_PAL8) && desc->comp[0].depth<16) {
         sh = 9;
     } else if (desc->flags & AV_PIX_FMT_FLAG_FLOAT) { /* float input are process like uint 16bpc */
         sh = 16 - 1 - 4;
     }
+    return sh;
+}
+
+static int hscale16to15_shift(const SwsContext *c)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->srcFormat);
+    int sh = desc->comp[0].depth - 1;
+
+    if (sh<15) {
+        sh = isAnyRGB(c->srcFormat) || c->srcFormat==AV_PIX_FMT_PAL8 ? 13 : (desc->comp[0].depth - 1);
+    } else if (desc->flags & AV_PIX_FMT_FLAG_FLOAT) { /* float input are process like uint 16bpc */
+        sh = 16 - 1;
+    }
+    return sh;
+}
+
+static void hScale16To19_c(SwsContext *c, int16_t *_dst, int dstW,
+                           const uint8_t *_src, const int16_t *filter,
+                           const int32_t *filterPos, int filterSize)
+{
+    int i;
+    int32_t *dst        = (int32_t *) _dst;
+    const uint16_t *src = (const uint16_t *) _src;
+    int sh              = hscale16to19_shift(c);
 
     for (i = 0; i < dstW; i++) {
         int j;
@@ -96,16 +115,9 @@ static void hScale16To15_c(SwsContext *c, int16_t *dst, int dstW,
                            const uint8_t *_src, const int16_t *filter,
                            const int32_t *filterPos, int filterSize)
 {
-    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->srcFormat);
     int i;
     const uint16_t *src = (const uint16_t *) _src;
-    int sh              = desc->comp[0].depth - 1;
-
-    if (sh<15) {
-        sh = isAnyRGB(c->srcFormat) || c->srcFormat==AV_PIX_FMT_PAL8 ? 13 : (desc->comp[0].depth - 1);
-    } else if (desc->flags & AV_PIX_FMT_FLAG_FLOAT) { /* float input are process like uint 16bpc */
-        sh = 16 - 1;
-    }
+    int sh              = hscale16to15_shift(c);
 
     for (i = 0; i < dstW; i++) {
         int j;
@@ -154,6 +166,55 @@ static void hScale8To19_c(SwsContext *c, int16_t *_dst, int dstW,
     }
 }
 
+/* The same arithmetic as the scalers above for runs of output pixels that
+ * share their coefficients, the common filter sizes get their own copy so
+ * that the inner loop is unrolled. */
+static av_always_inline void hscale_fixed(SwsContext *c, int16_t *dst, int dstW,
+                                          const uint8_t *src, const int16_t *filter,
+                                          int srcPos, int srcStep, int filterSize,
+                                          int src16, int dst19)
+{
+    const uint16_t *src16p = (const uint16_t *)src;
+    int32_t *dst32 = (int32_t *)dst;
+    const int sh = src16 ? (dst19 ? hscale16to19_shift(c) : hscale16to15_shift(c))
+                         : (dst19 ? 3 : 7);
+    int i, j;
+
+    for (i = 0; i < dstW; i++) {
+        int val = 0;
+
+        for (j = 0; j < filterSize; j++)
+            val += (src16 ? src16p[srcPos + j] : (int)src[srcPos + j]) * filter[j];
+        srcPos += srcStep;
+
+        if (dst19)
+            dst32[i] = FFMIN(val >> sh, (1 << 19) - 1);
+        else
+            dst[i]   = FFMIN(val >> sh, (1 << 15) - 1);
+    }
+}
+
+#define HSCALE_FIXED_FUNC(name, src16, dst19)                                   \
+static void hScaleFixed ## name ## _c(SwsContext *c, int16_t *dst, int dstW,    \
+                                      const uint8_t *src, const int16_t *filter, \
+                                      int srcPos, int srcStep, int filterSize)   \
+{                                                                               \
+    switch (filterSize) {                                                       \
+    case  1: hscale_fixed(c, dst, dstW, src, filter, srcPos, srcStep,  1, src16, dst19); break; \
+    case  4: hscale_fixed(c, dst, dstW, src, filter, srcPos, srcStep,  4, src16, dst19); break; \
+    case  6: hscale_fixed(c, dst, dstW, src, filter, srcPos, srcStep,  6, src16, dst19); break; \
+    case  8: hscale_fixed(c, dst, dstW, src, filter, srcPos, srcStep,  8, src16, dst19); break; \
+    case 12: hscale_fixed(c, dst, dstW, src, filter, srcPos, srcStep, 12, src16, dst19); break; \
+    case 16: hscale_fixed(c, dst, dstW, src, filter, srcPos, srcStep, 16, src16, dst19); break; \
+    default: hscale_fixed(c, dst, dstW, src, filter, srcPos, srcStep, filterSize, src16, dst19); \
+    }                                                                           \
+}
+
+HSCALE_FIXED_FUNC(8To15,  0, 0)
+HSCALE_FIXED_FUNC(8To19,  0, 1)
+HSCALE_FIXED_FUNC(16To15, 1, 0)
+HSCALE_FIXED_FUNC(16To19, 1, 1)
+
 // FIXME all pal and rgb srcFormats could do this conversion as well
 // FIXME all scalers more complex than bilinear could do half of this transform
 static void chrRangeToJpeg_c(int16_t *dstU, int16_t *dstV, int width)
@@ -236,13 +297,14 @@ static void lumRangeFromJpeg16_c(int16_t *_dst, int width)
 static int swscale(SwsContext *c, const uint8_t *src[],
                    int srcStride[], int srcSliceY, int srcSliceH,
                    uint8_t *dst[], int dstStride[],
-                   int dstSliceY, int dstSliceH)
+                   int dstSliceY, int dstSliceH, const SwsTile *tile)
 {
     const int scale_dst = dstSliceY > 0 || dstSliceH < c->dstH;
 
     /* load a few things into local vars to make the code more readable?
      * and faster */
-    const int dstW                   = c->dstW;
+    const int srcW                   = tile ? tile->src_w : c->srcW;
+    const int dstW                   = tile ? tile->dst_w : c->dstW;
     int dstH                         = c->dstH;
 
     const enum AVPixelFormat dstFormat = c->dstFormat;
@@ -355,11 +417,13 @@ static int swscale(SwsContext *c, const uint8_t *src[],
 
     ff_init_vscale_pfn(c, yuv2plane1, yuv2planeX, yuv2nv12cX,
                    yuv2packed1, yuv2packed2, yuv2packedX, yuv2anyX, c->use_mmx_vfilter);
+    if (c->tiles)
+        ff_set_desc_hscale_tile(c, tile);
 
-    ff_init_slice_from_src(src_slice, (uint8_t**)src, srcStride, c->srcW,
+    ff_init_slice_from_src(src_slice, (uint8_t**)src, srcStride, srcW,
             srcSliceY, srcSliceH, chrSrcSliceY, chrSrcSliceH, 1);
 
-    ff_init_slice_from_src(vout_slice, (uint8_t**)dst, dstStride, c->dstW,
+    ff_init_slice_from_src(vout_slice, (uint8_t**)dst, dstStride, dstW,
             dstY, dstSliceH, dstY >> c->chrDstVSubSample,
             AV_CEIL_RSHIFT(dstSliceH, c->chrDstVSubSample), scale_dst);
     if (srcSliceY == 0) {
@@ -531,6 +595,40 @@ static int swscale(SwsContext *c, const uint8_t *src[],
     return dstY - lastDstY;
 }
 
+/*
+ * Scale a complete source picture one column tile after the other, so that
+ * the lines buffered between the horizontal and the vertical scaler are only
+ * as wide as a tile. swscale() modifies the pointers and strides it is
+ * passed, so every tile gets its own copy.
+ */
+static int swscale_tiled(SwsContext *c, const uint8_t *src[],
+                         const int srcStride[], uint8_t *dst[],
+                         const int dstStride[], int dstSliceY, int dstSliceH)
+{
+    int ret = 0;
+
+    for (int t = 0; t < c->nb_tiles; t++) {
+        const SwsTile *tile = &c->tiles[t];
+        const uint8_t *tile_src[4];
+        uint8_t *tile_dst[4];
+        int tile_src_stride[4], tile_dst_stride[4];
+
+        for (int i = 0; i < 4; i++) {
+            tile_src[i] = src[i] ? src[i] + tile->src_offset[i] : NULL;
+            tile_dst[i] = dst[i] ? dst[i] + tile->dst_offset[i] : NULL;
+            tile_src_stride[i] = srcStride[i];
+            tile_dst_stride[i] = dstStride[i];
+        }
+
+        ret = swscale(c, tile_src, tile_src_stride, 0, c->srcH,
+                      tile_dst, tile_dst_stride, dstSliceY, dstSliceH, tile);
+        if (ret < 0)
+            return ret;
+    }
+
+    return ret;
+}
+
 av_cold void ff_sws_init_range_convert(SwsContext *c)
 {
     c->lumConvertRange = NULL;
@@ -568,17 +666,21 @@ static av_cold void sws_init_swscale(SwsContext *c)
 
     if (c->srcBpc == 8) {
         if (c->dstBpc <= 14) {
-            c->hyScale = c->hcScale = hScale8To15_c;
+            c->hyScale      = c->hcScale      = hScale8To15_c;
+            c->hyScaleFixed = c->hcScaleFixed = hScaleFixed8To15_c;
             if (c->flags & SWS_FAST_BILINEAR) {
                 c->hyscale_fast = ff_hyscale_fast_c;
                 c->hcscale_fast = ff_hcscale_fast_c;
             }
         } else {
-            c->hyScale = c->hcScale = hScale8To19_c;
+            c->hyScale      = c->hcScale      = hScale8To19_c;
+            c->hyScaleFixed = c->hcScaleFixed = hScaleFixed8To19_c;
         }
     } else {
-        c->hyScale = c->hcScale = c->dstBpc > 14 ? hScale16To19_c
-                                                 : hScale16To15_c;
+        c->hyScale      = c->hcScale      = c->dstBpc > 14 ? hScale16To19_c
+                                                           : hScale16To15_c;
+        c->hyScaleFixed = c->hcScaleFixed = c->dstBpc > 14 ? hScaleFixed16To19_c
+                                                           : hScaleFixed16To15_c;
     }
 
     ff_sws_init_range_convert(c);
@@ -590,7 +692,14 @@ static av_cold void sws_init_swscale(SwsContext *c)
 
 void ff_sws_init_scale(SwsContext *c)
 {
+    void (*hyScale)(SwsContext *, int16_t *, int, const uint8_t *,
+                    const int16_t *, const int32_t *, int);
+    void (*hcScale)(SwsContext *, int16_t *, int, const uint8_t *,
+                    const int16_t *, const int32_t *, int);
+
     sws_init_swscale(c);
+    hyScale = c->hyScale;
+    hcScale = c->hcScale;
 
 #if ARCH_PPC
     ff_sws_init_swscale_ppc(c);
@@ -605,6 +714,19 @@ void ff_sws_init_scale(SwsContext *c)
 #elif ARCH_RISCV
     ff_sws_init_swscale_riscv(c);
 #endif
+
+    /* the SIMD scalers may expect their filters in another layout; the fixed
+     * phase scalers have no SIMD versions and were only measured against the
+     * generic C scaler, so they are used for the bit depths and filter sizes
+     * the arch code leaves to C */
+    if (c->hyScale != hyScale)
+        c->hyScaleFixed = NULL;
+    if (c->hcScale != hcScale)
+        c->hcScaleFixed = NULL;
+
+    /* the same goes for the fused scalers, which are C code as well */
+    if (c->hyScale != hyScale || c->hcScale != hcScale)
+        c->convert_fused = NULL;
 }
 
 static void reset_ptr(const uint8_t *src[], enum AVPixelFormat format)
@@ -882,6 +1004,113 @@ static int scale_cascaded(SwsContext *c,
     return ret;
 }
 
+/* Target size of one band of the intermediate image, meant to stay in L2 */
+#define CASCADE_BAND_SIZE (256 << 10)
+
+static int cascade_can_band(const SwsContext *c)
+{
+    for (int i = 0; i < FF_ARRAY_ELEMS(c->cascaded_context); i++) {
+        const SwsContext *cc = c->cascaded_context[i];
+        if (cc && (cc->cascaded_context[0] || cc->srcXYZ || cc->dstXYZ))
+            return 0;
+    }
+
+    /* Bayer sources are demosaiced from neighbouring lines, which are not
+     * available across the edges of destination slices */
+    if (isBayer(c->srcFormat))
+        return 0;
+
+    /* the first step is given the whole source for every band, avoid
+     * converting it to a scratch buffer again each time */
+    return c->cascaded_context[1] && !c->cascaded_context[0]->src0Alpha;
+}
+
+static int cascade_band_height(const SwsContext *c)
+{
+    const SwsContext *c0 = c->cascaded_context[0];
+    const SwsContext *c1 = c->cascaded_context[1];
+    const int align = FFMAX(c0->dst_slice_align, 1 << c1->chrSrcVSubSample);
+    int64_t row_size = 0;
+    int h;
+
+    for (int i = 0; i < 4; i++) {
+        const int vshift = (i == 1 || i == 2) ? c1->chrSrcVSubSample : 0;
+        row_size += FFABS(c->cascaded_tmpStride[i]) >> vshift;
+    }
+
+    h = row_size ? CASCADE_BAND_SIZE / row_size : c0->dstH;
+    /* a scaling first step filters the source lines at every band edge
+     * again, keep the bands tall compared to its filter */
+    if (!c0->convert_unscaled)
+        h = FFMAX(h, 8 * c0->vLumFilterSize);
+
+    return FFALIGN(FFMAX(h, 1), align);
+}
+
+/**
+ * Run all cascaded steps for a whole frame, band by band: each band of the
+ * intermediate image is produced by the first step and immediately consumed
+ * by the following ones as a source slice, while it is still in cache.
+ */
+static int scale_cascaded_bands(SwsContext *c,
+                                const uint8_t * const srcSlice[], const int srcStride[],
+                                uint8_t * const dstSlice[], const int dstStride[])
+{
+    SwsContext *c0 = c->cascaded_context[0];
+    SwsContext *c1 = c->cascaded_context[1];
+    SwsContext *c2 = c->cascaded_context[2];
+    const int band_h = cascade_band_height(c);
+    int lines = 0;
+
+    for (int y = 0; y < c0->dstH; y += band_h) {
+        const int h = FFMIN(band_h, c0->dstH - y);
+        uint8_t *tmp[4];
+        int ret;
+
+        for (int i = 0; i < 4; i++) {
+            const int vshift = (i == 1 || i == 2) ? c1->chrSrcVSubSample : 0;
+            tmp[i] = c->cascaded_tmp[i] ?
+                     c->cascaded_tmp[i] + (y >> vshift) * (ptrdiff_t)c->cascaded_tmpStride[i] : NULL;
+        }
+
+        ret = scale_internal(c0, srcSlice, srcStride, 0, c0->srcH,
+                             tmp, c->cascaded_tmpStride, y, h);
+        if (ret < 0)
+            return ret;
+
+        if (c2) {
+            ret = scale_internal(c1, (const uint8_t * const *)tmp, c->cascaded_tmpStride,
+                                 y, h, c->cascaded1_tmp, c->cascaded1_tmpStride,
+                                 0, c1->dstH);
+            if (ret <= 0) {
+                if (ret < 0)
+                    return ret;
+                continue;
+            }
+
+            /* c1 has no slice pointers of its own, address its output from
+             * the top of the second intermediate image */
+            for (int i = 0; i < 4; i++) {
+                const int vshift = (i == 1 || i == 2) ? c2->chrSrcVSubSample : 0;
+                tmp[i] = c->cascaded1_tmp[i] ?
+                         c->cascaded1_tmp[i] + ((c1->dstY - ret) >> vshift) *
+                                               (ptrdiff_t)c->cascaded1_tmpStride[i] : NULL;
+            }
+
+            ret = scale_internal(c2, (const uint8_t * const *)tmp, c->cascaded1_tmpStride,
+                                 c1->dstY - ret, ret, dstSlice, dstStride, 0, c->dstH);
+        } else {
+            ret = scale_internal(c1, (const uint8_t * const *)tmp, c->cascaded_tmpStride,
+                                 y, h, dstSlice, dstStride, 0, c->dstH);
+        }
+        if (ret < 0)
+            return ret;
+        lines += ret;
+    }
+
+    return lines;
+}
+
 static int scale_internal(SwsContext *c,
                           const uint8_t * const srcSlice[], const int srcStride[],
                           int srcSliceY, int srcSliceH,
@@ -899,12 +1128,26 @@ static int scale_internal(SwsContext *c,
     int srcStride2[4];
     int dstStride2[4];
     int srcSliceY_internal = srcSliceY;
+    const uint8_t *lin_src[4];
+    uint8_t *lin_dst[4];
+    int lin_srcStride[4], lin_dstStride[4];
 
     if (!srcStride || !dstStride || !dstSlice || !srcSlice) {
         av_log(c, AV_LOG_ERROR, "One of the input parameters to sws_scale() is NULL, please check the calling code\n");
         return AVERROR(EINVAL);
     }
 
+    if (c->is_internal_gamma) {
+        ff_sws_linear_planes(c->lin_src_format, lin_src, lin_srcStride,
+                             srcSlice, srcStride);
+        ff_sws_linear_planes(c->lin_dst_format, (const uint8_t **)lin_dst, lin_dstStride,
+                             (const uint8_t * const *)dstSlice, dstStride);
+        srcSlice  = lin_src;
+        srcStride = lin_srcStride;
+        dstSlice  = lin_dst;
+        dstStride = lin_dstStride;
+    }
+
     if ((srcSliceY  & (macro_height_src - 1)) ||
         ((srcSliceH & (macro_height_src - 1)) && srcSliceY + srcSliceH != c->srcH) ||
         srcSliceY + srcSliceH > c->srcH ||
@@ -933,7 +1176,15 @@ static int scale_internal(SwsContext *c,
     if (srcSliceH == 0)
         return 0;
 
-    if (c->gamma_flag && c->cascaded_context[0])
+    if (c->gamma_flag && c->cascaded_context[0] && !c->cascaded_context[1])
+        return scale_internal(c->cascaded_context[0], srcSlice, srcStride, srcSliceY, srcSliceH,
+                              dstSlice, dstStride, dstSliceY, dstSliceH);
+
+    if (c->cascaded_context[0] && !scale_dst &&
+        srcSliceY == 0 && srcSliceH == c->srcH && cascade_can_band(c))
+        return scale_cascaded_bands(c, srcSlice, srcStride, dstSlice, dstStride);
+
+    if (c->gamma_flag && c->cascaded_context[2])
         return scale_gamma(c, srcSlice, srcStride, srcSliceY, srcSliceH,
                            dstSlice, dstStride, dstSliceY, dstSliceH);
 
@@ -1042,13 +1293,20 @@ static int scale_internal(SwsContext *c,
             slice_h = dstSliceH;
         }
 
+        c->convert_dst_slice = scale_dst;
         ret = c->convert_unscaled(c, src2, srcStride2, offset, slice_h,
                                   dst2, dstStride2);
         if (scale_dst)
             dst2[0] += dstSliceY * dstStride2[0];
+    } else if (c->convert_fused && srcSliceY_internal == 0 && srcSliceH == c->srcH) {
+        ret = c->convert_fused(c, src2, srcStride2, dst2, dstStride2,
+                               dstSliceY, dstSliceH);
+    } else if (c->tiles && srcSliceY_internal == 0 && srcSliceH == c->srcH) {
+        ret = swscale_tiled(c, src2, srcStride2, dst2, dstStride2,
+                            dstSliceY, dstSliceH);
     } else {
         ret = swscale(c, src2, srcStride2, srcSliceY_internal, srcSliceH,
-                      dst2, dstStride2, dstSliceY, dstSliceH);
+                      dst2, dstStride2, dstSliceY, dstSliceH, NULL);
     }
 
     if (c->dstXYZ && !(c->srcXYZ && c->srcW==c->dstW && c->srcH==c->dstH)) {
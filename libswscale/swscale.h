@@ -349,6 +349,53 @@ int sws_receive_slice(struct SwsContext *c, unsigned int slice_start,
  */
 unsigned int sws_receive_slice_alignment(const struct SwsContext *c);
 
+/**
+ * A scaler of one source to several outputs ("rungs"), such as the
+ * renditions of an adaptive streaming ladder.
+ *
+ * The rungs are scaled from the largest to the smallest. A rung is scaled
+ * from a rung of the same pixel format that is at least twice its size in
+ * both dimensions if there is one, rather than from the source, so a ladder
+ * with 2:1 steps reads the source only once.
+ */
+typedef struct SwsLadder SwsLadder;
+
+/**
+ * Allocate and initialize a ladder.
+ *
+ * @param src_w      the width of the source pictures
+ * @param src_h      the height of the source pictures
+ * @param src_format the format of the source pictures
+ * @param nb_rungs   the number of outputs
+ * @param dst_w      the widths of the nb_rungs outputs
+ * @param dst_h      the heights of the nb_rungs outputs
+ * @param dst_format the formats of the nb_rungs outputs
+ * @param opts       SwsContext options used for all scalers of the ladder,
+ *                   such as "sws_flags" or "threads", may be NULL
+ * @return the ladder, NULL on failure
+ */
+SwsLadder *sws_alloc_ladder(int src_w, int src_h, enum AVPixelFormat src_format,
+                            int nb_rungs, const int *dst_w, const int *dst_h,
+                            const enum AVPixelFormat *dst_format,
+                            const AVDictionary *opts);
+
+/**
+ * Scale a source picture to all rungs of a ladder.
+ *
+ * @param l   the ladder
+ * @param dst the nb_rungs destination frames, in the order of the sizes
+ *            given to sws_alloc_ladder(). Frames without buffers are
+ *            allocated as in sws_scale_frame().
+ * @param src the source frame
+ * @return 0 on success, a negative AVERROR code on failure
+ */
+int sws_ladder_scale_frame(SwsLadder *l, AVFrame **dst, const AVFrame *src);
+
+/**
+ * Free a ladder and set the pointer to it to NULL.
+ */
+void sws_free_ladder(SwsLadder **l);
+
 /**
  * @param c the scaling context
  * @param dstRange flag indicating the while-black range of the output (1=jpeg / 0=mpeg)
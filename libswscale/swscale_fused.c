@@ -0,0 +1,263 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Fused scalers for common planar YUV conversions.
+ *
+ * The generic scaler filters every source line horizontally, converts the
+ * range of the intermediate lines and then filters vertically before packing
+ * the output. When the picture is not scaled up vertically, it is cheaper to
+ * filter the source planes vertically first, straight out of the source
+ * picture, and to apply the horizontal filter, the range conversion, the
+ * dithering and the output packing in a single pass over each output line.
+ */
+
+#include "libavutil/common.h"
+#include "libavutil/pixdesc.h"
+#include "swscale.h"
+#include "swscale_internal.h"
+
+/* the vertical pass produces lines with 15 bit samples (8 bit << 7), the
+ * horizontal pass sums them up with 14 bit coefficients */
+#define FUSED_LINE_BITS 7
+#define FUSED_ACC_SHIFT (14 + FUSED_LINE_BITS)
+/* range conversion factors are applied in 14 bit fixed point */
+#define FUSED_RANGE_BITS 14
+
+typedef struct FusedPlane {
+    const uint8_t *src;
+    int src_stride, src_w, src_h;
+
+    uint8_t *dst;
+    int dst_stride, dst_w, dst_step, dst_shift;
+    int dither_offset;
+
+    const int16_t *v_filter;
+    const int32_t *v_filter_pos;
+    int v_filter_size;
+
+    const int16_t *h_filter;
+    const int32_t *h_filter_pos;
+    int h_filter_size;
+
+    int64_t mult, offset;
+} FusedPlane;
+
+static av_always_inline void vfilter_line(int16_t *dst, const FusedPlane *p,
+                                          int y, int depth, int filter_size)
+{
+    const int16_t *coeff = p->v_filter + y * p->v_filter_size;
+    const int pos   = p->v_filter_pos[y];
+    const int size  = filter_size ? filter_size : p->v_filter_size;
+    const int shift = 12 + depth - 8 - FUSED_LINE_BITS;
+    const uint8_t *src[MAX_FILTER_SIZE];
+    int i, k;
+
+    for (k = 0; k < size; k++)
+        src[k] = p->src + av_clip(pos + k, 0, p->src_h - 1) * (ptrdiff_t)p->src_stride;
+
+    /* 12 bit coefficients, scale to 8 bit << FUSED_LINE_BITS */
+    for (i = 0; i < p->src_w; i++) {
+        int acc = 1 << (shift - 1);
+
+        for (k = 0; k < size; k++)
+            acc += coeff[k] * (depth == 8 ? src[k][i] : ((const uint16_t *)src[k])[i]);
+        dst[i] = av_clip_int16(acc >> shift);
+    }
+}
+
+static av_always_inline void hfilter_line(const FusedPlane *p, uint8_t *dst,
+                                          const int16_t *src,
+                                          const uint8_t *dither,
+                                          int filter_size, int dst_depth,
+                                          int dst_step)
+{
+    const int16_t *filter = p->h_filter;
+    const int32_t *pos    = p->h_filter_pos;
+    const int size  = filter_size ? filter_size : p->h_filter_size;
+    const int shift = FUSED_ACC_SHIFT + FUSED_RANGE_BITS + 8 - dst_depth;
+    const int max   = (1 << dst_depth) - 1;
+    const int dst_shift = p->dst_shift;
+    const int dither_offset = p->dither_offset;
+    const int64_t mult = p->mult, offset = p->offset;
+    int i, k;
+
+    for (i = 0; i < p->dst_w; i++) {
+        const int16_t *s = src + pos[i];
+        int64_t v;
+        int acc = 0;
+
+        for (k = 0; k < size; k++)
+            acc += filter[k] * s[k];
+        filter += size;
+
+        v = acc * mult + offset;
+        if (dst_depth == 8)
+            v += (int64_t)dither[(i + dither_offset) & 7] << (shift - 7);
+        else
+            v += 1LL << (shift - 1);
+
+        if (dst_depth == 8) {
+            dst[i * dst_step] = av_clip_uintp2(v >> shift, 8);
+        } else {
+            ((uint16_t *)dst)[i * dst_step] =
+                av_clip(v >> shift, 0, max) << dst_shift;
+        }
+    }
+}
+
+#define HFILTER_FUNCS(name, depth, step)                                       \
+static void hfilter_ ## name(const FusedPlane *p, uint8_t *dst,               \
+                             const int16_t *src, const uint8_t *dither)       \
+{                                                                              \
+    switch (p->h_filter_size) {                                                \
+    case 4:  hfilter_line(p, dst, src, dither, 4, depth, step); break;         \
+    case 6:  hfilter_line(p, dst, src, dither, 6, depth, step); break;         \
+    case 8:  hfilter_line(p, dst, src, dither, 8, depth, step); break;         \
+    default: hfilter_line(p, dst, src, dither, 0, depth, step); break;         \
+    }                                                                          \
+}
+
+HFILTER_FUNCS(planar8,   8, 1)
+HFILTER_FUNCS(packed8,   8, 2)
+HFILTER_FUNCS(planar10, 10, 1)
+HFILTER_FUNCS(packed10, 10, 2)
+
+#define VFILTER_FUNCS(depth)                                                   \
+static void vfilter_ ## depth(int16_t *dst, const FusedPlane *p, int y)        \
+{                                                                              \
+    switch (p->v_filter_size) {                                                \
+    case 2:  vfilter_line(dst, p, y, depth, 2); break;                         \
+    case 4:  vfilter_line(dst, p, y, depth, 4); break;                         \
+    case 6:  vfilter_line(dst, p, y, depth, 6); break;                         \
+    default: vfilter_line(dst, p, y, depth, 0); break;                         \
+    }                                                                          \
+}
+
+VFILTER_FUNCS(8)
+VFILTER_FUNCS(10)
+
+static void set_range(FusedPlane *p, int chroma, int src_range, int dst_range)
+{
+    const int64_t one    = 1LL << FUSED_RANGE_BITS;
+    const int64_t center = (chroma ? 128LL : 16LL) << FUSED_ACC_SHIFT;
+
+    p->offset = 0;
+    if (src_range == dst_range) {
+        p->mult = one;
+        return;
+    }
+
+    if (dst_range)
+        p->mult = lrint(one * (chroma ? 255.0 / 224 : 255.0 / 219));
+    else
+        p->mult = lrint(one * (chroma ? 224.0 / 255 : 219.0 / 255));
+
+    /* chroma is scaled around its center, luma around the black level of
+     * the limited range side */
+    if (chroma)
+        p->offset = center * (one - p->mult);
+    else if (dst_range)
+        p->offset = -center * p->mult;
+    else
+        p->offset = center * one;
+}
+
+static int fused_yuv420(SwsContext *c, const uint8_t *src[], const int srcStride[],
+                        uint8_t *dst[], const int dstStride[],
+                        int dstSliceY, int dstSliceH)
+{
+    const AVPixFmtDescriptor *src_desc = av_pix_fmt_desc_get(c->srcFormat);
+    const AVPixFmtDescriptor *dst_desc = av_pix_fmt_desc_get(c->dstFormat);
+    const int dst_depth = dst_desc->comp[0].depth;
+    const int src_depth = src_desc->comp[0].depth;
+    int16_t *line = c->fused_tmp;
+    int comp, y;
+
+    for (comp = 0; comp < 3; comp++) {
+        const AVComponentDescriptor *dc = &dst_desc->comp[comp];
+        const int chroma = comp > 0;
+        const int y0 = chroma ? dstSliceY >> 1 : dstSliceY;
+        const int y1 = chroma ? AV_CEIL_RSHIFT(dstSliceY + dstSliceH, 1)
+                              : dstSliceY + dstSliceH;
+        void (*vfilter)(int16_t *dst, const FusedPlane *p, int y);
+        void (*hfilter)(const FusedPlane *p, uint8_t *dst, const int16_t *src,
+                        const uint8_t *dither);
+        FusedPlane p = {
+            .src           = src[comp],
+            .src_stride    = srcStride[comp],
+            .src_w         = chroma ? c->chrSrcW : c->srcW,
+            .src_h         = chroma ? c->chrSrcH : c->srcH,
+            .dst           = dst[dc->plane] + dc->offset,
+            .dst_stride    = dstStride[dc->plane],
+            .dst_w         = chroma ? c->chrDstW : c->dstW,
+            .dst_step      = dc->step / (dst_depth > 8 ? 2 : 1),
+            .dst_shift     = dc->shift,
+            /* same dither pattern as the generic output functions */
+            .dither_offset = comp == 2 ? 3 : 0,
+            .v_filter      = chroma ? c->vChrFilter    : c->vLumFilter,
+            .v_filter_pos  = chroma ? c->vChrFilterPos : c->vLumFilterPos,
+            .v_filter_size = chroma ? c->vChrFilterSize : c->vLumFilterSize,
+            .h_filter      = chroma ? c->fusedHChrFilter    : c->fusedHLumFilter,
+            .h_filter_pos  = chroma ? c->fusedHChrFilterPos : c->fusedHLumFilterPos,
+            .h_filter_size = chroma ? c->fusedHChrFilterSize : c->fusedHLumFilterSize,
+        };
+
+        set_range(&p, chroma, c->srcRange, c->dstRange);
+
+        vfilter = src_depth == 8 ? vfilter_8 : vfilter_10;
+        if (dst_depth == 8)
+            hfilter = p.dst_step == 1 ? hfilter_planar8 : hfilter_packed8;
+        else
+            hfilter = p.dst_step == 1 ? hfilter_planar10 : hfilter_packed10;
+
+        for (y = y0; y < y1; y++) {
+            const uint8_t *dither = src_depth > dst_depth ? ff_dither_8x8_128[y & 7]
+                                                          : ff_dither_8x8_128[8];
+            uint8_t *out = p.dst + (y - y0) * (ptrdiff_t)p.dst_stride;
+
+            vfilter(line, &p, y);
+            hfilter(&p, out, line, dither);
+        }
+    }
+
+    return dstSliceH;
+}
+
+int ff_sws_fused_supported(const SwsContext *c)
+{
+    enum AVPixelFormat src = c->srcFormat, dst = c->dstFormat;
+
+    if (!c->fused || (c->flags & SWS_BITEXACT) || c->dstH > c->srcH)
+        return 0;
+
+    if (src != AV_PIX_FMT_YUV420P && src != AV_PIX_FMT_YUVJ420P &&
+        src != AV_PIX_FMT_YUV420P10)
+        return 0;
+
+    return dst == AV_PIX_FMT_YUV420P || dst == AV_PIX_FMT_YUVJ420P ||
+           dst == AV_PIX_FMT_YUV420P10 || dst == AV_PIX_FMT_NV12 ||
+           dst == AV_PIX_FMT_P010;
+}
+
+void ff_get_fused_swscale(SwsContext *c)
+{
+    if (ff_sws_fused_supported(c))
+        c->convert_fused = fused_yuv420;
+}
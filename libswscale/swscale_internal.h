@@ -96,6 +96,17 @@ typedef struct RangeList {
 
 int ff_range_add(RangeList *r, unsigned int start, unsigned int len);
 
+/**
+ * Vertical strip of the picture scaled on its own by the column-tiled
+ * scaler, see ff_sws_init_tiles().
+ */
+typedef struct SwsTile {
+    int dst_x, dst_w;           ///< output columns of the tile
+    int src_x, src_w;           ///< source columns read by the horizontal scalers
+    ptrdiff_t src_offset[4];    ///< byte offset of src_x in each source plane
+    ptrdiff_t dst_offset[4];    ///< byte offset of dst_x in each destination plane
+} SwsTile;
+
 typedef int (*SwsFunc)(struct SwsContext *context, const uint8_t *src[],
                        int srcStride[], int srcSliceY, int srcSliceH,
                        uint8_t *dst[], int dstStride[]);
@@ -359,9 +370,15 @@ typedef struct SwsContext {
 
     double gamma_value;
     int gamma_flag;
+    /* Set on the linear-light scaler of a gamma correct cascade. Its
+     * srcFormat/dstFormat are the planar RGB working formats, while the
+     * caller formats are read and written by the linearizing input and
+     * delinearizing output descriptors. */
     int is_internal_gamma;
-    uint16_t *gamma;
-    uint16_t *inv_gamma;
+    enum AVPixelFormat lin_src_format;
+    enum AVPixelFormat lin_dst_format;
+    uint16_t *gamma;        ///< 16-bit linear to lin_dst_format samples
+    uint16_t *inv_gamma;    ///< lin_src_format samples to 16-bit linear
 
     int numDesc;
     int descIndex[2];
@@ -682,6 +699,66 @@ typedef struct SwsContext {
     atomic_int   data_unaligned_warned;
 
     Half2FloatTables *h2f_tables;
+
+    /**
+     * Shared filter cache entries that hLumFilter, hChrFilter, vLumFilter,
+     * vChrFilter, fusedHLumFilter and fusedHChrFilter (with their positions)
+     * belong to, NULL for filters the context owns itself.
+     */
+    struct SwsFilterCacheEntry *filter_cache[6];
+
+    int fused;                      ///< Allow the fused scaler, set by the "fused" option.
+
+    /**
+     * Fused scaler for the whole picture, see swscale_fused.c. It writes
+     * output lines [dstSliceY, dstSliceY + dstSliceH), dst points to the
+     * first of them.
+     */
+    int (*convert_fused)(struct SwsContext *c, const uint8_t *src[],
+                         const int srcStride[], uint8_t *dst[],
+                         const int dstStride[], int dstSliceY, int dstSliceH);
+    int16_t *fusedHLumFilter;       ///< Horizontal luma filter of the fused scaler, not reordered for SIMD.
+    int16_t *fusedHChrFilter;       ///< Horizontal chroma filter of the fused scaler, not reordered for SIMD.
+    int32_t *fusedHLumFilterPos;
+    int32_t *fusedHChrFilterPos;
+    int      fusedHLumFilterSize;
+    int      fusedHChrFilterSize;
+    int16_t *fused_tmp;             ///< Vertically filtered line of the fused scaler.
+
+    /**
+     * Set while convert_unscaled() converts a band of output lines out of a
+     * complete source picture, so that it may read source lines outside of
+     * the band.
+     */
+    int convert_dst_slice;
+
+    /**
+     * Column tiles of the picture, NULL if it is scaled as a whole. The
+     * horizontal filter positions of each tile are stored relative to the
+     * first source column of the tile.
+     */
+    int tile_width;                 ///< 0 for no tiles, -1 for auto
+    SwsTile *tiles;
+    int   nb_tiles;
+    int32_t *tileLumFilterPos;
+    int32_t *tileChrFilterPos;
+
+    /**
+     * Horizontal scalers for runs of output pixels that all use the same
+     * filter coefficients, such as the interior of integer ratio scales.
+     * Output pixel i is computed from the filterSize input pixels starting
+     * at srcPos + i * srcStep, with the coefficients in filter[0..filterSize-1].
+     * The output is identical to that of hyScale/hcScale, they are NULL if
+     * those are not the C scalers.
+     */
+    /** @{ */
+    void (*hyScaleFixed)(struct SwsContext *c, int16_t *dst, int dstW,
+                         const uint8_t *src, const int16_t *filter,
+                         int srcPos, int srcStep, int filterSize);
+    void (*hcScaleFixed)(struct SwsContext *c, int16_t *dst, int dstW,
+                         const uint8_t *src, const int16_t *filter,
+                         int srcPos, int srcStep, int filterSize);
+    /** @} */
 } SwsContext;
 //FIXME check init (where 0)
 
@@ -967,6 +1044,8 @@ extern const AVClass ff_sws_context_class;
  * specific source and destination formats, bit depths, flags, etc.
  */
 void ff_get_unscaled_swscale(SwsContext *c);
+int ff_sws_fused_supported(const SwsContext *c);
+void ff_get_fused_swscale(SwsContext *c);
 void ff_get_unscaled_swscale_ppc(SwsContext *c);
 void ff_get_unscaled_swscale_arm(SwsContext *c);
 void ff_get_unscaled_swscale_aarch64(SwsContext *c);
@@ -1102,6 +1181,12 @@ int ff_init_filters(SwsContext *c);
 // Free all filter data
 int ff_free_filters(SwsContext *c);
 
+/**
+ * Split the output into column tiles when the lines buffered by the vertical
+ * scaler would not stay in cache, according to the tile_width option.
+ */
+int ff_sws_init_tiles(SwsContext *c);
+
 /*
  function for applying ring buffer logic into slice s
  It checks if the slice can hold more @lum lines, if yes
@@ -1110,8 +1195,24 @@ int ff_free_filters(SwsContext *c);
 */
 int ff_rotate_slice(SwsSlice *s, int lum, int chr);
 
-/// initializes gamma conversion descriptor
-int ff_init_gamma_convert(SwsFilterDescriptor *desc, SwsSlice * src, uint16_t *table);
+/// returns whether the linear-light scaler can read and write fmt directly
+int ff_sws_linear_supported(enum AVPixelFormat fmt);
+
+/**
+ * Present the planes of a lin_src_format/lin_dst_format image as the
+ * planar RGB working format, aliasing the single plane of packed formats.
+ */
+void ff_sws_linear_planes(enum AVPixelFormat fmt, const uint8_t *planes[4],
+                          int strides[4], const uint8_t * const data[],
+                          const int linesizes[]);
+
+/// initializes linearizing input descriptor, alpha is copied if set
+int ff_init_linear_input(SwsFilterDescriptor *desc, SwsSlice *src, SwsSlice *dst,
+                         enum AVPixelFormat fmt, const uint16_t *table, int alpha);
+
+/// initializes delinearizing output descriptor, src is set up as a one line buffer
+int ff_init_linear_output(SwsFilterDescriptor *desc, SwsSlice *src, SwsSlice *dst,
+                          enum AVPixelFormat fmt, const uint16_t *table, int alpha);
 
 /// initializes lum pixel format conversion descriptor
 int ff_init_desc_fmt_convert(SwsFilterDescriptor *desc, SwsSlice * src, SwsSlice *dst, uint32_t *pal);
@@ -1127,6 +1228,9 @@ int ff_init_desc_chscale(SwsFilterDescriptor *desc, SwsSlice *src, SwsSlice *dst
 
 int ff_init_desc_no_chr(SwsFilterDescriptor *desc, SwsSlice * src, SwsSlice *dst);
 
+/// points the horizontal scaling descriptors to the filters of tile, or of the whole picture if NULL
+void ff_set_desc_hscale_tile(SwsContext *c, const SwsTile *tile);
+
 /// initializes vertical scaling descriptors
 int ff_init_vscale(SwsContext *c, SwsFilterDescriptor *desc, SwsSlice *src, SwsSlice *dst);
 
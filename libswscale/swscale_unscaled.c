@@ -1319,6 +1319,19 @@ static int rgbToPlanarRgbWrapper(SwsContext *c, const uint8_t *src[],
 #define BAYER_RENAME(x) bayer_rggb16be_to_##x
 #include "bayer_template.c"
 
+/*
+ * The first and last two lines of a slice are copied rather than
+ * interpolated, as the lines around them are not known. When a band of a
+ * complete picture is converted, only the edges of the picture are copied so
+ * that the result does not depend on how the picture is split.
+ */
+static int bayer_interpolate_end(const SwsContext *c, int srcSliceY, int srcSliceH)
+{
+    if (c->convert_dst_slice && srcSliceY + srcSliceH < c->srcH)
+        return srcSliceH;
+    return srcSliceH - 2;
+}
+
 static int bayer_to_rgb24_wrapper(SwsContext *c, const uint8_t* src[], int srcStride[], int srcSliceY,
                                   int srcSliceH, uint8_t* dst[], int dstStride[])
 {
@@ -1351,11 +1364,15 @@ static int bayer_to_rgb24_wrapper(SwsContext *c, const uint8_t* src[], int srcSt
 
     av_assert0(srcSliceH > 1);
 
-    copy(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
-    srcPtr += 2 * srcStride[0];
-    dstPtr += 2 * dstStride[0];
+    i = 0;
+    if (!c->convert_dst_slice || !srcSliceY) {
+        copy(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
+        srcPtr += 2 * srcStride[0];
+        dstPtr += 2 * dstStride[0];
+        i = 2;
+    }
 
-    for (i = 2; i < srcSliceH - 2; i += 2) {
+    for (; i < bayer_interpolate_end(c, srcSliceY, srcSliceH); i += 2) {
         interpolate(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
         srcPtr += 2 * srcStride[0];
         dstPtr += 2 * dstStride[0];
@@ -1400,11 +1417,15 @@ static int bayer_to_rgb48_wrapper(SwsContext *c, const uint8_t* src[], int srcSt
 
     av_assert0(srcSliceH > 1);
 
-    copy(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
-    srcPtr += 2 * srcStride[0];
-    dstPtr += 2 * dstStride[0];
+    i = 0;
+    if (!c->convert_dst_slice || !srcSliceY) {
+        copy(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
+        srcPtr += 2 * srcStride[0];
+        dstPtr += 2 * dstStride[0];
+        i = 2;
+    }
 
-    for (i = 2; i < srcSliceH - 2; i += 2) {
+    for (; i < bayer_interpolate_end(c, srcSliceY, srcSliceH); i += 2) {
         interpolate(srcPtr, srcStride[0], dstPtr, dstStride[0], c->srcW);
         srcPtr += 2 * srcStride[0];
         dstPtr += 2 * dstStride[0];
@@ -1451,13 +1472,17 @@ static int bayer_to_yv12_wrapper(SwsContext *c, const uint8_t* src[], int srcStr
 
     av_assert0(srcSliceH > 1);
 
-    copy(srcPtr, srcStride[0], dstY, dstU, dstV, dstStride[0], c->srcW, c->input_rgb2yuv_table);
-    srcPtr += 2 * srcStride[0];
-    dstY   += 2 * dstStride[0];
-    dstU   +=     dstStride[1];
-    dstV   +=     dstStride[1];
+    i = 0;
+    if (!c->convert_dst_slice || !srcSliceY) {
+        copy(srcPtr, srcStride[0], dstY, dstU, dstV, dstStride[0], c->srcW, c->input_rgb2yuv_table);
+        srcPtr += 2 * srcStride[0];
+        dstY   += 2 * dstStride[0];
+        dstU   +=     dstStride[1];
+        dstV   +=     dstStride[1];
+        i = 2;
+    }
 
-    for (i = 2; i < srcSliceH - 2; i += 2) {
+    for (; i < bayer_interpolate_end(c, srcSliceY, srcSliceH); i += 2) {
         interpolate(srcPtr, srcStride[0], dstY, dstU, dstV, dstStride[0], c->srcW, c->input_rgb2yuv_table);
         srcPtr += 2 * srcStride[0];
         dstY   += 2 * dstStride[0];
@@ -1802,7 +1827,7 @@ static int packedCopyWrapper(SwsContext *c, const uint8_t *src[],
         }\
     } else if (shiftonly) {\
         for (i = 0; i < height; i++) {\
-            const uint8_t *dither= dithers[shift-1][i&7];\
+            const uint8_t *dither= dithers[shift-1][(y + i) & 7];\
             for (j = 0; j < length-7; j+=8) {\
                 tmp = (bswap(src[j+0]) + dither[0])>>shift; dst[j+0] = dbswap(tmp - (tmp>>dst_depth));\
                 tmp = (bswap(src[j+1]) + dither[1])>>shift; dst[j+1] = dbswap(tmp - (tmp>>dst_depth));\
@@ -1821,7 +1846,7 @@ static int packedCopyWrapper(SwsContext *c, const uint8_t *src[],
         }\
     } else {\
         for (i = 0; i < height; i++) {\
-            const uint8_t *dither= dithers[shift-1][i&7];\
+            const uint8_t *dither= dithers[shift-1][(y + i) & 7];\
             for (j = 0; j < length-7; j+=8) {\
                 tmp = bswap(src[j+0]); dst[j+0] = dbswap((tmp - (tmp>>dst_depth) + dither[0])>>shift);\
                 tmp = bswap(src[j+1]); dst[j+1] = dbswap((tmp - (tmp>>dst_depth) + dither[1])>>shift);\
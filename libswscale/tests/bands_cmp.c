@@ -0,0 +1,266 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Check that the cascaded conversions, which run their steps band by band
+ * when a whole frame is converted at once, give the same result as when
+ * every step converts the whole intermediate picture one after another.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavutil/frame.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/lfg.h"
+#include "libavutil/log.h"
+#include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
+
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+
+enum CascadeMode {
+    MODE_ALPHA_BLEND,
+    MODE_GAMMA,
+    MODE_MATRIX,
+    MODE_NB,
+};
+
+static const enum AVPixelFormat hub_fmts[] = {
+    AV_PIX_FMT_YUV420P,   AV_PIX_FMT_GBRP12LE,    AV_PIX_FMT_NV12,
+    AV_PIX_FMT_RGB24,     AV_PIX_FMT_YUV444P16LE, AV_PIX_FMT_YUVA420P,
+};
+
+/* The pictures are large enough for the intermediate ones to be split into
+ * several bands, the linear ones of the gamma mode have 64 bit pixels. The
+ * gamma mode is slow to set up and goes through the same linear steps
+ * whatever the output, only convert to the first hub formats with it. */
+static const struct {
+    const char *name;
+    int src_w, src_h, dst_w, dst_h;
+    int nb_hubs;
+} modes[MODE_NB] = {
+    [MODE_ALPHA_BLEND] = { "alphablend", 512, 360, 512, 360, FF_ARRAY_ELEMS(hub_fmts) },
+    [MODE_GAMMA]       = { "gamma",      256, 300, 200, 234, 2 },
+    [MODE_MATRIX]      = { "matrix",     512, 360, 512, 360, FF_ARRAY_ELEMS(hub_fmts) },
+};
+
+static AVFrame *alloc_frame(enum AVPixelFormat fmt, int w, int h)
+{
+    AVFrame *frame = av_frame_alloc();
+
+    if (!frame)
+        return NULL;
+
+    frame->format = fmt;
+    frame->width  = w;
+    frame->height = h;
+    if (av_frame_get_buffer(frame, 0) < 0) {
+        av_frame_free(&frame);
+        return NULL;
+    }
+
+    /* some converters leave parts of the picture alone */
+    for (int p = 0; p < 4 && frame->buf[p]; p++)
+        memset(frame->buf[p]->data, 0, frame->buf[p]->size);
+
+    return frame;
+}
+
+static struct SwsContext *alloc_context(enum AVPixelFormat src_fmt,
+                                        enum AVPixelFormat dst_fmt,
+                                        enum CascadeMode mode)
+{
+    struct SwsContext *sws = sws_alloc_context();
+
+    if (!sws)
+        return NULL;
+
+    av_opt_set_int(sws, "srcw",       modes[mode].src_w, 0);
+    av_opt_set_int(sws, "srch",       modes[mode].src_h, 0);
+    av_opt_set_int(sws, "src_format", src_fmt,           0);
+    av_opt_set_int(sws, "dstw",       modes[mode].dst_w, 0);
+    av_opt_set_int(sws, "dsth",       modes[mode].dst_h, 0);
+    av_opt_set_int(sws, "dst_format", dst_fmt,           0);
+    av_opt_set_int(sws, "sws_flags",  SWS_BICUBIC, 0);
+    if (mode == MODE_ALPHA_BLEND)
+        av_opt_set_int(sws, "alphablend", SWS_ALPHA_BLEND_CHECKERBOARD, 0);
+    if (mode == MODE_GAMMA)
+        av_opt_set_int(sws, "gamma", 1, 0);
+    if (sws_init_context(sws, NULL, NULL) < 0)
+        goto fail;
+
+    if (mode == MODE_MATRIX &&
+        sws_setColorspaceDetails(sws, sws_getCoefficients(SWS_CS_ITU601), 0,
+                                 sws_getCoefficients(SWS_CS_ITU709), 0,
+                                 0, 1 << 16, 1 << 16) < 0)
+        goto fail;
+
+    return sws;
+fail:
+    sws_freeContext(sws);
+    return NULL;
+}
+
+/* run every step over the whole picture, like before bands were used */
+static int scale_unbanded(struct SwsContext *sws, AVFrame *dst, const AVFrame *src)
+{
+    const uint8_t * const *in = (const uint8_t * const *)src->data;
+    const int *in_stride = src->linesize;
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(sws->cascaded_context) && sws->cascaded_context[i]; i++) {
+        struct SwsContext *step = sws->cascaded_context[i];
+        const int last = i + 1 == FF_ARRAY_ELEMS(sws->cascaded_context) ||
+                         !sws->cascaded_context[i + 1];
+        uint8_t * const *out = last ? dst->data : i ? sws->cascaded1_tmp : sws->cascaded_tmp;
+        const int *out_stride = last ? dst->linesize :
+                                i ? sws->cascaded1_tmpStride : sws->cascaded_tmpStride;
+        int ret = sws_scale(step, in, in_stride, 0, step->srcH, out, out_stride);
+
+        if (ret < 0)
+            return ret;
+        in        = (const uint8_t * const *)out;
+        in_stride = out_stride;
+    }
+
+    return 0;
+}
+
+static int frames_equal(const AVFrame *a, const AVFrame *b)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(a->format);
+    int linesize[4] = { 0 };
+    int p, y;
+
+    av_image_fill_linesizes(linesize, a->format, a->width);
+    for (p = 0; p < 4 && a->data[p]; p++) {
+        const int h = (p == 1 || p == 2) ? AV_CEIL_RSHIFT(a->height, desc->log2_chroma_h)
+                                         : a->height;
+
+        /* palettes are not converted */
+        if (p == 1 && (desc->flags & AV_PIX_FMT_FLAG_PAL))
+            break;
+
+        for (y = 0; y < h; y++)
+            if (memcmp(a->data[p] + y * a->linesize[p],
+                       b->data[p] + y * b->linesize[p], linesize[p]))
+                return 0;
+    }
+
+    return 1;
+}
+
+static void fill_frame(AVFrame *frame, AVLFG *rand)
+{
+    int p, i;
+
+    for (p = 0; p < 4 && frame->buf[p]; p++)
+        for (i = 0; i < frame->buf[p]->size; i++)
+            frame->buf[p]->data[i] = av_lfg_get(rand);
+}
+
+static int nb_tested, nb_skipped;
+
+static int test(enum AVPixelFormat src_fmt, enum AVPixelFormat dst_fmt,
+                enum CascadeMode mode, const AVFrame *src)
+{
+    struct SwsContext *sws_band = NULL, *sws_ref = NULL;
+    AVFrame *band = NULL, *ref = NULL;
+    int ret;
+
+    sws_band = alloc_context(src_fmt, dst_fmt, mode);
+    /* only conversions run in several steps are done in bands */
+    if (!sws_band || !sws_band->cascaded_context[0]) {
+        sws_freeContext(sws_band);
+        nb_skipped++;
+        return 0;
+    }
+    /* a separate context, so that no state is carried over between both */
+    sws_ref = alloc_context(src_fmt, dst_fmt, mode);
+    if (!sws_ref) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    band = alloc_frame(dst_fmt, sws_band->dstW, sws_band->dstH);
+    ref  = alloc_frame(dst_fmt, sws_band->dstW, sws_band->dstH);
+    if (!band || !ref) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    if ((ret = sws_scale_frame(sws_band, band, src)) < 0 ||
+        (ret = scale_unbanded(sws_ref, ref, src)) < 0) {
+        fprintf(stderr, "Failed to convert %s -> %s (%s)\n",
+                av_get_pix_fmt_name(src_fmt), av_get_pix_fmt_name(dst_fmt),
+                modes[mode].name);
+        goto end;
+    }
+
+    ret = 0;
+    nb_tested++;
+    if (!frames_equal(band, ref)) {
+        fprintf(stderr, "Mismatch %s -> %s (%s)\n",
+                av_get_pix_fmt_name(src_fmt), av_get_pix_fmt_name(dst_fmt),
+                modes[mode].name);
+        ret = AVERROR(EINVAL);
+    }
+
+end:
+    sws_freeContext(sws_band);
+    sws_freeContext(sws_ref);
+    av_frame_free(&band);
+    av_frame_free(&ref);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    const AVPixFmtDescriptor *desc = NULL;
+    int failed = 0, i, mode;
+    AVLFG rand;
+
+    av_lfg_init(&rand, 1);
+    av_log_set_level(AV_LOG_QUIET);
+
+    while ((desc = av_pix_fmt_desc_next(desc))) {
+        enum AVPixelFormat fmt = av_pix_fmt_desc_get_id(desc);
+
+        if (!sws_isSupportedInput(fmt) || (desc->flags & AV_PIX_FMT_FLAG_HWACCEL))
+            continue;
+
+        for (mode = 0; mode < MODE_NB; mode++) {
+            AVFrame *src = alloc_frame(fmt, modes[mode].src_w, modes[mode].src_h);
+
+            if (!src)
+                return 1;
+            fill_frame(src, &rand);
+
+            for (i = 0; i < modes[mode].nb_hubs; i++)
+                failed |= test(fmt, hub_fmts[i], mode, src) < 0;
+
+            av_frame_free(&src);
+        }
+    }
+
+    printf("%d conversions compared, %d skipped\n", nb_tested, nb_skipped);
+
+    return failed;
+}
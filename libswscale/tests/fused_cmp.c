@@ -0,0 +1,257 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Compare the fused scalers, enabled with the "fused" option, against the
+ * generic scaler and optionally time both.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavutil/avutil.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/lfg.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
+#include "libavutil/time.h"
+
+#include "libswscale/swscale.h"
+
+static const struct {
+    enum AVPixelFormat src, dst;
+} conversions[] = {
+    { AV_PIX_FMT_YUV420P,     AV_PIX_FMT_YUV420P     },
+    { AV_PIX_FMT_YUVJ420P,    AV_PIX_FMT_YUV420P     },
+    { AV_PIX_FMT_YUV420P,     AV_PIX_FMT_YUVJ420P    },
+    { AV_PIX_FMT_YUVJ420P,    AV_PIX_FMT_NV12        },
+    { AV_PIX_FMT_YUV420P,     AV_PIX_FMT_YUV420P10LE },
+    { AV_PIX_FMT_YUV420P10LE, AV_PIX_FMT_YUV420P     },
+    { AV_PIX_FMT_YUV420P10LE, AV_PIX_FMT_NV12        },
+    { AV_PIX_FMT_YUV420P10LE, AV_PIX_FMT_P010LE      },
+};
+
+static const struct {
+    int src_w, src_h, dst_w, dst_h;
+} sizes[] = {
+    { 352, 288, 176, 144 },
+    { 320, 240, 213, 161 },
+    { 352, 288, 352, 288 },
+};
+
+static void fill_source(uint8_t *data[4], const int linesize[4],
+                        enum AVPixelFormat fmt, int w, int h)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmt);
+    const int depth = desc->comp[0].depth;
+    AVLFG rand;
+    int p, x, y;
+
+    av_lfg_init(&rand, 1);
+    for (p = 0; p < 3; p++) {
+        const int pw = p ? AV_CEIL_RSHIFT(w, desc->log2_chroma_w) : w;
+        const int ph = p ? AV_CEIL_RSHIFT(h, desc->log2_chroma_h) : h;
+
+        for (y = 0; y < ph; y++) {
+            for (x = 0; x < pw; x++) {
+                /* a gradient with some noise and a few sharp edges, kept
+                 * away from the clipping limits, where the results depend
+                 * on the order of the filters */
+                int v = (x * 3 + y * 2 + p * 50) % 112;
+                v += (av_lfg_get(&rand) & 15) + ((x / 16 + y / 16) & 1) * 60 + 32;
+                v = (v << (depth - 8)) | (v >> (16 - depth));
+                if (depth > 8)
+                    AV_WN16(data[p] + y * linesize[p] + 2 * x, v);
+                else
+                    data[p][y * linesize[p] + x] = v;
+            }
+        }
+    }
+}
+
+static int max_diff(uint8_t *a[4], uint8_t *b[4], const int linesize[4],
+                    enum AVPixelFormat fmt, int w, int h)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmt);
+    const int bytes = desc->comp[0].depth > 8 ? 2 : 1;
+    const int shift = desc->comp[0].shift;
+    int width[4] = { 0 };
+    int p, x, y, diff = 0;
+
+    av_image_fill_linesizes(width, fmt, w);
+    for (p = 0; p < 4 && width[p]; p++) {
+        const int ph = p ? AV_CEIL_RSHIFT(h, desc->log2_chroma_h) : h;
+
+        for (y = 0; y < ph; y++) {
+            const uint8_t *la = a[p] + y * linesize[p];
+            const uint8_t *lb = b[p] + y * linesize[p];
+
+            for (x = 0; x < width[p] / bytes; x++) {
+                int va = bytes > 1 ? AV_RN16(la + 2 * x) >> shift : la[x];
+                int vb = bytes > 1 ? AV_RN16(lb + 2 * x) >> shift : lb[x];
+                diff = FFMAX(diff, abs(va - vb));
+            }
+        }
+    }
+
+    return diff;
+}
+
+static struct SwsContext *alloc_context(int src_w, int src_h, enum AVPixelFormat src_fmt,
+                                        int dst_w, int dst_h, enum AVPixelFormat dst_fmt,
+                                        int flags, int fused)
+{
+    struct SwsContext *sws = sws_alloc_context();
+
+    if (!sws)
+        return NULL;
+
+    av_opt_set_int(sws, "srcw",       src_w,       0);
+    av_opt_set_int(sws, "srch",       src_h,       0);
+    av_opt_set_int(sws, "src_format", src_fmt,     0);
+    av_opt_set_int(sws, "dstw",       dst_w,       0);
+    av_opt_set_int(sws, "dsth",       dst_h,       0);
+    av_opt_set_int(sws, "dst_format", dst_fmt,     0);
+    av_opt_set_int(sws, "sws_flags",  flags,       0);
+    av_opt_set_int(sws, "fused",      fused,       0);
+
+    if (sws_init_context(sws, NULL, NULL) < 0) {
+        sws_freeContext(sws);
+        return NULL;
+    }
+
+    return sws;
+}
+
+/* returns the fastest of the runs, which is the least disturbed by the
+ * rest of the system */
+static int64_t run(struct SwsContext *sws, uint8_t *src[4], const int src_linesize[4],
+                   int src_h, uint8_t *dst[4], const int dst_linesize[4], int iterations)
+{
+    int64_t best = INT64_MAX;
+    int i;
+
+    for (i = 0; i < iterations; i++) {
+        int64_t start = av_gettime_relative();
+        sws_scale(sws, (const uint8_t * const *)src, src_linesize, 0, src_h,
+                  dst, dst_linesize);
+        best = FFMIN(best, av_gettime_relative() - start);
+    }
+
+    return best;
+}
+
+static int test(enum AVPixelFormat src_fmt, enum AVPixelFormat dst_fmt,
+                int src_w, int src_h, int dst_w, int dst_h, int iterations)
+{
+    uint8_t *src[4] = { NULL }, *fused[4] = { NULL }, *ref[4] = { NULL };
+    int src_linesize[4], dst_linesize[4], ref_linesize[4];
+    struct SwsContext *sws_fused = NULL, *sws_ref = NULL, *sws_generic = NULL;
+    int64_t time_fused, time_generic;
+    int diff, tolerance, ret;
+
+    if ((ret = av_image_alloc(src, src_linesize, src_w, src_h, src_fmt, 16)) < 0 ||
+        (ret = av_image_alloc(fused, dst_linesize, dst_w, dst_h, dst_fmt, 16)) < 0 ||
+        (ret = av_image_alloc(ref, ref_linesize, dst_w, dst_h, dst_fmt, 16)) < 0)
+        goto end;
+
+    /* the reference is the bitexact C scaler, so that the result does not
+     * depend on the SIMD scalers of the build */
+    sws_fused = alloc_context(src_w, src_h, src_fmt, dst_w, dst_h, dst_fmt,
+                              SWS_BICUBIC, 1);
+    sws_ref   = alloc_context(src_w, src_h, src_fmt, dst_w, dst_h, dst_fmt,
+                              SWS_BICUBIC | SWS_BITEXACT | SWS_ACCURATE_RND, 0);
+    if (!sws_fused || !sws_ref) {
+        fprintf(stderr, "Failed to get %s -> %s\n", av_get_pix_fmt_name(src_fmt),
+                av_get_pix_fmt_name(dst_fmt));
+        ret = AVERROR(EINVAL);
+        goto end;
+    }
+
+    fill_source(src, src_linesize, src_fmt, src_w, src_h);
+    time_fused = run(sws_fused, src, src_linesize, src_h, fused, dst_linesize, iterations);
+    run(sws_ref, src, src_linesize, src_h, ref, ref_linesize, 1);
+
+    /* the fused scalers round at different points, which is worth one step;
+     * the generic scaler also clips the intermediate lines when converting
+     * the range, which can add one more */
+    diff      = max_diff(fused, ref, dst_linesize, dst_fmt, dst_w, dst_h);
+    tolerance = 1 + ((src_fmt == AV_PIX_FMT_YUVJ420P) != (dst_fmt == AV_PIX_FMT_YUVJ420P));
+    /* only print whether the difference is tolerated, its exact value
+     * depends on the reference rounding */
+    printf("%s %dx%d -> %s %dx%d: %s\n",
+           av_get_pix_fmt_name(src_fmt), src_w, src_h,
+           av_get_pix_fmt_name(dst_fmt), dst_w, dst_h,
+           diff <= tolerance ? "ok" : "mismatch");
+    if (diff > tolerance)
+        fprintf(stderr, "max diff %d, tolerance %d\n", diff, tolerance);
+    if (iterations > 1) {
+        /* time the default scaler of the build, with its SIMD scalers */
+        sws_generic = alloc_context(src_w, src_h, src_fmt, dst_w, dst_h, dst_fmt,
+                                    SWS_BICUBIC, 0);
+        if (!sws_generic) {
+            ret = AVERROR(ENOMEM);
+            goto end;
+        }
+        time_generic = run(sws_generic, src, src_linesize, src_h, ref, ref_linesize,
+                           iterations);
+        printf("    fused %"PRId64" us, generic %"PRId64" us per frame\n",
+               time_fused, time_generic);
+    }
+    ret = diff > tolerance;
+
+end:
+    sws_freeContext(sws_fused);
+    sws_freeContext(sws_ref);
+    sws_freeContext(sws_generic);
+    av_freep(&src[0]);
+    av_freep(&fused[0]);
+    av_freep(&ref[0]);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    int iterations = 1;
+    int i, j, ret = 0;
+
+    if (argc > 2 && !strcmp(argv[1], "-bench")) {
+        iterations = atoi(argv[2]);
+        if (iterations <= 0) {
+            fprintf(stderr, "usage: %s [-bench <iterations>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    for (i = 0; i < FF_ARRAY_ELEMS(conversions); i++) {
+        if (iterations > 1) {
+            ret |= test(conversions[i].src, conversions[i].dst,
+                        1920, 1080, 1280, 720, iterations);
+            continue;
+        }
+        for (j = 0; j < FF_ARRAY_ELEMS(sizes); j++)
+            ret |= test(conversions[i].src, conversions[i].dst,
+                        sizes[j].src_w, sizes[j].src_h,
+                        sizes[j].dst_w, sizes[j].dst_h, 1);
+    }
+
+    return !!ret;
+}
@@ -0,0 +1,222 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Check that the fixed phase horizontal scalers, used for integer ratio
+ * scales, give the same result as the generic horizontal scaler.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavutil/frame.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/lfg.h"
+#include "libavutil/log.h"
+#include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
+
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+
+#define DST_W  200
+#define SRC_H  24
+#define DST_H  17
+#define MAX_RATIO 4
+
+/* 8 and 16 bit sources, 15 and 19 bit intermediates */
+static const enum AVPixelFormat src_fmts[] = {
+    AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV420P10LE, AV_PIX_FMT_YUV444P16LE,
+    AV_PIX_FMT_GRAY8,   AV_PIX_FMT_RGB24,       AV_PIX_FMT_NV12,
+};
+
+static const enum AVPixelFormat dst_fmts[] = {
+    AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUV420P10LE, AV_PIX_FMT_YUV444P16LE,
+    AV_PIX_FMT_GRAY8,
+};
+
+static const int flags[] = {
+    SWS_BILINEAR, SWS_BICUBIC, SWS_LANCZOS, SWS_AREA, SWS_GAUSS,
+};
+
+static AVFrame *alloc_frame(enum AVPixelFormat fmt, int w, int h)
+{
+    AVFrame *frame = av_frame_alloc();
+
+    if (!frame)
+        return NULL;
+
+    frame->format = fmt;
+    frame->width  = w;
+    frame->height = h;
+    if (av_frame_get_buffer(frame, 0) < 0) {
+        av_frame_free(&frame);
+        return NULL;
+    }
+
+    return frame;
+}
+
+static struct SwsContext *alloc_context(const AVFrame *src, enum AVPixelFormat dst_fmt,
+                                        int flags)
+{
+    struct SwsContext *sws = sws_alloc_context();
+
+    if (!sws)
+        return NULL;
+
+    av_opt_set_int(sws, "srcw",       src->width,  0);
+    av_opt_set_int(sws, "srch",       src->height, 0);
+    av_opt_set_int(sws, "src_format", src->format, 0);
+    av_opt_set_int(sws, "dstw",       DST_W,       0);
+    av_opt_set_int(sws, "dsth",       DST_H,       0);
+    av_opt_set_int(sws, "dst_format", dst_fmt,     0);
+    av_opt_set_int(sws, "sws_flags",  flags,       0);
+    if (sws_init_context(sws, NULL, NULL) < 0) {
+        sws_freeContext(sws);
+        return NULL;
+    }
+
+    return sws;
+}
+
+/* returns whether the context used the fixed phase scalers */
+static int disable_fixed(SwsContext *c)
+{
+    int used = !!(c->hyScaleFixed || c->hcScaleFixed);
+
+    c->hyScaleFixed = NULL;
+    c->hcScaleFixed = NULL;
+    for (int i = 0; i < FF_ARRAY_ELEMS(c->cascaded_context); i++)
+        if (c->cascaded_context[i])
+            used |= disable_fixed(c->cascaded_context[i]);
+
+    return used;
+}
+
+static int frames_equal(const AVFrame *a, const AVFrame *b)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(a->format);
+    int linesize[4] = { 0 };
+    int p, y;
+
+    av_image_fill_linesizes(linesize, a->format, a->width);
+    for (p = 0; p < 4 && a->data[p]; p++) {
+        const int h = (p == 1 || p == 2) ? AV_CEIL_RSHIFT(a->height, desc->log2_chroma_h)
+                                         : a->height;
+
+        for (y = 0; y < h; y++)
+            if (memcmp(a->data[p] + y * a->linesize[p],
+                       b->data[p] + y * b->linesize[p], linesize[p]))
+                return 0;
+    }
+
+    return 1;
+}
+
+static void fill_frame(AVFrame *frame, AVLFG *rand)
+{
+    int p, i;
+
+    for (p = 0; p < 4 && frame->buf[p]; p++)
+        for (i = 0; i < frame->buf[p]->size; i++)
+            frame->buf[p]->data[i] = av_lfg_get(rand);
+}
+
+static int test(const AVFrame *src, enum AVPixelFormat dst_fmt, int flags,
+                int *nb_fixed)
+{
+    struct SwsContext *sws_fixed, *sws_ref;
+    AVFrame *fixed = NULL, *ref = NULL;
+    int ret;
+
+    sws_fixed = alloc_context(src, dst_fmt, flags);
+    sws_ref   = alloc_context(src, dst_fmt, flags);
+    if (!sws_fixed || !sws_ref) {
+        fprintf(stderr, "Failed to init %s -> %s\n",
+                av_get_pix_fmt_name(src->format), av_get_pix_fmt_name(dst_fmt));
+        ret = AVERROR(EINVAL);
+        goto end;
+    }
+    *nb_fixed += disable_fixed(sws_ref);
+
+    fixed = alloc_frame(dst_fmt, DST_W, DST_H);
+    ref   = alloc_frame(dst_fmt, DST_W, DST_H);
+    if (!fixed || !ref) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    if ((ret = sws_scale_frame(sws_fixed, fixed, src)) < 0 ||
+        (ret = sws_scale_frame(sws_ref,   ref,   src)) < 0) {
+        fprintf(stderr, "Failed to scale %s -> %s\n",
+                av_get_pix_fmt_name(src->format), av_get_pix_fmt_name(dst_fmt));
+        goto end;
+    }
+
+    ret = 0;
+    if (!frames_equal(fixed, ref)) {
+        fprintf(stderr, "Mismatch %s %dx%d -> %s %dx%d, flags 0x%x\n",
+                av_get_pix_fmt_name(src->format), src->width, src->height,
+                av_get_pix_fmt_name(dst_fmt), DST_W, DST_H, flags);
+        ret = AVERROR(EINVAL);
+    }
+
+end:
+    sws_freeContext(sws_fixed);
+    sws_freeContext(sws_ref);
+    av_frame_free(&fixed);
+    av_frame_free(&ref);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    int failed = 0, nb_tests = 0, nb_fixed = 0;
+    AVLFG rand;
+
+    av_lfg_init(&rand, 1);
+    av_log_set_level(AV_LOG_QUIET);
+
+    for (int s = 0; s < FF_ARRAY_ELEMS(src_fmts); s++) {
+        /* a ratio of 1 is only scaled vertically */
+        for (int ratio = 1; ratio <= MAX_RATIO; ratio++) {
+            AVFrame *src = alloc_frame(src_fmts[s], DST_W * ratio, SRC_H);
+
+            if (!src)
+                return 1;
+            fill_frame(src, &rand);
+
+            for (int d = 0; d < FF_ARRAY_ELEMS(dst_fmts); d++) {
+                for (int f = 0; f < FF_ARRAY_ELEMS(flags); f++) {
+                    failed |= test(src, dst_fmts[d], flags[f], &nb_fixed) < 0;
+                    nb_tests++;
+                }
+            }
+            av_frame_free(&src);
+        }
+    }
+
+    /* the number of them that used the fixed phase scalers depends on the
+     * SIMD scalers of the build, see ff_sws_init_scale() */
+    printf("%d conversions compared\n", nb_tests);
+    fprintf(stderr, "%d conversions used the fixed phase scalers\n", nb_fixed);
+
+    return failed;
+}
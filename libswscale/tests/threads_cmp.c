@@ -0,0 +1,231 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Check that converting a picture on several threads, which splits the
+ * output into bands of rows, gives the same result as converting it on a
+ * single thread. The pictures are not scaled, so that every special
+ * converter in swscale_unscaled.c is covered.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavutil/frame.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/lfg.h"
+#include "libavutil/log.h"
+#include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
+
+#include "libswscale/swscale.h"
+
+#define WIDTH   88
+#define HEIGHT  70
+/* an odd number of threads, so that the bands are not all alike */
+#define THREADS 3
+
+static const enum AVPixelFormat hub_fmts[] = {
+    AV_PIX_FMT_YUV420P,   AV_PIX_FMT_YUV420P10LE, AV_PIX_FMT_YUV444P16LE,
+    AV_PIX_FMT_P010LE,    AV_PIX_FMT_NV12,        AV_PIX_FMT_YUYV422,
+    AV_PIX_FMT_RGB48LE,   AV_PIX_FMT_GBRP12LE,    AV_PIX_FMT_RGBA,
+};
+
+static AVFrame *alloc_frame(enum AVPixelFormat fmt)
+{
+    AVFrame *frame = av_frame_alloc();
+
+    if (!frame)
+        return NULL;
+
+    frame->format = fmt;
+    frame->width  = WIDTH;
+    frame->height = HEIGHT;
+    if (av_frame_get_buffer(frame, 0) < 0) {
+        av_frame_free(&frame);
+        return NULL;
+    }
+
+    /* some converters leave parts of the picture alone */
+    for (int p = 0; p < 4 && frame->buf[p]; p++)
+        memset(frame->buf[p]->data, 0, frame->buf[p]->size);
+
+    return frame;
+}
+
+static struct SwsContext *alloc_context(enum AVPixelFormat src_fmt,
+                                        enum AVPixelFormat dst_fmt, int threads)
+{
+    struct SwsContext *sws = sws_alloc_context();
+
+    if (!sws)
+        return NULL;
+
+    av_opt_set_int(sws, "srcw",       WIDTH,   0);
+    av_opt_set_int(sws, "srch",       HEIGHT,  0);
+    av_opt_set_int(sws, "src_format", src_fmt, 0);
+    av_opt_set_int(sws, "dstw",       WIDTH,   0);
+    av_opt_set_int(sws, "dsth",       HEIGHT,  0);
+    av_opt_set_int(sws, "dst_format", dst_fmt, 0);
+    av_opt_set_int(sws, "threads",    threads, 0);
+    if (sws_init_context(sws, NULL, NULL) < 0) {
+        sws_freeContext(sws);
+        return NULL;
+    }
+
+    return sws;
+}
+
+static int frames_equal(const AVFrame *a, const AVFrame *b)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(a->format);
+    int linesize[4] = { 0 };
+    int p, y;
+
+    av_image_fill_linesizes(linesize, a->format, a->width);
+    for (p = 0; p < 4 && a->data[p]; p++) {
+        const int h = (p == 1 || p == 2) ? AV_CEIL_RSHIFT(a->height, desc->log2_chroma_h)
+                                         : a->height;
+
+        /* palettes are not converted */
+        if (p == 1 && (desc->flags & AV_PIX_FMT_FLAG_PAL))
+            break;
+
+        for (y = 0; y < h; y++)
+            if (memcmp(a->data[p] + y * a->linesize[p],
+                       b->data[p] + y * b->linesize[p], linesize[p]))
+                return 0;
+    }
+
+    return 1;
+}
+
+static void fill_frame(AVFrame *frame, AVLFG *rand)
+{
+    int p, i;
+
+    for (p = 0; p < 4 && frame->buf[p]; p++)
+        for (i = 0; i < frame->buf[p]->size; i++)
+            frame->buf[p]->data[i] = av_lfg_get(rand);
+}
+
+static int nb_tested, nb_skipped;
+
+static int test(enum AVPixelFormat src_fmt, enum AVPixelFormat dst_fmt,
+                AVFrame *src)
+{
+    struct SwsContext *sws_ref = NULL, *sws_thr = NULL;
+    AVFrame *ref = NULL, *thr = NULL;
+    int ret;
+
+    sws_ref = alloc_context(src_fmt, dst_fmt, 1);
+    if (!sws_ref) {
+        printf("skipped %s -> %s\n", av_get_pix_fmt_name(src_fmt),
+               av_get_pix_fmt_name(dst_fmt));
+        nb_skipped++;
+        return 0;
+    }
+    /* builds without threads fall back to a single one */
+    sws_thr = alloc_context(src_fmt, dst_fmt, THREADS);
+    if (!sws_thr) {
+        fprintf(stderr, "Failed to init %s -> %s with %d threads\n",
+                av_get_pix_fmt_name(src_fmt), av_get_pix_fmt_name(dst_fmt),
+                THREADS);
+        ret = AVERROR(EINVAL);
+        goto end;
+    }
+
+    ref = alloc_frame(dst_fmt);
+    thr = alloc_frame(dst_fmt);
+    if (!ref || !thr) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    if ((ret = sws_scale_frame(sws_ref, ref, src)) < 0 ||
+        (ret = sws_scale_frame(sws_thr, thr, src)) < 0) {
+        fprintf(stderr, "Failed to convert %s -> %s\n",
+                av_get_pix_fmt_name(src_fmt), av_get_pix_fmt_name(dst_fmt));
+        goto end;
+    }
+
+    ret = 0;
+    nb_tested++;
+    if (!frames_equal(ref, thr)) {
+        fprintf(stderr, "Mismatch %s -> %s\n",
+                av_get_pix_fmt_name(src_fmt), av_get_pix_fmt_name(dst_fmt));
+        ret = AVERROR(EINVAL);
+    }
+
+end:
+    sws_freeContext(sws_ref);
+    sws_freeContext(sws_thr);
+    av_frame_free(&ref);
+    av_frame_free(&thr);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    const AVPixFmtDescriptor *desc = NULL;
+    int failed = 0, i;
+    AVLFG rand;
+
+    av_lfg_init(&rand, 1);
+    av_log_set_level(AV_LOG_QUIET);
+
+    while ((desc = av_pix_fmt_desc_next(desc))) {
+        enum AVPixelFormat fmt = av_pix_fmt_desc_get_id(desc);
+        AVFrame *src;
+
+        if (!sws_isSupportedInput(fmt) && !sws_isSupportedOutput(fmt))
+            continue;
+        if (desc->flags & AV_PIX_FMT_FLAG_HWACCEL)
+            continue;
+
+        if (!(src = alloc_frame(fmt)))
+            return 1;
+        fill_frame(src, &rand);
+
+        for (i = 0; i < FF_ARRAY_ELEMS(hub_fmts); i++) {
+            AVFrame *hub;
+
+            if (sws_isSupportedInput(fmt) && sws_isSupportedOutput(hub_fmts[i]))
+                failed |= test(fmt, hub_fmts[i], src) < 0;
+
+            if (!sws_isSupportedInput(hub_fmts[i]) || !sws_isSupportedOutput(fmt))
+                continue;
+            if (!(hub = alloc_frame(hub_fmts[i]))) {
+                av_frame_free(&src);
+                return 1;
+            }
+            fill_frame(hub, &rand);
+            failed |= test(hub_fmts[i], fmt, hub) < 0;
+            av_frame_free(&hub);
+        }
+        if (sws_isSupportedInput(fmt) && sws_isSupportedOutput(fmt))
+            failed |= test(fmt, fmt, src) < 0;
+
+        av_frame_free(&src);
+    }
+
+    printf("%d conversions compared, %d skipped\n", nb_tested, nb_skipped);
+
+    return failed;
+}
@@ -0,0 +1,222 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Check that scaling a picture in column tiles gives the same result as
+ * scaling its whole width at once, when scaling up and down from and to
+ * every supported format.
+ */
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavutil/frame.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/lfg.h"
+#include "libavutil/log.h"
+#include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
+
+#include "libswscale/swscale.h"
+
+#define SRC_W 300
+#define SRC_H 24
+/* the smallest tile width, so that the pictures are split in many tiles */
+#define TILE_W 64
+
+static const enum AVPixelFormat hub_fmts[] = {
+    AV_PIX_FMT_YUV420P,   AV_PIX_FMT_YUV420P10LE, AV_PIX_FMT_YUV444P16LE,
+    AV_PIX_FMT_NV12,      AV_PIX_FMT_YUYV422,     AV_PIX_FMT_RGB24,
+    AV_PIX_FMT_GBRP12LE,  AV_PIX_FMT_RGBA64LE,    AV_PIX_FMT_GRAYF32LE,
+};
+
+/* the output widths are multiples of 8, as the bits of incomplete bytes of
+ * bitstream formats and the second luma sample of an incomplete pair of
+ * packed 4:2:2 formats are not defined */
+static const struct {
+    int w, h, flags;
+} sizes[] = {
+    { 232, 17, SWS_BICUBIC  },
+    { 520, 30, SWS_LANCZOS  },
+    {  96,  9, SWS_AREA     },
+};
+
+static AVFrame *alloc_frame(enum AVPixelFormat fmt, int w, int h)
+{
+    AVFrame *frame = av_frame_alloc();
+
+    if (!frame)
+        return NULL;
+
+    frame->format = fmt;
+    frame->width  = w;
+    frame->height = h;
+    if (av_frame_get_buffer(frame, 0) < 0) {
+        av_frame_free(&frame);
+        return NULL;
+    }
+
+    for (int p = 0; p < 4 && frame->buf[p]; p++)
+        memset(frame->buf[p]->data, 0, frame->buf[p]->size);
+
+    return frame;
+}
+
+static struct SwsContext *alloc_context(const AVFrame *src, enum AVPixelFormat dst_fmt,
+                                        int w, int h, int flags, int tile_width)
+{
+    struct SwsContext *sws = sws_alloc_context();
+
+    if (!sws)
+        return NULL;
+
+    av_opt_set_int(sws, "srcw",       src->width,  0);
+    av_opt_set_int(sws, "srch",       src->height, 0);
+    av_opt_set_int(sws, "src_format", src->format, 0);
+    av_opt_set_int(sws, "dstw",       w,           0);
+    av_opt_set_int(sws, "dsth",       h,           0);
+    av_opt_set_int(sws, "dst_format", dst_fmt,     0);
+    av_opt_set_int(sws, "sws_flags",  flags,       0);
+    av_opt_set_int(sws, "tile_width", tile_width,  0);
+    if (sws_init_context(sws, NULL, NULL) < 0) {
+        sws_freeContext(sws);
+        return NULL;
+    }
+
+    return sws;
+}
+
+static int frames_equal(const AVFrame *a, const AVFrame *b)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(a->format);
+    int linesize[4] = { 0 };
+    int p, y;
+
+    av_image_fill_linesizes(linesize, a->format, a->width);
+    for (p = 0; p < 4 && a->data[p]; p++) {
+        const int h = (p == 1 || p == 2) ? AV_CEIL_RSHIFT(a->height, desc->log2_chroma_h)
+                                         : a->height;
+
+        /* palettes are not scaled */
+        if (p == 1 && (desc->flags & AV_PIX_FMT_FLAG_PAL))
+            break;
+
+        for (y = 0; y < h; y++)
+            if (memcmp(a->data[p] + y * a->linesize[p],
+                       b->data[p] + y * b->linesize[p], linesize[p]))
+                return 0;
+    }
+
+    return 1;
+}
+
+static void fill_frame(AVFrame *frame, AVLFG *rand)
+{
+    int p, i;
+
+    for (p = 0; p < 4 && frame->buf[p]; p++)
+        for (i = 0; i < frame->buf[p]->size; i++)
+            frame->buf[p]->data[i] = av_lfg_get(rand);
+}
+
+static int test(const AVFrame *src, enum AVPixelFormat dst_fmt)
+{
+    int ret = 0;
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(sizes) && !ret; i++) {
+        const int w = sizes[i].w, h = sizes[i].h;
+        struct SwsContext *sws_ref, *sws_tile;
+        AVFrame *ref = NULL, *tile = NULL;
+
+        sws_ref  = alloc_context(src, dst_fmt, w, h, sizes[i].flags, INT_MAX);
+        sws_tile = alloc_context(src, dst_fmt, w, h, sizes[i].flags, TILE_W);
+        if (!sws_ref || !sws_tile)
+            goto next;
+
+        ref  = alloc_frame(dst_fmt, w, h);
+        tile = alloc_frame(dst_fmt, w, h);
+        if (!ref || !tile) {
+            ret = AVERROR(ENOMEM);
+            goto next;
+        }
+
+        if ((ret = sws_scale_frame(sws_ref,  ref,  src)) < 0 ||
+            (ret = sws_scale_frame(sws_tile, tile, src)) < 0) {
+            fprintf(stderr, "Failed to scale %s -> %s\n",
+                    av_get_pix_fmt_name(src->format), av_get_pix_fmt_name(dst_fmt));
+            goto next;
+        }
+
+        ret = 0;
+        if (!frames_equal(ref, tile)) {
+            fprintf(stderr, "Mismatch %s %dx%d -> %s %dx%d\n",
+                    av_get_pix_fmt_name(src->format), src->width, src->height,
+                    av_get_pix_fmt_name(dst_fmt), w, h);
+            ret = AVERROR(EINVAL);
+        }
+
+next:
+        sws_freeContext(sws_ref);
+        sws_freeContext(sws_tile);
+        av_frame_free(&ref);
+        av_frame_free(&tile);
+    }
+
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    const AVPixFmtDescriptor *desc = NULL;
+    int failed = 0, i;
+    AVLFG rand;
+
+    av_lfg_init(&rand, 1);
+    av_log_set_level(AV_LOG_QUIET);
+
+    while ((desc = av_pix_fmt_desc_next(desc))) {
+        enum AVPixelFormat fmt = av_pix_fmt_desc_get_id(desc);
+        AVFrame *src;
+
+        if (desc->flags & AV_PIX_FMT_FLAG_HWACCEL)
+            continue;
+
+        if (sws_isSupportedInput(fmt)) {
+            if (!(src = alloc_frame(fmt, SRC_W, SRC_H)))
+                return 1;
+            fill_frame(src, &rand);
+            for (i = 0; i < FF_ARRAY_ELEMS(hub_fmts); i++)
+                failed |= test(src, hub_fmts[i]) < 0;
+            av_frame_free(&src);
+        }
+
+        if (!sws_isSupportedOutput(fmt))
+            continue;
+        for (i = 0; i < FF_ARRAY_ELEMS(hub_fmts); i++) {
+            if (!(src = alloc_frame(hub_fmts[i], SRC_W, SRC_H)))
+                return 1;
+            fill_frame(src, &rand);
+            failed |= test(src, fmt) < 0;
+            av_frame_free(&src);
+        }
+    }
+
+    return failed;
+}
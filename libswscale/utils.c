@@ -307,7 +307,31 @@ int ff_shuffle_filter_coefficients(SwsContext *c, int *filterPos,
     int cpu_flags = av_get_cpu_flags();
     if (!filter)
         return 0;
-    if (EXTERNAL_AVX2_FAST(cpu_flags) && !(cpu_flags & AV_CPU_FLAG_SLOW_GATHER)) {
+    if (EXTERNAL_AVX512ICL(cpu_flags) && !(cpu_flags & AV_CPU_FLAG_SLOW_GATHER)) {
+        if ((c->srcBpc == 8) && (c->dstBpc <= 14)) {
+            int16_t *filterCopy;
+            if (!FF_ALLOC_TYPED_ARRAY(filterCopy, dstW * filterSize))
+                return AVERROR(ENOMEM);
+            memcpy(filterCopy, filter, dstW * filterSize * sizeof(int16_t));
+            // 16 pixels are processed at a time, the last group may be
+            // narrower. For every 4 filter coeffs, coeffs 0 and 2 of all
+            // pixels of the group are stored first, then coeffs 1 and 3.
+            for (i = 0; i < dstW; i += 16) {
+                int n = FFMIN(dstW - i, 16);
+                for (k = 0; k + 4 <= filterSize; k += 4) {
+                    for (j = 0; j < n; ++j) {
+                        int from = (i + j) * filterSize + k;
+                        int to = i * filterSize + k * n + j * 2;
+                        filter[to]             = filterCopy[from];
+                        filter[to + 1]         = filterCopy[from + 2];
+                        filter[to + 2 * n]     = filterCopy[from + 1];
+                        filter[to + 2 * n + 1] = filterCopy[from + 3];
+                    }
+                }
+            }
+            av_free(filterCopy);
+        }
+    } else if (EXTERNAL_AVX2_FAST(cpu_flags) && !(cpu_flags & AV_CPU_FLAG_SLOW_GATHER)) {
         if ((c->srcBpc == 8) && (c->dstBpc <= 14)) {
            int16_t *filterCopy = NULL;
            if (filterSize > 4) {
@@ -824,6 +848,187 @@ done:
     return ret;
 }
 
+/*
+ * Process-wide cache of computed scaler filters, so that contexts with the
+ * same geometry and parameters share one immutable copy of them instead of
+ * each recomputing it. Entries live as long as they are referenced, and up
+ * to FILTER_CACHE_IDLE unreferenced ones are kept around for contexts that
+ * are repeatedly created and freed.
+ */
+#define FILTER_CACHE_IDLE 16
+
+typedef struct SwsFilterCacheEntry {
+    struct SwsFilterCacheEntry *next;
+    int refcount;
+
+    /* key: all inputs of initFilter() and ff_shuffle_filter_coefficients() */
+    int xInc, srcW, dstW, filterAlign, one, flags, cpu_flags;
+    int srcPos, dstPos;
+    int shuffle, srcBpc, dstBpc;
+    double param[2];
+
+    int16_t *filter;
+    int32_t *filterPos;
+    int filterSize;
+} SwsFilterCacheEntry;
+
+static AVMutex filter_cache_mutex = AV_MUTEX_INITIALIZER;
+static SwsFilterCacheEntry *filter_cache;
+static int filter_cache_idle;
+
+static int filter_cache_match(const SwsFilterCacheEntry *a,
+                              const SwsFilterCacheEntry *b)
+{
+    return a->xInc        == b->xInc        && a->srcW      == b->srcW      &&
+           a->dstW        == b->dstW        && a->one       == b->one       &&
+           a->filterAlign == b->filterAlign && a->flags     == b->flags     &&
+           a->cpu_flags   == b->cpu_flags   && a->srcPos    == b->srcPos    &&
+           a->dstPos      == b->dstPos      && a->shuffle   == b->shuffle   &&
+           a->srcBpc      == b->srcBpc      && a->dstBpc    == b->dstBpc    &&
+           !memcmp(a->param, b->param, sizeof(a->param));
+}
+
+static void filter_cache_free_entry(SwsFilterCacheEntry *e)
+{
+    av_free(e->filter);
+    av_free(e->filterPos);
+    av_free(e);
+}
+
+/* Must be called with filter_cache_mutex held. Returns a new reference to
+ * the matching entry, moved to the front of the list, or NULL. */
+static SwsFilterCacheEntry *filter_cache_lookup(const SwsFilterCacheEntry *key)
+{
+    SwsFilterCacheEntry **pe;
+
+    for (pe = &filter_cache; *pe; pe = &(*pe)->next) {
+        SwsFilterCacheEntry *e = *pe;
+        if (filter_cache_match(e, key)) {
+            if (!e->refcount++)
+                filter_cache_idle--;
+            *pe          = e->next;
+            e->next      = filter_cache;
+            filter_cache = e;
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static void filter_cache_unref(SwsFilterCacheEntry **pentry,
+                               int16_t **filter, int32_t **filterPos)
+{
+    SwsFilterCacheEntry *e = *pentry;
+
+    if (!e) {
+        av_freep(filter);
+        av_freep(filterPos);
+        return;
+    }
+
+    *pentry    = NULL;
+    *filter    = NULL;
+    *filterPos = NULL;
+
+    ff_mutex_lock(&filter_cache_mutex);
+    if (!--e->refcount && ++filter_cache_idle > FILTER_CACHE_IDLE) {
+        /* evict the least recently used unreferenced entry */
+        SwsFilterCacheEntry **pe, **victim = NULL;
+        for (pe = &filter_cache; *pe; pe = &(*pe)->next)
+            if (!(*pe)->refcount)
+                victim = pe;
+        e       = *victim;
+        *victim = e->next;
+        filter_cache_idle--;
+        filter_cache_free_entry(e);
+    }
+    ff_mutex_unlock(&filter_cache_mutex);
+}
+
+/**
+ * initFilter() followed, for horizontal filters, by the SIMD specific
+ * coefficient reordering; the result is taken from or added to the shared
+ * filter cache unless custom filter vectors are used.
+ */
+static av_cold int init_filter_cached(SwsContext *c, int idx, int hscale,
+                                      int16_t **outFilter, int32_t **filterPos,
+                                      int *outFilterSize, int xInc, int srcW,
+                                      int dstW, int filterAlign, int one,
+                                      int flags, int cpu_flags,
+                                      SwsVector *srcFilter, SwsVector *dstFilter,
+                                      double param[2], int srcPos, int dstPos)
+{
+    SwsFilterCacheEntry key = {
+        .xInc        = xInc,
+        .srcW        = srcW,
+        .dstW        = dstW,
+        .filterAlign = filterAlign,
+        .one         = one,
+        .flags       = flags,
+        .cpu_flags   = cpu_flags,
+        .srcPos      = srcPos,
+        .dstPos      = dstPos,
+        .shuffle     = hscale,
+        .srcBpc      = hscale ? c->srcBpc : 0,
+        .dstBpc      = hscale ? c->dstBpc : 0,
+        .param       = { param[0], param[1] },
+    };
+    SwsFilterCacheEntry *e, *e2;
+    int ret;
+
+    if (srcFilter || dstFilter) {
+        ret = initFilter(outFilter, filterPos, outFilterSize, xInc, srcW, dstW,
+                         filterAlign, one, flags, cpu_flags, srcFilter,
+                         dstFilter, param, srcPos, dstPos);
+        if (ret < 0 || !hscale)
+            return ret;
+        return ff_shuffle_filter_coefficients(c, *filterPos, *outFilterSize,
+                                              *outFilter, dstW);
+    }
+
+    ff_mutex_lock(&filter_cache_mutex);
+    e = filter_cache_lookup(&key);
+    ff_mutex_unlock(&filter_cache_mutex);
+
+    if (!e) {
+        e = av_memdup(&key, sizeof(key));
+        if (!e)
+            return AVERROR(ENOMEM);
+
+        ret = initFilter(&e->filter, &e->filterPos, &e->filterSize, xInc,
+                         srcW, dstW, filterAlign, one, flags, cpu_flags,
+                         NULL, NULL, param, srcPos, dstPos);
+        if (ret >= 0 && hscale)
+            ret = ff_shuffle_filter_coefficients(c, e->filterPos, e->filterSize,
+                                                 e->filter, dstW);
+        if (ret < 0) {
+            filter_cache_free_entry(e);
+            return ret;
+        }
+
+        /* another thread may have computed the same filter meanwhile */
+        ff_mutex_lock(&filter_cache_mutex);
+        e2 = filter_cache_lookup(&key);
+        if (!e2) {
+            e->refcount  = 1;
+            e->next      = filter_cache;
+            filter_cache = e;
+        }
+        ff_mutex_unlock(&filter_cache_mutex);
+
+        if (e2) {
+            filter_cache_free_entry(e);
+            e = e2;
+        }
+    }
+
+    c->filter_cache[idx] = e;
+    *outFilter     = e->filter;
+    *filterPos     = e->filterPos;
+    *outFilterSize = e->filterSize;
+    return 0;
+}
+
 static void fill_rgb2yuv_table(SwsContext *c, const int table[4], int dstRange)
 {
     int64_t W, V, Z, Cy, Cu, Cv;
@@ -1230,20 +1435,84 @@ SwsContext *sws_alloc_context(void)
     return c;
 }
 
-static uint16_t * alloc_gamma_tbl(double e)
+static uint16_t *alloc_gamma_tbl(int in_depth, int out_depth, double e)
 {
-    int i = 0;
-    uint16_t * tbl;
-    tbl = (uint16_t*)av_malloc(sizeof(uint16_t) * 1 << 16);
+    const int in_max  = (1 << in_depth)  - 1;
+    const int out_max = (1 << out_depth) - 1;
+    uint16_t *tbl;
+    int i;
+
+    tbl = av_malloc_array(in_max + 1, sizeof(*tbl));
     if (!tbl)
         return NULL;
 
-    for (i = 0; i < 65536; ++i) {
-        tbl[i] = pow(i / 65535.0, e) * 65535.0;
-    }
+    for (i = 0; i <= in_max; ++i)
+        tbl[i] = lrint(pow(i / (double)in_max, e) * out_max);
     return tbl;
 }
 
+/**
+ * Set up gamma correct scaling: a single linear-light scaler when it can
+ * read and write the caller formats itself, with an unscaled conversion
+ * from and/or to planar RGB cascaded before and after it otherwise.
+ */
+static av_cold int context_init_linear(SwsContext *c, SwsFilter *srcFilter,
+                                       SwsFilter *dstFilter)
+{
+    const int alpha = isALPHA(c->srcFormat) && isALPHA(c->dstFormat);
+    const enum AVPixelFormat tmpFmt = alpha ? AV_PIX_FMT_GBRAP16 : AV_PIX_FMT_GBRP16;
+    const int pre  = !ff_sws_linear_supported(c->srcFormat);
+    const int post = !ff_sws_linear_supported(c->dstFormat);
+    SwsContext *lin;
+    int ret;
+
+    if (pre) {
+        ret = av_image_alloc(c->cascaded_tmp, c->cascaded_tmpStride,
+                             c->srcW, c->srcH, tmpFmt, 64);
+        if (ret < 0)
+            return ret;
+
+        c->cascaded_context[0] = sws_getContext(c->srcW, c->srcH, c->srcFormat,
+                                                c->srcW, c->srcH, tmpFmt,
+                                                c->flags, NULL, NULL, c->param);
+        if (!c->cascaded_context[0])
+            return AVERROR(ENOMEM);
+    }
+
+    lin = alloc_set_opts(c->srcW, c->srcH, tmpFmt, c->dstW, c->dstH, tmpFmt,
+                         c->flags, c->param);
+    if (!lin)
+        return AVERROR(ENOMEM);
+    c->cascaded_context[pre] = lin;
+
+    lin->is_internal_gamma = 1;
+    lin->lin_src_format    = pre  ? tmpFmt : c->srcFormat;
+    lin->lin_dst_format    = post ? tmpFmt : c->dstFormat;
+    ret = sws_init_context(lin, srcFilter, dstFilter);
+    if (ret < 0)
+        return ret;
+
+    if (post) {
+        int *stride   = pre ? c->cascaded1_tmpStride : c->cascaded_tmpStride;
+        uint8_t **tmp = pre ? c->cascaded1_tmp       : c->cascaded_tmp;
+
+        ret = av_image_alloc(tmp, stride, c->dstW, c->dstH, tmpFmt, 64);
+        if (ret < 0)
+            return ret;
+
+        c->cascaded_context[pre + 1] = sws_getContext(c->dstW, c->dstH, tmpFmt,
+                                                      c->dstW, c->dstH, c->dstFormat,
+                                                      c->flags, NULL, NULL, c->param);
+        if (!c->cascaded_context[pre + 1])
+            return AVERROR(ENOMEM);
+        /* colorspace details matter to the conversion from planar RGB */
+        if (!pre)
+            c->cascaded_mainindex = 1;
+    }
+
+    return 0;
+}
+
 static enum AVPixelFormat alphaless_fmt(enum AVPixelFormat fmt)
 {
     switch(fmt) {
@@ -1325,7 +1594,6 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
     const AVPixFmtDescriptor *desc_src;
     const AVPixFmtDescriptor *desc_dst;
     int ret = 0;
-    enum AVPixelFormat tmpFmt;
     static const float float_mult = 1.0f / 255.0f;
 
     cpu_flags = av_get_cpu_flags();
@@ -1606,63 +1874,17 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
 
     // hardcoded for now
     c->gamma_value = 2.2;
-    tmpFmt = AV_PIX_FMT_RGBA64LE;
 
+    if (c->is_internal_gamma) {
+        const AVPixFmtDescriptor *lin_src = av_pix_fmt_desc_get(c->lin_src_format);
+        const AVPixFmtDescriptor *lin_dst = av_pix_fmt_desc_get(c->lin_dst_format);
 
-    if (!unscaled && c->gamma_flag && (srcFormat != tmpFmt || dstFormat != tmpFmt)) {
-        SwsContext *c2;
-        c->cascaded_context[0] = NULL;
-
-        ret = av_image_alloc(c->cascaded_tmp, c->cascaded_tmpStride,
-                            srcW, srcH, tmpFmt, 64);
-        if (ret < 0)
-            return ret;
-
-        c->cascaded_context[0] = sws_getContext(srcW, srcH, srcFormat,
-                                                srcW, srcH, tmpFmt,
-                                                flags, NULL, NULL, c->param);
-        if (!c->cascaded_context[0]) {
+        c->inv_gamma = alloc_gamma_tbl(lin_src->comp[0].depth, 16, c->gamma_value);
+        c->gamma     = alloc_gamma_tbl(16, lin_dst->comp[0].depth, 1.0 / c->gamma_value);
+        if (!c->gamma || !c->inv_gamma)
             return AVERROR(ENOMEM);
-        }
-
-        c->cascaded_context[1] = sws_getContext(srcW, srcH, tmpFmt,
-                                                dstW, dstH, tmpFmt,
-                                                flags, srcFilter, dstFilter, c->param);
-
-        if (!c->cascaded_context[1])
-            return AVERROR(ENOMEM);
-
-        c2 = c->cascaded_context[1];
-        c2->is_internal_gamma = 1;
-        c2->gamma     = alloc_gamma_tbl(    c->gamma_value);
-        c2->inv_gamma = alloc_gamma_tbl(1.f/c->gamma_value);
-        if (!c2->gamma || !c2->inv_gamma)
-            return AVERROR(ENOMEM);
-
-        // is_internal_flag is set after creating the context
-        // to properly create the gamma convert FilterDescriptor
-        // we have to re-initialize it
-        ff_free_filters(c2);
-        if ((ret = ff_init_filters(c2)) < 0) {
-            sws_freeContext(c2);
-            c->cascaded_context[1] = NULL;
-            return ret;
-        }
-
-        c->cascaded_context[2] = NULL;
-        if (dstFormat != tmpFmt) {
-            ret = av_image_alloc(c->cascaded1_tmp, c->cascaded1_tmpStride,
-                                dstW, dstH, tmpFmt, 64);
-            if (ret < 0)
-                return ret;
-
-            c->cascaded_context[2] = sws_getContext(dstW, dstH, tmpFmt,
-                                                dstW, dstH, dstFormat,
-                                                flags, NULL, NULL, c->param);
-            if (!c->cascaded_context[2])
-                return AVERROR(ENOMEM);
-        }
-        return 0;
+    } else if (!unscaled && c->gamma_flag) {
+        return context_init_linear(c, srcFilter, dstFilter);
     }
 
     if (isBayer(srcFormat)) {
@@ -1855,7 +2077,7 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
                                     have_lsx(cpu_flags)    ? 8 :
                                     have_lasx(cpu_flags)   ? 8 : 1;
 
-            if ((ret = initFilter(&c->hLumFilter, &c->hLumFilterPos,
+            if ((ret = init_filter_cached(c, 0, 1, &c->hLumFilter, &c->hLumFilterPos,
                            &c->hLumFilterSize, c->lumXInc,
                            srcW, dstW, filterAlign, 1 << 14,
                            (flags & SWS_BICUBLIN) ? (flags | SWS_BICUBIC) : flags,
@@ -1864,9 +2086,7 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
                            get_local_pos(c, 0, 0, 0),
                            get_local_pos(c, 0, 0, 0))) < 0)
                 goto fail;
-            if (ff_shuffle_filter_coefficients(c, c->hLumFilterPos, c->hLumFilterSize, c->hLumFilter, dstW) < 0)
-                goto nomem;
-            if ((ret = initFilter(&c->hChrFilter, &c->hChrFilterPos,
+            if ((ret = init_filter_cached(c, 1, 1, &c->hChrFilter, &c->hChrFilterPos,
                            &c->hChrFilterSize, c->chrXInc,
                            c->chrSrcW, c->chrDstW, filterAlign, 1 << 14,
                            (flags & SWS_BICUBLIN) ? (flags | SWS_BILINEAR) : flags,
@@ -1875,8 +2095,6 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
                            get_local_pos(c, c->chrSrcHSubSample, c->src_h_chr_pos, 0),
                            get_local_pos(c, c->chrDstHSubSample, c->dst_h_chr_pos, 0))) < 0)
                 goto fail;
-            if (ff_shuffle_filter_coefficients(c, c->hChrFilterPos, c->hChrFilterSize, c->hChrFilter, c->chrDstW) < 0)
-                goto nomem;
         }
     } // initialize horizontal stuff
 
@@ -1886,7 +2104,7 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
                                 PPC_ALTIVEC(cpu_flags) ? 8 :
                                 have_neon(cpu_flags)   ? 2 : 1;
 
-        if ((ret = initFilter(&c->vLumFilter, &c->vLumFilterPos, &c->vLumFilterSize,
+        if ((ret = init_filter_cached(c, 2, 0, &c->vLumFilter, &c->vLumFilterPos, &c->vLumFilterSize,
                        c->lumYInc, srcH, dstH, filterAlign, (1 << 12),
                        (flags & SWS_BICUBLIN) ? (flags | SWS_BICUBIC) : flags,
                        cpu_flags, srcFilter->lumV, dstFilter->lumV,
@@ -1894,7 +2112,7 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
                        get_local_pos(c, 0, 0, 1),
                        get_local_pos(c, 0, 0, 1))) < 0)
             goto fail;
-        if ((ret = initFilter(&c->vChrFilter, &c->vChrFilterPos, &c->vChrFilterSize,
+        if ((ret = init_filter_cached(c, 3, 0, &c->vChrFilter, &c->vChrFilterPos, &c->vChrFilterSize,
                        c->chrYInc, c->chrSrcH, c->chrDstH,
                        filterAlign, (1 << 12),
                        (flags & SWS_BICUBLIN) ? (flags | SWS_BILINEAR) : flags,
@@ -1926,6 +2144,33 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
 #endif
     }
 
+    /* the fused scaler filters horizontally after the vertical pass, with
+     * its own unaligned filters */
+    if (ff_sws_fused_supported(c)) {
+        if ((ret = init_filter_cached(c, 4, 0, &c->fusedHLumFilter, &c->fusedHLumFilterPos,
+                       &c->fusedHLumFilterSize, c->lumXInc,
+                       srcW, dstW, 1, 1 << 14,
+                       (flags & SWS_BICUBLIN) ? (flags | SWS_BICUBIC) : flags,
+                       cpu_flags, srcFilter->lumH, dstFilter->lumH,
+                       c->param,
+                       get_local_pos(c, 0, 0, 0),
+                       get_local_pos(c, 0, 0, 0))) < 0)
+            goto fail;
+        if ((ret = init_filter_cached(c, 5, 0, &c->fusedHChrFilter, &c->fusedHChrFilterPos,
+                       &c->fusedHChrFilterSize, c->chrXInc,
+                       c->chrSrcW, c->chrDstW, 1, 1 << 14,
+                       (flags & SWS_BICUBLIN) ? (flags | SWS_BILINEAR) : flags,
+                       cpu_flags, srcFilter->chrH, dstFilter->chrH,
+                       c->param,
+                       get_local_pos(c, c->chrSrcHSubSample, c->src_h_chr_pos, 0),
+                       get_local_pos(c, c->chrDstHSubSample, c->dst_h_chr_pos, 0))) < 0)
+            goto fail;
+        if (!FF_ALLOC_TYPED_ARRAY(c->fused_tmp, srcW + 16))
+            goto nomem;
+
+        ff_get_fused_swscale(c);
+    }
+
     for (i = 0; i < 4; i++)
         if (!FF_ALLOCZ_TYPED_ARRAY(c->dither_error[i], c->dstW + 3))
             goto nomem;
@@ -1981,7 +2226,10 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
 
     ff_sws_init_scale(c);
 
-    return ff_init_filters(c);
+    if ((ret = ff_init_filters(c)) < 0)
+        return ret;
+
+    return ff_sws_init_tiles(c);
 nomem:
     ret = AVERROR(ENOMEM);
 fail: // FIXME replace things by appropriate error codes
@@ -2450,20 +2698,21 @@ void sws_freeContext(SwsContext *c)
 
     av_freep(&c->src_ranges.ranges);
 
-    av_freep(&c->vLumFilter);
-    av_freep(&c->vChrFilter);
-    av_freep(&c->hLumFilter);
-    av_freep(&c->hChrFilter);
+    filter_cache_unref(&c->filter_cache[0], &c->hLumFilter, &c->hLumFilterPos);
+    filter_cache_unref(&c->filter_cache[1], &c->hChrFilter, &c->hChrFilterPos);
+    filter_cache_unref(&c->filter_cache[2], &c->vLumFilter, &c->vLumFilterPos);
+    filter_cache_unref(&c->filter_cache[3], &c->vChrFilter, &c->vChrFilterPos);
+    filter_cache_unref(&c->filter_cache[4], &c->fusedHLumFilter, &c->fusedHLumFilterPos);
+    filter_cache_unref(&c->filter_cache[5], &c->fusedHChrFilter, &c->fusedHChrFilterPos);
+    av_freep(&c->fused_tmp);
+    av_freep(&c->tiles);
+    av_freep(&c->tileLumFilterPos);
+    av_freep(&c->tileChrFilterPos);
 #if HAVE_ALTIVEC
     av_freep(&c->vYCoeffsBank);
     av_freep(&c->vCCoeffsBank);
 #endif
 
-    av_freep(&c->vLumFilterPos);
-    av_freep(&c->vChrFilterPos);
-    av_freep(&c->hLumFilterPos);
-    av_freep(&c->hChrFilterPos);
-
 #if HAVE_MMX_INLINE
 #if USE_MMAP
     if (c->lumMmxextFilterCode)
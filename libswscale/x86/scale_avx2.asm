@@ -26,6 +26,7 @@ SECTION_RODATA 32
 
 swizzle: dd 0, 4, 1, 5, 2, 6, 3, 7
 four: times 8 dd 4
+low_bytes: dd 0x00ff00ff
 
 SECTION .text
 
@@ -147,10 +148,90 @@ cglobal hscale8to15_%1, 7, 9, 16, pos0, dst, w, srcmem, filter, fltpos, fltsize,
 RET
 %endmacro
 
+; Same interface as above, but the filter coefficients of each group of
+; 16 output pixels (fewer for the last group) are stored as the even
+; coefficients (0 and 2 of every 4) for all pixels, followed by the odd
+; ones, see ff_shuffle_filter_coefficients(). This lets vpdpwssd accumulate
+; whole output pixels without any horizontal adds, and filterPos is used
+; unshuffled.
+%macro SCALE_FUNC_AVX512 1
+cglobal hscale8to15_%1, 7, 10, 8, pos0, dst, w, srcmem, filter, fltpos, fltsize, count, inner, tmp
+    vpbroadcastd m6, [low_bytes]
+    xor countq, countq
+    movsxd wq, wd
+%ifidn %1, X4
+    vpbroadcastd m7, [four]
+    shr fltsized, 2
+%endif
+    sub wq, 0x10
+    jl .tail
+.loop:
+    movu m1, [fltposq]
+    pxor m0, m0
+%ifidn %1, X4
+    mov innerd, fltsized
+.innerloop:
+%endif
+    kxnorw k1, k1, k1
+    vpgatherdd m2{k1}, [srcmemq + m1]
+    vpandd m3, m2, m6
+    psrlw m2, 8
+    vpdpwssd m0, m3, [filterq]
+    vpdpwssd m0, m2, [filterq + mmsize]
+    add filterq, 2 * mmsize
+%ifidn %1, X4
+    paddd m1, m7
+    dec innerd
+    jnz .innerloop
+%endif
+    psrad m0, 7
+    vpmovsdw [dstq + countq * 2], m0
+    add fltposq, mmsize
+    add countq, 0x10
+    cmp countq, wq
+    jle .loop
+
+.tail:
+    ; the last 1-15 pixels, with their coefficients packed to that width
+    add wq, 0x10
+    sub wq, countq
+    jle .end
+    mov tmpd, 0xffff
+    bzhi tmpd, tmpd, wd
+    kmovw k2, tmpd
+    vmovdqu32 m1{k2}{z}, [fltposq]
+    pxor m0, m0
+%ifidn %1, X4
+    mov innerd, fltsized
+.tail_innerloop:
+%endif
+    kmovw k1, k2
+    vpgatherdd m2{k1}, [srcmemq + m1]
+    vpandd m3, m2, m6
+    psrlw m2, 8
+    vpdpwssd m0{k2}, m3, [filterq]
+    vpdpwssd m0{k2}, m2, [filterq + wq * 4]
+    lea filterq, [filterq + wq * 8]
+%ifidn %1, X4
+    paddd m1, m7
+    dec innerd
+    jnz .tail_innerloop
+%endif
+    psrad m0, 7
+    vpmovsdw [dstq + countq * 2]{k2}, m0
+.end:
+RET
+%endmacro
+
 %if ARCH_X86_64
 %if HAVE_AVX2_EXTERNAL
 INIT_YMM avx2
 SCALE_FUNC 4
 SCALE_FUNC X4
 %endif
+%if HAVE_AVX512ICL_EXTERNAL
+INIT_ZMM avx512icl
+SCALE_FUNC_AVX512 4
+SCALE_FUNC_AVX512 X4
+%endif
 %endif
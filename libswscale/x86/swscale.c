@@ -223,6 +223,9 @@ YUV2YUVX_FUNC(sse3, 32)
 #if HAVE_AVX2_EXTERNAL
 YUV2YUVX_FUNC(avx2, 64)
 #endif
+#if HAVE_AVX512ICL_EXTERNAL
+YUV2YUVX_FUNC(avx512icl, 128)
+#endif
 
 #define SCALE_FUNC(filter_n, from_bpc, to_bpc, opt) \
 void ff_hscale ## from_bpc ## to ## to_bpc ## _ ## filter_n ## _ ## opt( \
@@ -262,6 +265,8 @@ SCALE_FUNCS_SSE(sse4);
 
 SCALE_FUNC(4, 8, 15, avx2);
 SCALE_FUNC(X4, 8, 15, avx2);
+SCALE_FUNC(4, 8, 15, avx512icl);
+SCALE_FUNC(X4, 8, 15, avx512icl);
 
 #define VSCALEX_FUNC(size, opt) \
 void ff_yuv2planeX_ ## size ## _ ## opt(const int16_t *filter, int filterSize, \
@@ -504,6 +509,10 @@ av_cold void ff_sws_init_swscale_x86(SwsContext *c)
 #if HAVE_AVX2_EXTERNAL
         if (EXTERNAL_AVX2_FAST(cpu_flags))
             c->yuv2planeX = yuv2yuvX_avx2;
+#endif
+#if HAVE_AVX512ICL_EXTERNAL
+        if (EXTERNAL_AVX512ICL(cpu_flags))
+            c->yuv2planeX = yuv2yuvX_avx512icl;
 #endif
     }
 #if ARCH_X86_32 && !HAVE_ALIGNED_STACK
@@ -663,7 +672,21 @@ switch(c->dstBpc){ \
              break; \
     }
 
-    if (EXTERNAL_AVX2_FAST(cpu_flags) && !(cpu_flags & AV_CPU_FLAG_SLOW_GATHER)) {
+#define ASSIGN_AVX512ICL_SCALE_FUNC(hscalefn, filtersize) \
+    switch (filtersize) { \
+    case 4:  hscalefn = ff_hscale8to15_4_avx512icl; break; \
+    default: hscalefn = ff_hscale8to15_X4_avx512icl; break; \
+    }
+
+    /* must match the filter layout chosen by ff_shuffle_filter_coefficients();
+     * there is no AVX-512 hscale for 16-bit sources (16->19) yet, nor for the
+     * packed RGB output functions, those keep their SSE/AVX2 versions */
+    if (EXTERNAL_AVX512ICL(cpu_flags) && !(cpu_flags & AV_CPU_FLAG_SLOW_GATHER)) {
+        if ((c->srcBpc == 8) && (c->dstBpc <= 14)) {
+            ASSIGN_AVX512ICL_SCALE_FUNC(c->hcScale, c->hChrFilterSize);
+            ASSIGN_AVX512ICL_SCALE_FUNC(c->hyScale, c->hLumFilterSize);
+        }
+    } else if (EXTERNAL_AVX2_FAST(cpu_flags) && !(cpu_flags & AV_CPU_FLAG_SLOW_GATHER)) {
         if ((c->srcBpc == 8) && (c->dstBpc <= 14)) {
             ASSIGN_AVX2_SCALE_FUNC(c->hcScale, c->hChrFilterSize);
             ASSIGN_AVX2_SCALE_FUNC(c->hyScale, c->hLumFilterSize);
@@ -1404,7 +1404,11 @@ static av_cold void RENAME(sws_init_swscale)(SwsContext *c)
                     }
                 }
             } else {
-                c->use_mmx_vfilter= 1;
+                /* the C planar output functions cannot read the MMX filter
+                 * tables, these are only of use with the external yuv2yuvX */
+                c->use_mmx_vfilter = HAVE_MMXEXT_EXTERNAL ||
+                                     !(isPlanarYUV(dstFormat) ||
+                                       (isGray(dstFormat) && !isALPHA(dstFormat)));
                 if (!(c->flags & SWS_FULL_CHR_H_INT)) {
                     switch (c->dstFormat) {
                     case AV_PIX_FMT_RGB32:   c->yuv2packedX = RENAME(yuv2rgb32_X);   break;
@@ -0,0 +1,249 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * Low delay frame threading: the frames decoded on different threads must
+ * overlap, and each frame must be returned as soon as it is done.
+ *
+ * The first frame is held in get_buffer2() until the following packets have
+ * been accepted, which shows that they are decoded while it is not done.
+ * Every following packet is then sent only once the frame of the previous
+ * one has been returned, which shows that no frame waits for later input.
+ */
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavcodec/avcodec.h"
+#include "libavutil/error.h"
+#include "libavutil/frame.h"
+#include "libavutil/mem.h"
+#include "libavutil/time.h"
+
+#define WIDTH      64
+#define HEIGHT     48
+#define NB_FRAMES  12
+#define THREADS    4
+/* how long to wait for a frame, in milliseconds */
+#define TIMEOUT    5000
+
+static atomic_int nb_buffers;
+static atomic_int released;
+
+static int hold_first_frame(AVCodecContext *avctx, AVFrame *frame, int flags)
+{
+    if (!atomic_fetch_add(&nb_buffers, 1))
+        for (int i = 0; i < TIMEOUT && !atomic_load(&released); i++)
+            av_usleep(1000);
+
+    return avcodec_default_get_buffer2(avctx, frame, flags);
+}
+
+static void fill_frame(AVFrame *frame, int n)
+{
+    for (int p = 0; p < 3; p++) {
+        const int w = p ? WIDTH / 2 : WIDTH;
+
+        for (int y = 0; y < HEIGHT; y++)
+            for (int x = 0; x < w; x++)
+                frame->data[p][y * frame->linesize[p] + x] = x * (p + 1) + y * n;
+    }
+}
+
+static int check_frame(const AVFrame *frame, AVFrame *ref, int n)
+{
+    int ret;
+
+    if (frame->pts != n) {
+        fprintf(stderr, "Got frame %"PRId64" instead of %d\n", frame->pts, n);
+        return AVERROR(EINVAL);
+    }
+
+    if ((ret = av_frame_make_writable(ref)) < 0)
+        return ret;
+    fill_frame(ref, n);
+    for (int p = 0; p < 3; p++) {
+        const int w = p ? WIDTH / 2 : WIDTH;
+
+        for (int y = 0; y < HEIGHT; y++)
+            if (memcmp(frame->data[p] + y * frame->linesize[p],
+                       ref->data[p]   + y * ref->linesize[p], w)) {
+                fprintf(stderr, "Frame %d is not decoded correctly\n", n);
+                return AVERROR(EINVAL);
+            }
+    }
+
+    return 0;
+}
+
+static int encode(AVPacket **pkts, AVCodecContext **enc_ctx, AVFrame *frame)
+{
+    const AVCodec *enc = avcodec_find_encoder(AV_CODEC_ID_HUFFYUV);
+    AVCodecContext *ctx;
+    int ret;
+
+    if (!enc || !(ctx = avcodec_alloc_context3(enc)))
+        return AVERROR(ENOMEM);
+    *enc_ctx = ctx;
+
+    ctx->width     = WIDTH;
+    ctx->height    = HEIGHT;
+    ctx->pix_fmt   = AV_PIX_FMT_YUV422P;
+    ctx->time_base = (AVRational){ 1, 25 };
+    if ((ret = avcodec_open2(ctx, enc, NULL)) < 0)
+        return ret;
+
+    for (int i = 0; i < NB_FRAMES; i++) {
+        if ((ret = av_frame_make_writable(frame)) < 0)
+            return ret;
+        fill_frame(frame, i);
+        frame->pts = i;
+
+        if (!(pkts[i] = av_packet_alloc()))
+            return AVERROR(ENOMEM);
+        if ((ret = avcodec_send_frame(ctx, frame)) < 0 ||
+            (ret = avcodec_receive_packet(ctx, pkts[i])) < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+/* wait until the next frame is returned without sending more input */
+static int receive(AVCodecContext *ctx, AVFrame *frame)
+{
+    for (int i = 0; i < TIMEOUT; i++) {
+        int ret = avcodec_receive_frame(ctx, frame);
+        if (ret != AVERROR(EAGAIN))
+            return ret;
+        av_usleep(1000);
+    }
+
+    return AVERROR(ETIMEDOUT);
+}
+
+static int decode(AVPacket **pkts, const AVCodecContext *enc_ctx, AVFrame *ref)
+{
+    const AVCodec *dec = avcodec_find_decoder(AV_CODEC_ID_HUFFYUV);
+    AVCodecContext *ctx = avcodec_alloc_context3(dec);
+    AVFrame *frame = av_frame_alloc();
+    int nb_sent = 0, nb_received = 0, ret;
+
+    if (!ctx || !frame) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    ctx->width        = WIDTH;
+    ctx->height       = HEIGHT;
+    ctx->thread_count = THREADS;
+    ctx->thread_type  = FF_THREAD_FRAME | FF_THREAD_LOW_DELAY;
+    ctx->get_buffer2  = hold_first_frame;
+    ctx->extradata    = av_memdup(enc_ctx->extradata, enc_ctx->extradata_size);
+    if (!ctx->extradata) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    ctx->extradata_size = enc_ctx->extradata_size;
+    if ((ret = avcodec_open2(ctx, dec, NULL)) < 0)
+        goto end;
+
+    /* all threads but one are busy once the first frame is decoding, the
+     * last one would make the decoder wait for it */
+    while (nb_sent < THREADS - 1) {
+        if ((ret = avcodec_send_packet(ctx, pkts[nb_sent])) < 0)
+            goto end;
+        nb_sent++;
+
+        ret = avcodec_receive_frame(ctx, frame);
+        if (ret != AVERROR(EAGAIN)) {
+            fprintf(stderr, "Packet %d was not accepted while the first frame "
+                    "is decoding\n", nb_sent - 1);
+            ret = ret < 0 ? ret : AVERROR(EINVAL);
+            goto end;
+        }
+    }
+    printf("%d packets decoding at once\n", nb_sent);
+    atomic_store(&released, 1);
+
+    while (nb_received < NB_FRAMES) {
+        if (nb_received == nb_sent) {
+            if ((ret = avcodec_send_packet(ctx, pkts[nb_sent])) < 0)
+                goto end;
+            nb_sent++;
+        }
+
+        if ((ret = receive(ctx, frame)) < 0) {
+            fprintf(stderr, "Frame %d was not returned after packet %d: %s\n",
+                    nb_received, nb_sent - 1, av_err2str(ret));
+            goto end;
+        }
+        if ((ret = check_frame(frame, ref, nb_received)) < 0)
+            goto end;
+        av_frame_unref(frame);
+        nb_received++;
+    }
+    printf("%d frames returned before the following packet was sent\n",
+           nb_received - (THREADS - 1));
+
+    if ((ret = avcodec_send_packet(ctx, NULL)) < 0)
+        goto end;
+    ret = avcodec_receive_frame(ctx, frame);
+    if (ret != AVERROR_EOF) {
+        fprintf(stderr, "Got more frames than packets\n");
+        ret = ret < 0 ? ret : AVERROR(EINVAL);
+        goto end;
+    }
+    ret = 0;
+
+end:
+    av_frame_free(&frame);
+    avcodec_free_context(&ctx);
+    return ret;
+}
+
+int main(void)
+{
+    AVPacket *pkts[NB_FRAMES] = { NULL };
+    AVCodecContext *enc_ctx = NULL;
+    AVFrame *frame = av_frame_alloc();
+    int ret;
+
+    if (!frame)
+        return 1;
+    frame->format = AV_PIX_FMT_YUV422P;
+    frame->width  = WIDTH;
+    frame->height = HEIGHT;
+    if ((ret = av_frame_get_buffer(frame, 0)) < 0)
+        goto end;
+
+    if ((ret = encode(pkts, &enc_ctx, frame)) < 0) {
+        fprintf(stderr, "Failed to encode the test frames: %s\n", av_err2str(ret));
+        goto end;
+    }
+
+    ret = decode(pkts, enc_ctx, frame);
+
+end:
+    for (int i = 0; i < NB_FRAMES; i++)
+        av_packet_free(&pkts[i]);
+    avcodec_free_context(&enc_ctx);
+    av_frame_free(&frame);
+    return ret < 0;
+}
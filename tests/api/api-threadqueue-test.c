@@ -0,0 +1,164 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * Adaptive sizing of the ffmpeg CLI thread queues
+ */
+
+#include <stdio.h>
+
+#include "libavcodec/packet.h"
+
+#include "fftools/objpool.c"
+#include "fftools/thread_queue.c"
+
+#define NB_SLOTS 64
+
+static void pkt_move(void *dst, void *src)
+{
+    av_packet_move_ref(dst, src);
+}
+
+static size_t limit(ThreadQueue *tq)
+{
+    return atomic_load(&tq->limit);
+}
+
+/* run one adaptation period, with the given waits recorded during it */
+static void period(ThreadQueue *tq, const char *desc,
+                   unsigned send_waits, unsigned recv_waits)
+{
+    atomic_store(&tq->nb_send_waits, send_waits);
+    tq->nb_recv_waits = recv_waits;
+    adapt_limit(tq);
+    printf("%-16s limit %zu\n", desc, limit(tq));
+}
+
+/* send and receive ADAPT_PERIOD packets through the queue */
+static int pump(ThreadQueue *tq, AVPacket *pkt)
+{
+    for (int i = 0; i < ADAPT_PERIOD; i++) {
+        int stream_idx, ret;
+
+        pkt->pts = i;
+        ret = tq_send(tq, 0, pkt);
+        if (ret < 0)
+            return ret;
+        ret = tq_receive(tq, &stream_idx, pkt);
+        if (ret < 0 || stream_idx != 0 || pkt->pts != i)
+            return AVERROR_BUG;
+        av_packet_unref(pkt);
+    }
+    return 0;
+}
+
+static ThreadQueue *alloc_queue(size_t initial_size)
+{
+    ObjPool *op = objpool_alloc_packets();
+    ThreadQueue *tq;
+
+    if (!op)
+        return NULL;
+    tq = tq_alloc(1, NB_SLOTS, op, pkt_move);
+    if (!tq)
+        return NULL;
+    tq_set_adaptive(tq, initial_size);
+    return tq;
+}
+
+int main(void)
+{
+    ThreadQueue *tq;
+    AVPacket *pkt;
+    int ret = 0;
+
+    pkt = av_packet_alloc();
+    tq  = alloc_queue(8);
+    if (!pkt || !tq) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    printf("%-16s limit %zu\n", "initial", limit(tq));
+
+    /* sending blocks once the limit is reached, even with free slots */
+    for (int i = 0; i < 8; i++) {
+        ret = tq_send(tq, 0, pkt);
+        if (ret < 0)
+            goto end;
+    }
+    printf("send ready at limit: %d\n", send_ready(tq, 0));
+    for (int i = 0; i < 8; i++) {
+        int stream_idx;
+        ret = tq_receive(tq, &stream_idx, pkt);
+        if (ret < 0)
+            goto end;
+    }
+    printf("send ready when drained: %d\n", send_ready(tq, 0));
+
+    /* bursts: grow up to the number of slots */
+    for (int i = 0; i < 4; i++)
+        period(tq, "bursty", 3, 2);
+
+    /* slow consumer: shrink one step per period */
+    for (int i = 0; i < 3; i++)
+        period(tq, "slow consumer", 5, 0);
+
+    /* nobody or only the consumer waiting: keep the length */
+    period(tq, "idle", 0, 0);
+    period(tq, "slow producer", 0, 7);
+
+    /* never shrink below one item */
+    atomic_store(&tq->limit, 2);
+    for (int i = 0; i < 3; i++)
+        period(tq, "slow consumer", 1, 0);
+
+    tq_free(&tq);
+
+    /* adaptation driven by the received items */
+    tq = alloc_queue(4);
+    if (!tq) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    atomic_store(&tq->nb_send_waits, 1);
+    tq->nb_recv_waits = 1;
+    ret = pump(tq, pkt);
+    if (ret < 0)
+        goto end;
+    printf("%-16s limit %zu\n", "traffic bursty", limit(tq));
+
+    ret = pump(tq, pkt);
+    if (ret < 0)
+        goto end;
+    printf("%-16s limit %zu\n", "traffic idle", limit(tq));
+
+    atomic_store(&tq->nb_send_waits, 1);
+    ret = pump(tq, pkt);
+    if (ret < 0)
+        goto end;
+    printf("%-16s limit %zu\n", "traffic slow", limit(tq));
+
+end:
+    tq_free(&tq);
+    av_packet_free(&pkt);
+    if (ret < 0)
+        fprintf(stderr, "Error: %s\n", av_err2str(ret));
+    return ret < 0;
+}
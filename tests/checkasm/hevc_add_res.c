@@ -45,8 +45,12 @@
 
 static void compare_add_res(int size, ptrdiff_t stride, int overflow_test, int mask)
 {
-    LOCAL_ALIGNED_32(int16_t, res0, [32 * 32]);
-    LOCAL_ALIGNED_32(int16_t, res1, [32 * 32]);
+    LOCAL_ALIGNED_32(int16_t, buf0, [32 * 32 + 16]);
+    LOCAL_ALIGNED_32(int16_t, buf1, [32 * 32 + 16]);
+    /* the decoder only guarantees 32-byte alignment, make sure the
+     * residuals are not accidentally 64-byte aligned */
+    int16_t *res0 = buf0 + ((uintptr_t)buf0 & 32 ? 0 : 16);
+    int16_t *res1 = buf1 + ((uintptr_t)buf1 & 32 ? 0 : 16);
     LOCAL_ALIGNED_32(uint8_t, dst0, [32 * 32 * 2]);
     LOCAL_ALIGNED_32(uint8_t, dst1, [32 * 32 * 2]);
 
@@ -63,8 +63,12 @@ static void check_idct(HEVCDSPContext *h, int bit_depth)
 static void check_idct_dc(HEVCDSPContext *h, int bit_depth)
 {
     int i;
-    LOCAL_ALIGNED(32, int16_t, coeffs0, [32 * 32]);
-    LOCAL_ALIGNED(32, int16_t, coeffs1, [32 * 32]);
+    LOCAL_ALIGNED(32, int16_t, buf0, [32 * 32 + 16]);
+    LOCAL_ALIGNED(32, int16_t, buf1, [32 * 32 + 16]);
+    /* the decoder only guarantees 32-byte alignment, make sure the
+     * coefficients are not accidentally 64-byte aligned */
+    int16_t *coeffs0 = buf0 + ((uintptr_t)buf0 & 32 ? 0 : 16);
+    int16_t *coeffs1 = buf1 + ((uintptr_t)buf1 & 32 ? 0 : 16);
 
     for (i = 2; i <= 5; i++) {
         int block_size = 1 << i;
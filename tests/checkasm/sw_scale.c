@@ -270,8 +270,9 @@ static void check_hscale(void)
     };
 
 #define LARGEST_INPUT_SIZE 512
-#define INPUT_SIZES 6
-    static const int input_sizes[INPUT_SIZES] = {8, 24, 128, 144, 256, 512};
+#define INPUT_SIZES 7
+    // 211 leaves a partial group that is not a multiple of 4 pixels wide
+    static const int input_sizes[INPUT_SIZES] = {8, 24, 128, 144, 211, 256, 512};
 
     int i, j, fsi, hpi, width, dstWi;
     struct SwsContext *ctx;
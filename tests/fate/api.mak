@@ -22,11 +22,20 @@ fate-lavf-flv: KEEP_FILES ?= 1
 fate-api-seek: CMD = run $(APITESTSDIR)/api-seek-test$(EXESUF) $(TARGET_PATH)/tests/data/lavf/lavf.flv 0 720
 fate-api-seek: CMP = null
 
+FATE_API_LOWDELAY-$(call ALLYES, HUFFYUV_ENCODER HUFFYUV_DECODER) += fate-api-lowdelay
+FATE_API_LIBAVCODEC-$(HAVE_THREADS) += $(FATE_API_LOWDELAY-yes)
+fate-api-lowdelay: $(APITESTSDIR)/api-lowdelay-test$(EXESUF)
+fate-api-lowdelay: CMD = run $(APITESTSDIR)/api-lowdelay-test$(EXESUF)
+
 FATE_API-$(HAVE_THREADS) += fate-api-threadmessage
 fate-api-threadmessage: $(APITESTSDIR)/api-threadmessage-test$(EXESUF)
 fate-api-threadmessage: CMD = run $(APITESTSDIR)/api-threadmessage-test$(EXESUF) 3 10 30 50 2 20 40
 fate-api-threadmessage: CMP = null
 
+FATE_API-$(CONFIG_FFMPEG) += fate-api-threadqueue
+fate-api-threadqueue: $(APITESTSDIR)/api-threadqueue-test$(EXESUF)
+fate-api-threadqueue: CMD = run $(APITESTSDIR)/api-threadqueue-test$(EXESUF)
+
 FATE_API_SAMPLES-$(CONFIG_AVFORMAT) += $(FATE_API_SAMPLES_LIBAVFORMAT-yes)
 
 ifdef SAMPLES
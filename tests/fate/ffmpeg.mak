@@ -1,6 +1,13 @@
 FATE_FFMPEG-$(call FILTERFRAMECRC, COLOR) += fate-ffmpeg-filter_complex
 fate-ffmpeg-filter_complex: CMD = framecrc -filter_complex color=d=1:r=5 -fflags +bitexact
 
+# independent branches activated concurrently, including get_buffer callbacks
+# forwarding to filters further downstream
+FATE_FFMPEG-$(call FILTERFRAMECRC, TESTSRC2 SPLIT NULL VFLIP PAD HFLIP TRANSPOSE SINE ASPLIT VOLUME AECHO SCALE ARESAMPLE, RAWVIDEO_ENCODER PCM_S16LE_ENCODER) += fate-ffmpeg-filter_complex_concurrent
+fate-ffmpeg-filter_complex_concurrent: CMD = framecrc -auto_conversion_filters -filter_complex_concurrent -filter_complex_threads 4 \
+  -filter_complex "testsrc2=s=160x120:d=1:r=25,split=3[a][b][c];[a]null,vflip,null[va];[b]pad=176:128:8:4,hflip[vb];[c]null,transpose[vc];sine=d=1,asplit[x][y];[x]volume=0.5[ax];[y]aecho[ay]" \
+  -map "[va]" -map "[vb]" -map "[vc]" -map "[ax]" -map "[ay]" -c:v rawvideo -c:a pcm_s16le -fflags +bitexact
+
 # Ticket 6603
 FATE_FFMPEG-$(call FILTERFRAMECRC, AEVALSRC ASETNSAMPLES ARESAMPLE, AC3_FIXED_ENCODER) += fate-ffmpeg-filter_complex_audio
 fate-ffmpeg-filter_complex_audio: CMD = framecrc -auto_conversion_filters -filter_complex "aevalsrc=0:d=0.1,asetnsamples=1537" -c ac3_fixed
@@ -257,6 +264,23 @@ fate-ffmpeg-streamcopy-t: CMD = ffmpeg
     -c copy -f null -t 1 -
 FATE_FFMPEG-$(call REMUX, RAWVIDEO) += fate-ffmpeg-streamcopy-t
 
+# Test two identical encodes sharing one simple filtergraph.
+fate-ffmpeg-share-filtergraphs: tests/data/vsynth1.yuv
+fate-ffmpeg-share-filtergraphs: CMD = framecrc -share_filtergraphs                   \
+    -f rawvideo -s 352x288 -pix_fmt yuv420p -t 1 -i $(TARGET_PATH)/tests/data/vsynth1.yuv  \
+    -map 0:v -map 0:v -vf "scale=176:144,hflip" -sws_flags +accurate_rnd+bitexact    \
+    -pix_fmt yuv420p -c:v rawvideo -fflags +bitexact
+FATE_FFMPEG-$(call FRAMECRC, RAWVIDEO, RAWVIDEO, SCALE_FILTER HFLIP_FILTER) += fate-ffmpeg-share-filtergraphs
+
+# Test a shared filtergraph output producing no frames, both encoders must
+# still be initialized with its parameters.
+fate-ffmpeg-share-filtergraphs-empty: tests/data/vsynth1.yuv
+fate-ffmpeg-share-filtergraphs-empty: CMD = framecrc -share_filtergraphs             \
+    -f rawvideo -s 352x288 -pix_fmt yuv420p -t 1 -i $(TARGET_PATH)/tests/data/vsynth1.yuv  \
+    -map 0:v -map 0:v -vf "scale=176:144,hflip,trim=start_frame=100"                 \
+    -sws_flags +accurate_rnd+bitexact -pix_fmt yuv420p -c:v rawvideo -fflags +bitexact
+FATE_FFMPEG-$(call FRAMECRC, RAWVIDEO, RAWVIDEO, SCALE_FILTER HFLIP_FILTER TRIM_FILTER) += fate-ffmpeg-share-filtergraphs-empty
+
 # Test loopback decoding and passing the output to a complex graph.
 fate-ffmpeg-loopback-decoding: tests/data/vsynth1.yuv
 fate-ffmpeg-loopback-decoding: CMD = transcode \
@@ -199,8 +199,27 @@ FATE_H264  := $(FATE_H264:%=fate-h264-conformance-%)                    \
               fate-h264-ref-pic-mod-overflow                            \
               fate-h264-timecode                                        \
 
+# some conformance streams decoded again with other thread types, against
+# the same references; slices are only decoded in parallel inside the frame
+# threads with the executor ffmpeg sets up with -sched_threads
+FATE_H264_THREAD_TYPE_STREAMS := caba3_toshiba_e:CABA3_TOSHIBA_E.264       \
+                                 cabref3_sand_d:CABREF3_Sand_D.264         \
+                                 mr9_bt_b:MR9_BT_B.h264                    \
+                                 sl1_sva_b:SL1_SVA_B.264                   \
+
+# name, thread_type, extra options, stream
+define FATE_H264_THREAD_TYPE_TEST
+FATE_H264_THREAD_TYPE += fate-h264-conformance-$(1)-$(subst +,-,$(2))
+fate-h264-conformance-$(1)-$(subst +,-,$(2)): CMD = threads=4 thread_type=$(2) framecrc $(3) -i $(TARGET_SAMPLES)/h264-conformance/$(4)
+fate-h264-conformance-$(1)-$(subst +,-,$(2)): REF = $(SRC_PATH)/tests/ref/fate/h264-conformance-$(1)
+endef
+
+$(foreach S,$(FATE_H264_THREAD_TYPE_STREAMS),$(eval $(call FATE_H264_THREAD_TYPE_TEST,$(word 1,$(subst :, ,$(S))),frame+slice,-sched_threads 4,$(word 2,$(subst :, ,$(S))))))
+$(foreach S,$(FATE_H264_THREAD_TYPE_STREAMS),$(eval $(call FATE_H264_THREAD_TYPE_TEST,$(word 1,$(subst :, ,$(S))),frame+low_delay,,$(word 2,$(subst :, ,$(S))))))
+
 FATE_H264-$(call FRAMECRC, H264, H264, H264_PARSER SCALE_FILTER) += $(FATE_H264_REINIT_TESTS:%=fate-h264-reinit-%)
 FATE_H264-$(call FRAMECRC, H264, H264, H264_PARSER) += $(FATE_H264)
+FATE_H264-$(call FRAMECRC, H264, H264, H264_PARSER) += $(FATE_H264_THREAD_TYPE)
 FATE_H264-$(call FRAMEMD5, H264, H264, H264_PARSER) += fate-h264-extreme-plane-pred
 FATE_H264-$(call FRAMEMD5, MOV,  H264) += fate-h264-crop-to-container
 FATE_H264-$(call DEMDEC,   H264, H264, H264_PARSER)   += fate-h264-encparams
@@ -238,6 +257,7 @@ FATE_H264-$(call FRAMECRC, FLV, H264, SCALE_FILTER) += fate-h264-brokensps-2580
 FATE_H264-$(call FRAMECRC, MXF, H264, PCM_S24LE_DECODER SCALE_FILTER ARESAMPLE_FILTER) += fate-h264-xavc-4389
 FATE_H264-$(call FRAMECRC, MOV, H264) += fate-h264-attachment-631
 FATE_H264-$(call FRAMECRC, MPEGTS, H264, H264_PARSER MP3_DECODER SCALE_FILTER ARESAMPLE_FILTER) += fate-h264-skip-nokey fate-h264-skip-nointra
+
 FATE_H264_FFPROBE-$(call DEMDEC, MATROSKA, H264) += fate-h264-dts_5frames
 FATE_H264_FFPROBE-$(call PARSERDEMDEC, H264, H264, H264) += fate-h264-afd
 
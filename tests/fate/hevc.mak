@@ -210,6 +210,23 @@ FATE_HEVC-$(call FRAMECRC, HEVC, HEVC, HEVC_PARSER SCALE_FILTER) +=         \
                                                     $(HEVC_TESTS_422_10BIN) \
                                                     $(HEVC_TESTS_444_12BIT) \
 
+# the in-loop filters on their own threads, inline, with slice threads for
+# WPP and with frame threads, which also share the threads of the executor
+# ffmpeg sets up with -sched_threads; the output must match the conformance
+# tests
+define FATE_HEVC_LF_THREADS_TEST
+fate-hevc-lf-threads-$(1)-$(2): CMD = threads=$(3) thread_type=$(1) framecrc -loop_filter_threads 2 $(4) -i $(TARGET_SAMPLES)/hevc-conformance/$(2).bit -pix_fmt yuv420p
+fate-hevc-lf-threads-$(1)-$(2): REF = $(SRC_PATH)/tests/ref/fate/hevc-conformance-$(2)
+FATE_HEVC_LF_THREADS += fate-hevc-lf-threads-$(1)-$(2)
+endef
+
+$(foreach N,DBLK_A_SONY_3 SAO_A_MediaTek_4 TILES_A_Cisco_2,$(eval $(call FATE_HEVC_LF_THREADS_TEST,slice,$(N),1)))
+$(foreach N,WPP_B_ericsson_MAIN_2 WPP_D_ericsson_MAIN_2,$(eval $(call FATE_HEVC_LF_THREADS_TEST,slice,$(N),3)))
+$(foreach N,DBLK_B_SONY_3 SAO_D_Samsung_5 WPP_F_ericsson_MAIN_2,$(eval $(call FATE_HEVC_LF_THREADS_TEST,frame,$(N),3)))
+$(foreach N,DBLK_C_SONY_3 SAO_B_MediaTek_5,$(eval $(call FATE_HEVC_LF_THREADS_TEST,frame,$(N),3,-sched_threads 3)))
+
+FATE_HEVC-$(call FRAMECRC, HEVC, HEVC, HEVC_PARSER) += $(FATE_HEVC_LF_THREADS)
+
 fate-hevc-paramchange-yuv420p-yuv420p10: CMD = framecrc -i $(TARGET_SAMPLES)/hevc/paramchange_yuv420p_yuv420p10.hevc -fps_mode passthrough -sws_flags area+accurate_rnd+bitexact
 FATE_HEVC-$(call FRAMECRC, HEVC, HEVC, HEVC_PARSER SCALE_FILTER LARGE_TESTS) += fate-hevc-paramchange-yuv420p-yuv420p10
 
@@ -152,6 +152,10 @@ FATE_LIBAVUTIL += fate-side_data_array
 fate-side_data_array: libavutil/tests/side_data_array$(EXESUF)
 fate-side_data_array: CMD = run libavutil/tests/side_data_array$(EXESUF)
 
+FATE_LIBAVUTIL-$(HAVE_THREADS) += fate-slicethread
+fate-slicethread: libavutil/tests/slicethread$(EXESUF)
+fate-slicethread: CMD = run libavutil/tests/slicethread$(EXESUF)
+
 FATE_LIBAVUTIL += fate-tree
 fate-tree: libavutil/tests/tree$(EXESUF)
 fate-tree: CMD = run libavutil/tests/tree$(EXESUF)
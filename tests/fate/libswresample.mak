@@ -1097,5 +1097,11 @@ fate-swr-audioconvert: CMP = stddev
 fate-swr-audioconvert: FUZZ = 0
 
 FATE_SWR += $(FATE_SWR_AUDIOCONVERT-yes)
+
+FATE_SWR_LIB += fate-swr-resample-multi
+fate-swr-resample-multi: libswresample/tests/resample_multi$(EXESUF)
+fate-swr-resample-multi: CMD = run libswresample/tests/resample_multi$(EXESUF)
+
+FATE-$(CONFIG_SWRESAMPLE) += $(FATE_SWR_LIB)
 FATE_FFMPEG += $(FATE_SWR)
-fate-swr: $(FATE_SWR)
+fate-swr: $(FATE_SWR) $(FATE_SWR_LIB)
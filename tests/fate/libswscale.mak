@@ -2,10 +2,30 @@ FATE_LIBSWSCALE += fate-sws-pixdesc-query
 fate-sws-pixdesc-query: libswscale/tests/pixdesc_query$(EXESUF)
 fate-sws-pixdesc-query: CMD = run libswscale/tests/pixdesc_query$(EXESUF)
 
+FATE_LIBSWSCALE += fate-sws-bands-cmp
+fate-sws-bands-cmp: libswscale/tests/bands_cmp$(EXESUF)
+fate-sws-bands-cmp: CMD = run libswscale/tests/bands_cmp$(EXESUF)
+
 FATE_LIBSWSCALE += fate-sws-floatimg-cmp
 fate-sws-floatimg-cmp: libswscale/tests/floatimg_cmp$(EXESUF)
 fate-sws-floatimg-cmp: CMD = run libswscale/tests/floatimg_cmp$(EXESUF)
 
+FATE_LIBSWSCALE += fate-sws-fused-cmp
+fate-sws-fused-cmp: libswscale/tests/fused_cmp$(EXESUF)
+fate-sws-fused-cmp: CMD = run libswscale/tests/fused_cmp$(EXESUF)
+
+FATE_LIBSWSCALE += fate-sws-hscale-fixed-cmp
+fate-sws-hscale-fixed-cmp: libswscale/tests/hscale_fixed_cmp$(EXESUF)
+fate-sws-hscale-fixed-cmp: CMD = run libswscale/tests/hscale_fixed_cmp$(EXESUF)
+
+FATE_LIBSWSCALE += fate-sws-threads-cmp
+fate-sws-threads-cmp: libswscale/tests/threads_cmp$(EXESUF)
+fate-sws-threads-cmp: CMD = run libswscale/tests/threads_cmp$(EXESUF)
+
+FATE_LIBSWSCALE += fate-sws-tiles-cmp
+fate-sws-tiles-cmp: libswscale/tests/tiles_cmp$(EXESUF)
+fate-sws-tiles-cmp: CMD = run libswscale/tests/tiles_cmp$(EXESUF)
+
 SWS_SLICE_TEST-$(call DEMDEC, MATROSKA, VP9) += fate-sws-slice-yuv422-12bit-rgb48
 fate-sws-slice-yuv422-12bit-rgb48: CMD = run tools/scale_slice_test$(EXESUF) $(TARGET_SAMPLES)/vp9-test-vectors/vp93-2-20-12bit-yuv422.webm 150 100 rgb48
 